@@ -14,11 +14,50 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief 模拟器中写周期的完成方式
+ */
+typedef enum {
+    AT24C256_SIM_WAIT_DELAY = 0,  /**< 每页编程后固定等待write_delay_ms (与i2c-dev后端相同) */
+    AT24C256_SIM_WAIT_POLL = 1,   /**< 下次访问前应答查询，空闲期间结束的写周期不再等待 */
+} at24c256_sim_wait_t;
+
+/**
+ * @brief 模拟器参数
+ */
+typedef struct {
+    uint32_t bus_hz;              /**< I2C总线时钟 (Hz) */
+    uint32_t write_cycle_us;      /**< 芯片实际的写周期 (微秒) */
+    at24c256_sim_wait_t wait;     /**< 写周期完成方式 */
+} at24c256_sim_params_t;
+
+/**
+ * @brief 默认模拟器参数：400kHz总线，实际写周期3.5ms，固定延时等待
+ */
+#define AT24C256_SIM_DEFAULT_PARAMS { \
+    .bus_hz = 400000,                 \
+    .write_cycle_us = 3500,           \
+    .wait = AT24C256_SIM_WAIT_DELAY   \
+}
+
+/**
+ * @brief 模拟器的虚拟时间统计
+ */
+typedef struct {
+    uint64_t now_ns;              /**< 虚拟时钟 */
+    uint64_t bus_ns;              /**< 总线传输占用的时间 (含应答查询) */
+    uint64_t wait_ns;             /**< 等待写周期的时间 */
+    uint32_t reads;               /**< 读事务数 */
+    uint32_t pages;               /**< 页编程次数 */
+    uint32_t polls;               /**< 未应答的查询次数 */
+} at24c256_sim_stats_t;
+
 /**
  * @brief AT24C256设备配置结构体
  */
@@ -28,8 +67,26 @@ typedef struct {
     uint16_t page_size;       /**< 页大小 (AT24C256为64字节) */
     uint32_t total_size;      /**< 总容量 (AT24C256为32768字节) */
     uint16_t write_delay_ms;  /**< 写入延迟时间(毫秒) */
+    const char* nvmem_path;   /**< 内核nvmem节点，如 "/sys/bus/nvmem/devices/5-00500/nvmem"；
+                                   非NULL时通过该文件访问，i2c_bus与device_addr被忽略 */
+    uint8_t addr_bytes;       /**< 字地址字节数 (1或2，0按2处理)；1字节器件超过256字节的部分
+                                   由设备地址的低位选择块 */
+    const at24c256_sim_params_t* sim; /**< 非NULL时使用内存模拟器 (虚拟时钟，不访问硬件)，
+                                   优先于nvmem_path */
 } at24c256_config_t;
 
+/**
+ * @brief AT24Cxx器件描述
+ */
+typedef struct {
+    const char* name;         /**< 器件名，如 "AT24C512" */
+    uint16_t page_size;       /**< 页大小 */
+    uint32_t total_size;      /**< 总容量 */
+    uint8_t addr_bytes;       /**< 字地址字节数 */
+    uint8_t block_bits;       /**< 设备地址中用于选择256字节块的低位数 (配置的设备地址中须为0) */
+    uint16_t write_delay_ms;  /**< 典型写周期tWR (毫秒) */
+} at24c256_part_t;
+
 /**
  * @brief AT24C256设备句柄
  */
@@ -47,8 +104,116 @@ typedef enum {
     AT24C256_ERROR_MEMORY = -5,   /**< 内存分配失败 */
     AT24C256_ERROR_BUSY = -6,     /**< 设备忙 */
     AT24C256_ERROR_TIMEOUT = -7,  /**< 操作超时 */
+    AT24C256_ERROR_UNSUPPORTED = -8, /**< 平台不支持该操作 */
+    AT24C256_ERROR_NOT_FOUND = -9,   /**< 键不存在 */
 } at24c256_err_t;
 
+/**
+ * @brief 页缓存模式
+ */
+typedef enum {
+    AT24C256_CACHE_WRITE_THROUGH = 1, /**< 写入立即编程到芯片，同时更新缓存 */
+    AT24C256_CACHE_WRITE_BACK = 2,    /**< 写入只更新缓存，at24c256_flush时统一编程 */
+} at24c256_cache_mode_t;
+
+/**
+ * @brief 主机侧热缓存镜像的默认目录
+ */
+#define AT24C256_WARM_CACHE_DIR "/var/cache/at24c256"
+
+/**
+ * @brief 代数戳放在芯片最后16字节
+ */
+#define AT24C256_WARM_STAMP_AT_END 0xFFFF
+
+/**
+ * @brief 默认的最大预读窗口 (字节)
+ */
+#define AT24C256_READAHEAD_DEFAULT_MAX 1024
+
+/**
+ * @brief 异步请求的完成结果
+ */
+typedef struct {
+    uint32_t id;                 /**< 提交时返回的请求编号 */
+    void* user_data;             /**< 提交时传入的用户数据 */
+    at24c256_err_t result;       /**< 执行结果 */
+} at24c256_completion_t;
+
+/**
+ * @brief 哈希目录每个区域的字节数
+ */
+#define AT24C256_HASHDIR_REGION_SIZE 1024
+
+/**
+ * @brief 哈希目录放在芯片末尾 (代数戳之前)
+ */
+#define AT24C256_HASHDIR_AT_END 0xFFFF
+
+/**
+ * @brief 访问记录中的操作类型
+ */
+typedef enum {
+    AT24C256_TRACE_READ = 1,          /**< at24c256_read */
+    AT24C256_TRACE_WRITE = 2,         /**< at24c256_write */
+    AT24C256_TRACE_PROGRAM_PAGE = 3,  /**< at24c256_program_page，以及异步写入的一页 */
+    AT24C256_TRACE_ERASE = 4,         /**< at24c256_erase */
+    AT24C256_TRACE_FLUSH = 5,         /**< at24c256_flush */
+} at24c256_trace_op_t;
+
+/**
+ * @brief 一条访问记录
+ */
+typedef struct {
+    uint8_t op;                  /**< at24c256_trace_op_t */
+    int8_t result;               /**< at24c256_err_t */
+    uint16_t address;            /**< 起始地址 */
+    uint16_t length;             /**< 长度 */
+    uint64_t start_ns;           /**< 开始时间，相对于记录开始 */
+    uint32_t duration_ns;        /**< 耗时 */
+} at24c256_trace_record_t;
+
+/**
+ * @brief 记录文件头中的设备几何
+ */
+typedef struct {
+    uint16_t page_size;
+    uint32_t total_size;
+    uint8_t addr_bytes;
+} at24c256_trace_info_t;
+
+/**
+ * @brief 支持的最大页大小
+ */
+#define AT24C256_MAX_PAGE_SIZE 256
+
+/**
+ * @brief 一次批量读取中的一个请求
+ */
+typedef struct {
+    at24c256_handle_t handle;    /**< 设备句柄 */
+    uint16_t address;            /**< 起始地址 */
+    uint8_t* data;               /**< 接收缓冲区 */
+    uint16_t length;             /**< 读取长度 */
+    at24c256_err_t result;       /**< 返回的结果 */
+} at24c256_read_req_t;
+
+/**
+ * @brief 一次I2C_RDWR调用的最大消息数 (内核I2C_RDWR_IOCTL_MAX_MSGS)，每个读取占两条
+ */
+#define AT24C256_BATCH_MAX_MSGS 42
+
+/**
+ * @brief 设备发现探测的地址范围 (AT24Cxx的0x50~0x57)
+ */
+#define AT24C256_DISCOVER_BASE 0x50
+#define AT24C256_DISCOVER_ADDRS 8
+
+/**
+ * @brief 不限截止时间
+ */
+#define AT24C256_NO_DEADLINE UINT64_MAX
+
 /**
  * @brief 默认配置
  */
@@ -57,9 +222,37 @@ typedef enum {
     .device_addr = 0x50,          \
     .page_size = 64,              \
     .total_size = 32768,          \
-    .write_delay_ms = 5           \
+    .write_delay_ms = 5,          \
+    .nvmem_path = NULL,           \
+    .addr_bytes = 2,              \
+    .sim = NULL                   \
 }
 
+/**
+ * @brief 按器件名查找内置器件表
+ * 
+ * @param name 器件名，忽略大小写，可以省略"AT"前缀 (如 "24c02")
+ * @return const at24c256_part_t* 器件描述，未找到返回NULL
+ */
+const at24c256_part_t* at24c256_find_part(const char* name);
+
+/**
+ * @brief 按序号遍历内置器件表
+ * 
+ * @param index 序号 (从0开始)
+ * @return const at24c256_part_t* 器件描述，超出范围返回NULL
+ */
+const at24c256_part_t* at24c256_part_at(int index);
+
+/**
+ * @brief 用内置器件表中的参数填写配置 (页大小、容量、地址宽度、写周期)
+ * 
+ * @param config 待填写的配置
+ * @param name 器件名
+ * @return at24c256_err_t 错误码，未知器件返回AT24C256_ERROR_PARAM
+ */
+at24c256_err_t at24c256_config_set_part(at24c256_config_t* config, const char* name);
+
 /**
  * @brief 初始化AT24C256设备
  * 
@@ -69,9 +262,31 @@ typedef enum {
  */
 at24c256_err_t at24c256_init(const at24c256_config_t* config, at24c256_handle_t* handle);
 
+/**
+ * @brief 发现并初始化多条总线上的所有EEPROM
+ * 
+ * 每条总线一个线程并发探测0x50~0x57，一条总线上的候选地址放在一次I2C_RDWR中用零长度
+ * 消息探测，不应答的地址不会等待读取超时。应答的地址按config初始化 (i2c_bus与
+ * device_addr替换为探测到的值)。1字节字地址且容量超过256字节的器件只探测块基地址。
+ * 无法打开的总线被跳过。
+ * 
+ * @param buses 总线路径数组，返回的句柄引用这些字符串，句柄释放前须保持有效
+ * @param bus_count 总线数
+ * @param config 设备配置模板 (不能是模拟器或nvmem配置)
+ * @param handles 返回的句柄，按总线顺序、地址升序排列
+ * @param max_handles 句柄数组容量 (bus_count × AT24C256_DISCOVER_ADDRS可容纳全部)
+ * @param count 返回的句柄数
+ * @return at24c256_err_t 错误码，句柄数组放不下时返回AT24C256_ERROR_MEMORY (多出的设备已释放)
+ */
+at24c256_err_t at24c256_discover(const char* const* buses, int bus_count,
+                                const at24c256_config_t* config, at24c256_handle_t* handles,
+                                int max_handles, int* count);
+
 /**
  * @brief 释放AT24C256设备资源
  * 
+ * 回写缓存中的脏页在释放前写回。写回失败时资源仍全部释放，并返回写回的错误码。
+ * 
  * @param handle 设备句柄
  * @return at24c256_err_t 错误码
  */
@@ -89,6 +304,21 @@ at24c256_err_t at24c256_deinit(at24c256_handle_t handle);
 at24c256_err_t at24c256_read(at24c256_handle_t handle, uint16_t address, 
                             uint8_t* data, uint16_t length);
 
+/**
+ * @brief 批量读取多个设备
+ * 
+ * 同一条I2C总线上的i2c-dev设备的读取合并到一次I2C_RDWR调用中 (每次最多
+ * AT24C256_BATCH_MAX_MSGS / 2个读取)，结果分别写入各请求的缓冲区。启动时读取总线上
+ * 每个芯片的头部只需一次系统调用。合并的调用失败时 (如某个设备不应答) 逐个重新读取，
+ * 以得到每个请求各自的结果。启用了页缓存、预读、访问记录等功能的句柄以及其他后端的
+ * 句柄按at24c256_read逐个读取。
+ * 
+ * @param reqs 请求数组，每个请求的result返回其结果
+ * @param count 请求数
+ * @return at24c256_err_t 全部成功返回AT24C256_OK，否则返回第一个失败请求的错误码
+ */
+at24c256_err_t at24c256_read_batch(at24c256_read_req_t* reqs, int count);
+
 /**
  * @brief 向EEPROM写入数据
  * 
@@ -101,6 +331,21 @@ at24c256_err_t at24c256_read(at24c256_handle_t handle, uint16_t address,
 at24c256_err_t at24c256_write(at24c256_handle_t handle, uint16_t address, 
                              const uint8_t* data, uint16_t length);
 
+/**
+ * @brief 编程一页内的数据 (不做跨页拆分)
+ * 
+ * 供编译期已知页几何的调用者 (见at24c256_fixed.h) 跳过运行时的分页计算。
+ * 调用者必须保证 [address, address + length) 不跨页，否则芯片会在页内回绕覆盖数据。
+ * 
+ * @param handle 设备句柄
+ * @param address 起始地址
+ * @param data 待写数据
+ * @param length 写入长度 (不超过页大小)
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_program_page(at24c256_handle_t handle, uint16_t address, 
+                                    const uint8_t* data, uint16_t length);
+
 /**
  * @brief 擦除EEPROM区域 (写入0xFF)
  * 
@@ -111,6 +356,133 @@ at24c256_err_t at24c256_write(at24c256_handle_t handle, uint16_t address,
  */
 at24c256_err_t at24c256_erase(at24c256_handle_t handle, uint16_t address, uint16_t length);
 
+/**
+ * @brief 在芯片内复制数据 (源与目标可以重叠)
+ * 
+ * 按目标页切块，每块读取一次源数据、编程一次目标页，只使用一个页大小的栈上缓冲区。
+ * 目标在源之后且重叠时从末尾向前复制。每页编程后应答查询等待写周期结束，
+ * 超过write_delay_ms仍不应答时返回AT24C256_ERROR_TIMEOUT。中途失败时目标中已复制的部分保留，
+ * 重叠时源数据可能已被部分覆盖。
+ * 
+ * @param handle 设备句柄
+ * @param src 源地址
+ * @param dst 目标地址
+ * @param length 长度
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_copy(at24c256_handle_t handle, uint16_t src, uint16_t dst,
+                            uint16_t length);
+
+/**
+ * @brief 计算截止时间：后端当前时间加timeout_us
+ * 
+ * 截止时间是CLOCK_MONOTONIC的纳秒数，模拟器后端使用其虚拟时钟。
+ * 
+ * @param handle 设备句柄
+ * @param timeout_us 超时 (微秒)
+ * @return uint64_t 截止时间 (纳秒)
+ */
+uint64_t at24c256_deadline_after(at24c256_handle_t handle, uint32_t timeout_us);
+
+/**
+ * @brief 有截止时间的读取
+ * 
+ * 分块读取，每块之前检查截止时间，已过期时停止并返回已完成的字节数。块不受页边界限制：
+ * 第一块一页，之后按已测得的速率取剩余时间内能读完的长度；不限时间时整段一次读取。
+ * 截止时间只在块之间检查，单块的总线传输不会被中断，最多超出约一页的传输时间。
+ * 
+ * @param handle 设备句柄
+ * @param address 起始地址
+ * @param data 数据缓冲区
+ * @param length 数据长度
+ * @param deadline_ns 截止时间 (CLOCK_MONOTONIC纳秒，AT24C256_NO_DEADLINE表示不限)
+ * @param done 返回已完成的字节数 (可为NULL)
+ * @return at24c256_err_t 错误码，到期时返回AT24C256_ERROR_TIMEOUT
+ */
+at24c256_err_t at24c256_read_deadline(at24c256_handle_t handle, uint16_t address, uint8_t* data,
+                                     uint16_t length, uint64_t deadline_ns, uint16_t* done);
+
+/**
+ * @brief 有截止时间的写入
+ * 
+ * 每页编程 (含写周期) 之前检查截止时间，已完成的页保持写入。
+ * 
+ * @param handle 设备句柄
+ * @param address 起始地址
+ * @param data 待写数据
+ * @param length 数据长度
+ * @param deadline_ns 截止时间
+ * @param done 返回已完成的字节数 (可为NULL)
+ * @return at24c256_err_t 错误码，到期时返回AT24C256_ERROR_TIMEOUT
+ */
+at24c256_err_t at24c256_write_deadline(at24c256_handle_t handle, uint16_t address,
+                                      const uint8_t* data, uint16_t length,
+                                      uint64_t deadline_ns, uint16_t* done);
+
+/**
+ * @brief 有截止时间的擦除
+ * 
+ * @param handle 设备句柄
+ * @param address 起始地址
+ * @param length 擦除长度
+ * @param deadline_ns 截止时间
+ * @param done 返回已完成的字节数 (可为NULL)
+ * @return at24c256_err_t 错误码，到期时返回AT24C256_ERROR_TIMEOUT
+ */
+at24c256_err_t at24c256_erase_deadline(at24c256_handle_t handle, uint16_t address,
+                                      uint16_t length, uint64_t deadline_ns, uint16_t* done);
+
+/**
+ * @brief 有截止时间的芯片内复制
+ * 
+ * 向后复制 (目标在源之后且重叠) 时已完成的是末尾的done字节。
+ * 
+ * @param handle 设备句柄
+ * @param src 源地址
+ * @param dst 目标地址
+ * @param length 长度
+ * @param deadline_ns 截止时间
+ * @param done 返回已完成的字节数 (可为NULL)
+ * @return at24c256_err_t 错误码，到期时返回AT24C256_ERROR_TIMEOUT
+ */
+at24c256_err_t at24c256_copy_deadline(at24c256_handle_t handle, uint16_t src, uint16_t dst,
+                                     uint16_t length, uint64_t deadline_ns, uint16_t* done);
+
+/**
+ * @brief 等待设备就绪直到截止时间
+ * 
+ * @param handle 设备句柄
+ * @param deadline_ns 截止时间
+ * @return at24c256_err_t 错误码，到期时返回AT24C256_ERROR_TIMEOUT
+ */
+at24c256_err_t at24c256_wait_ready_deadline(at24c256_handle_t handle, uint64_t deadline_ns);
+
+/**
+ * @brief 从文件描述符读取length字节并流式写入EEPROM
+ * 
+ * 使用两个页大小的缓冲区，从fd读取下一页的同时编程上一页，内存占用与长度无关。
+ * 
+ * @param handle 设备句柄
+ * @param address 起始地址
+ * @param fd 可读的文件描述符 (从当前位置读取，提前结束返回AT24C256_ERROR_READ)
+ * @param length 字节数
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_write_from_fd(at24c256_handle_t handle, uint16_t address,
+                                     int fd, uint32_t length);
+
+/**
+ * @brief 从EEPROM流式读取length字节写入文件描述符
+ * 
+ * @param handle 设备句柄
+ * @param address 起始地址
+ * @param fd 可写的文件描述符 (写入失败返回AT24C256_ERROR_WRITE)
+ * @param length 字节数
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_read_to_fd(at24c256_handle_t handle, uint16_t address,
+                                  int fd, uint32_t length);
+
 /**
  * @brief 检查EEPROM是否就绪
  * 
@@ -129,6 +501,309 @@ at24c256_err_t at24c256_wait_ready(at24c256_handle_t handle, uint32_t timeout_ms
  */
 at24c256_err_t at24c256_get_info(at24c256_handle_t handle, at24c256_config_t* config);
 
+/**
+ * @brief 启用页缓存
+ * 
+ * 启用后读取先查缓存，未命中的连续页合并为一次读取整页加载，之后重复读取不再访问总线。
+ * 回写模式下写入只修改缓存并记录每页变化的字节范围，at24c256_flush时每个脏页
+ * 只编程一次，且只编程与芯片内容不同的部分。
+ * 
+ * @param handle 设备句柄
+ * @param mode 缓存模式
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_cache_enable(at24c256_handle_t handle, at24c256_cache_mode_t mode);
+
+/**
+ * @brief 写回脏页并关闭页缓存
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_cache_disable(at24c256_handle_t handle);
+
+/**
+ * @brief 丢弃缓存中的干净页，下次读取重新从芯片加载 (脏页保留)
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_cache_invalidate(at24c256_handle_t handle);
+
+/**
+ * @brief 启用顺序读预读
+ * 
+ * 读取紧接上一次读取的结尾时视为顺序访问，一次多读一个窗口放入句柄内的缓冲区，
+ * 之后的读取由缓冲区提供。窗口从请求长度的4倍 (至少一页) 开始，缓冲区每读完一次
+ * 窗口加倍，直到max_window；非顺序的读取直接访问芯片并重置窗口。
+ * 经本库的写入同步更新缓冲区。启用页缓存时读取由页缓存提供，预读不起作用。
+ * 
+ * @param handle 设备句柄
+ * @param max_window 最大预读窗口 (字节)，0表示AT24C256_READAHEAD_DEFAULT_MAX
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_readahead_enable(at24c256_handle_t handle, uint16_t max_window);
+
+/**
+ * @brief 关闭预读并释放缓冲区
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_readahead_disable(at24c256_handle_t handle);
+
+/**
+ * @brief 启用跨线程的组提交
+ * 
+ * 启用后at24c256_write、at24c256_program_page与at24c256_erase可由多个线程同时调用，
+ * 异步写入也经过组提交。写入先暂存，同一页上的字节范围合并后
+ * 由一个线程统一编程：第一个到达的写入者等待window_us收集其他写入者，
+ * 编程期间到达的写入合并到下一批。批内所有页的写周期完成后，这一批的写入者一起返回，
+ * 任一页失败时这一批的写入者都得到该错误。合并范围中没有写入者提供的字节先从芯片读出。
+ * 其他API仍不能与写入并发调用。
+ * 
+ * @param handle 设备句柄
+ * @param window_us 收集写入者的时间 (微秒)，0表示只合并编程期间到达的写入
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_group_commit_enable(at24c256_handle_t handle, uint32_t window_us);
+
+/**
+ * @brief 关闭组提交 (调用时不能有写入正在进行)
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_group_commit_disable(at24c256_handle_t handle);
+
+/**
+ * @brief 将回写缓存中的脏页编程到芯片
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码，未启用缓存时直接返回AT24C256_OK
+ */
+at24c256_err_t at24c256_flush(at24c256_handle_t handle);
+
+/**
+ * @brief 启用由片上代数戳校验的持久化热缓存
+ * 
+ * 片上保留16字节代数戳 (代数 + 内容哈希)，主机侧保存一份芯片镜像。启用时只读取代数戳，
+ * 与镜像一致则所有读取直接由镜像提供，不一致时整片刷新一次。每个写入会话在第一次写入前
+ * 使代数戳失效，at24c256_flush/at24c256_deinit时写入新的代数戳并更新镜像。
+ * 未启用页缓存时自动启用直写缓存。绕过本库修改芯片内容会导致镜像失效不可检测。
+ * 
+ * @param handle 设备句柄
+ * @param cache_path 镜像文件路径，NULL表示AT24C256_WARM_CACHE_DIR下按设备命名的文件
+ * @param stamp_address 代数戳地址 (占用16字节)，AT24C256_WARM_STAMP_AT_END表示芯片末尾
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_warm_cache_enable(at24c256_handle_t handle, const char* cache_path,
+                                         uint16_t stamp_address);
+
+/**
+ * @brief 本次启用热缓存时是否命中主机侧镜像 (未整片刷新)
+ * 
+ * @param handle 设备句柄
+ * @return bool 命中返回true
+ */
+bool at24c256_warm_cache_hit(at24c256_handle_t handle);
+
+/**
+ * @brief 启用片上内容哈希目录
+ * 
+ * 芯片按AT24C256_HASHDIR_REGION_SIZE划分区域，片上保存每个区域的64位哈希，
+ * 之后经本库写入的区域在at24c256_flush (以及diff、sync、disable、deinit) 时增量更新哈希。
+ * 写入代价：每个写入会话 (两次flush之间) 中第一次写入某区域前多编程一次目录以清零其哈希，
+ * flush时再连续写入一段目录项 (每64字节一页)；同一会话中的后续写入没有额外开销。
+ * 片上目录无效时整片读取一次重建。
+ * 未启用页缓存时自动启用直写缓存。同时使用热缓存时应先启用哈希目录。
+ * 
+ * @param handle 设备句柄
+ * @param table_address 目录地址 (占用8 + 8 × 区域数字节)，AT24C256_HASHDIR_AT_END表示芯片末尾
+ * @return at24c256_err_t 错误码，容量不是区域大小整数倍或超过64个区域时返回AT24C256_ERROR_UNSUPPORTED
+ */
+at24c256_err_t at24c256_hashdir_enable(at24c256_handle_t handle, uint16_t table_address);
+
+/**
+ * @brief 关闭哈希目录 (片上目录保留)
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_hashdir_disable(at24c256_handle_t handle);
+
+/**
+ * @brief 只比较哈希，找出目标镜像与芯片内容不同的区域
+ * 
+ * @param handle 设备句柄
+ * @param image 目标镜像 (完整容量，目录所在字节被忽略)
+ * @param mask 返回不同区域的位图，第n位对应第n个区域
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_hashdir_diff(at24c256_handle_t handle, const uint8_t* image,
+                                    uint64_t* mask);
+
+/**
+ * @brief 只重新编程哈希与目标镜像不同的区域
+ * 
+ * @param handle 设备句柄
+ * @param image 目标镜像 (完整容量，目录所在字节不会写入)
+ * @param written 返回写入区域的位图，可为NULL
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_hashdir_sync(at24c256_handle_t handle, const uint8_t* image,
+                                    uint64_t* written);
+
+/**
+ * @brief 获取异步引擎的可轮询描述符
+ * 
+ * 返回的描述符可加入调用者的epoll/poll循环 (EPOLLIN)，可读时调用at24c256_poll_completions。
+ * 引擎在首次调用时创建，描述符归句柄所有，at24c256_deinit时关闭。
+ * 
+ * @param handle 设备句柄
+ * @return int 文件描述符，失败返回-1
+ */
+int at24c256_async_fd(at24c256_handle_t handle);
+
+/**
+ * @brief 提交异步读取 (不阻塞)
+ * 
+ * @param handle 设备句柄
+ * @param address 起始地址
+ * @param data 接收缓冲区，完成前必须保持有效
+ * @param length 读取长度
+ * @param user_data 原样返回在完成结果中
+ * @param id 返回请求编号，可为NULL
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_async_read(at24c256_handle_t handle, uint16_t address, uint8_t* data,
+                                  uint16_t length, void* user_data, uint32_t* id);
+
+/**
+ * @brief 提交异步写入 (不阻塞，不复制数据)
+ * 
+ * 无缓存时页编程后的写周期由引擎内部的timerfd等待，不阻塞调用线程；
+ * 启用直写缓存时每页经同步写入路径。
+ * 
+ * @param handle 设备句柄
+ * @param address 起始地址
+ * @param data 待写数据，完成前必须保持有效
+ * @param length 写入长度
+ * @param user_data 原样返回在完成结果中
+ * @param id 返回请求编号，可为NULL
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_async_write(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length,
+                                   void* user_data, uint32_t* id);
+
+/**
+ * @brief 推进异步请求并收取完成结果 (不阻塞)
+ * 
+ * 每次调用最多执行少量总线传输，写周期期间立即返回。还有工作或结果时描述符保持可读。
+ * 异步请求未完成期间不要对同一句柄调用同步读写。
+ * 
+ * @param handle 设备句柄
+ * @param completions 完成结果数组
+ * @param max 数组容量
+ * @return int 收取的结果数，出错时返回负的错误码
+ */
+int at24c256_poll_completions(at24c256_handle_t handle, at24c256_completion_t* completions,
+                              int max);
+
+/**
+ * @brief 已提交但尚未收取结果的请求数
+ * 
+ * @param handle 设备句柄
+ * @return uint32_t 请求数
+ */
+uint32_t at24c256_async_pending(at24c256_handle_t handle);
+
+/**
+ * @brief 将整个EEPROM映射为进程内存
+ * 
+ * 返回一段覆盖全部容量的虚拟内存，可直接在其上叠加C结构体访问。页面在首次访问时
+ * 通过userfaultfd按需从芯片加载；写入由写保护缺页记录为脏页，调用at24c256_msync
+ * 时只编程内容发生变化的EEPROM页。映射期间应通过映射访问数据，
+ * at24c256_write的写入不会反映到已加载的页面。
+ * 
+ * @param handle 设备句柄
+ * @param ptr 返回的映射地址
+ * @return at24c256_err_t 错误码，内核不支持userfaultfd写保护时返回AT24C256_ERROR_UNSUPPORTED
+ */
+at24c256_err_t at24c256_map(at24c256_handle_t handle, void** ptr);
+
+/**
+ * @brief 将映射中修改过的内容写回EEPROM
+ * 
+ * 缺页时从芯片加载失败的主机页以0xFF填充，这些页不会写回；只要映射中存在这样的页，
+ * 写回其余页后返回AT24C256_ERROR_READ，直到解除映射。
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_msync(at24c256_handle_t handle);
+
+/**
+ * @brief 解除映射 (不会自动写回，需要时请先调用at24c256_msync)
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_unmap(at24c256_handle_t handle);
+
+/**
+ * @brief 开始记录访问
+ * 
+ * 之后每次调用at24c256_read/write/program_page/erase/flush都向文件追加一条定长二进制记录
+ * (操作、地址、长度、开始时间、耗时、结果)，不记录数据内容。无缓存时异步写入的每页编程
+ * 记为AT24C256_TRACE_PROGRAM_PAGE (耗时不含写周期)。记录在内存中缓冲，
+ * 写满或停止时写入文件。模拟器后端使用虚拟时钟。
+ * 
+ * @param handle 设备句柄
+ * @param path 记录文件路径 (覆盖已有文件)
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_trace_start(at24c256_handle_t handle, const char* path);
+
+/**
+ * @brief 停止记录并关闭文件 (at24c256_deinit时自动调用)
+ * 
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码，有记录未能写入文件时返回AT24C256_ERROR_WRITE
+ */
+at24c256_err_t at24c256_trace_stop(at24c256_handle_t handle);
+
+/**
+ * @brief 读取记录文件
+ * 
+ * @param path 记录文件路径
+ * @param info 返回记录时的设备几何
+ * @param records 返回记录数组，调用者用free释放
+ * @param count 返回记录数
+ * @return at24c256_err_t 错误码，格式不符返回AT24C256_ERROR_PARAM
+ */
+at24c256_err_t at24c256_trace_load(const char* path, at24c256_trace_info_t* info,
+                                  at24c256_trace_record_t** records, uint32_t* count);
+
+/**
+ * @brief 推进模拟器的虚拟时钟 (主机空闲，不访问总线)
+ * 
+ * @param handle 模拟器设备句柄
+ * @param ns 空闲的纳秒数
+ * @return at24c256_err_t 错误码，非模拟器后端返回AT24C256_ERROR_UNSUPPORTED
+ */
+at24c256_err_t at24c256_sim_advance(at24c256_handle_t handle, uint64_t ns);
+
+/**
+ * @brief 获取模拟器的虚拟时间统计
+ * 
+ * @param handle 模拟器设备句柄
+ * @param stats 返回的统计
+ * @return at24c256_err_t 错误码，非模拟器后端返回AT24C256_ERROR_UNSUPPORTED
+ */
+at24c256_err_t at24c256_sim_get_stats(at24c256_handle_t handle, at24c256_sim_stats_t* stats);
+
 /**
  * @brief 获取错误描述
  * 
@@ -0,0 +1,317 @@
+/**
+ * @file at24c256.hpp
+ * @brief AT24C256 驱动程序的C++20协程封装 (仅头文件)
+ *
+ * 在at24c256.h的异步引擎之上提供：
+ *   - 只可移动的RAII设备句柄
+ *   - 基于std::span的零拷贝缓冲区
+ *   - co_await dev.read(...) / co_await dev.write(...)
+ *
+ * 协程挂起时只占用协程帧，不占用线程或栈。调用者在自己的事件循环中等待
+ * dev.fd()可读后调用dev.poll()，完成的请求在poll()内恢复对应的协程。
+ *
+ * 用法示例：
+ *   at24c256::task<at24c256_err_t> update(at24c256::device& dev) {
+ *       std::array<uint8_t, 16> buf{};
+ *       at24c256_err_t ret = co_await dev.read(0x0100, buf);
+ *       if (ret == AT24C256_OK) {
+ *           buf[0]++;
+ *           ret = co_await dev.write(0x0100, buf);
+ *       }
+ *       co_return ret;
+ *   }
+ */
+
+#ifndef AT24C256_HPP
+#define AT24C256_HPP
+
+#include "at24c256.h"
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace at24c256 {
+
+/**
+ * @brief 惰性启动的协程任务
+ *
+ * 被co_await时启动并在结束后恢复等待者；顶层任务调用start()启动，
+ * 任务对象在done()之前必须保持存活。
+ */
+template <typename T>
+class task;
+
+namespace detail {
+
+template <typename T>
+struct promise_base {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct final_awaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            auto next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    final_awaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+};
+
+} // namespace detail
+
+template <typename T>
+class task {
+public:
+    struct promise_type : detail::promise_base<T> {
+        T value{};
+        task get_return_object() noexcept {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        void return_value(T v) noexcept(std::is_nothrow_move_assignable_v<T>) { value = std::move(v); }
+    };
+
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+    ~task() { destroy(); }
+
+    /** 启动顶层任务 */
+    void start() { handle_.resume(); }
+    bool done() const noexcept { return !handle_ || handle_.done(); }
+
+    /** 已完成任务的结果 */
+    T result() {
+        if (handle_.promise().exception) {
+            std::rethrow_exception(handle_.promise().exception);
+        }
+        return std::move(handle_.promise().value);
+    }
+
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() { return result(); }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> h) noexcept : handle_(h) {}
+    void destroy() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = {};
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <>
+class task<void> {
+public:
+    struct promise_type : detail::promise_base<void> {
+        task get_return_object() noexcept {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        void return_void() noexcept {}
+    };
+
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+    ~task() { destroy(); }
+
+    void start() { handle_.resume(); }
+    bool done() const noexcept { return !handle_ || handle_.done(); }
+
+    void result() {
+        if (handle_.promise().exception) {
+            std::rethrow_exception(handle_.promise().exception);
+        }
+    }
+
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    void await_resume() { result(); }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> h) noexcept : handle_(h) {}
+    void destroy() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = {};
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief 一次异步读写的等待体
+ *
+ * 地址作为请求的user_data交给异步引擎，完成时由device::poll写入结果并恢复协程。
+ * 提交失败时不挂起，直接返回错误码。
+ */
+class operation {
+public:
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        waiting_ = awaiting;
+        result_ = write_
+            ? at24c256_async_write(handle_, address_, data_, length_, this, nullptr)
+            : at24c256_async_read(handle_, address_, const_cast<uint8_t*>(data_), length_, this,
+                                  nullptr);
+        return result_ == AT24C256_OK;
+    }
+
+    at24c256_err_t await_resume() const noexcept { return result_; }
+
+private:
+    friend class device;
+
+    operation(at24c256_handle_t handle, bool write, uint16_t address, const uint8_t* data,
+              std::size_t length) noexcept
+        : handle_(handle), write_(write), address_(address), data_(data),
+          length_(static_cast<uint16_t>(length)) {
+        if (length == 0 || length > UINT16_MAX) {
+            length_ = 0;   // 交给C API报告AT24C256_ERROR_PARAM
+        }
+    }
+
+    void complete(at24c256_err_t result) noexcept {
+        result_ = result;
+        waiting_.resume();
+    }
+
+    at24c256_handle_t handle_;
+    bool write_;
+    uint16_t address_;
+    const uint8_t* data_;
+    uint16_t length_;
+    at24c256_err_t result_ = AT24C256_OK;
+    std::coroutine_handle<> waiting_;
+};
+
+/**
+ * @brief 只可移动的设备句柄
+ */
+class device {
+public:
+    /** 打开设备，失败时error()返回错误码且对象为空 */
+    explicit device(const at24c256_config_t& config) noexcept {
+        error_ = at24c256_init(&config, &handle_);
+        if (error_ != AT24C256_OK) {
+            handle_ = nullptr;
+        }
+    }
+
+    device(device&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)), error_(other.error_),
+          poll_error_(std::exchange(other.poll_error_, 0)) {}
+    device& operator=(device&& other) noexcept {
+        if (this != &other) {
+            close();
+            handle_ = std::exchange(other.handle_, nullptr);
+            error_ = other.error_;
+            poll_error_ = std::exchange(other.poll_error_, 0);
+        }
+        return *this;
+    }
+    device(const device&) = delete;
+    device& operator=(const device&) = delete;
+    ~device() { close(); }
+
+    explicit operator bool() const noexcept { return handle_ != nullptr; }
+    at24c256_err_t error() const noexcept { return error_; }
+    at24c256_handle_t native_handle() const noexcept { return handle_; }
+
+    /** 读取到span，co_await返回错误码 */
+    operation read(uint16_t address, std::span<uint8_t> buffer) noexcept {
+        return operation(handle_, false, address, buffer.data(), buffer.size());
+    }
+
+    /** 写入span中的数据，co_await返回错误码 */
+    operation write(uint16_t address, std::span<const uint8_t> data) noexcept {
+        return operation(handle_, true, address, data.data(), data.size());
+    }
+
+    /** 加入事件循环的描述符 (EPOLLIN) */
+    int fd() const noexcept { return at24c256_async_fd(handle_); }
+
+    /** 未完成的请求数 */
+    uint32_t pending() const noexcept { return at24c256_async_pending(handle_); }
+
+    /**
+     * @brief 推进异步引擎并恢复已完成请求的协程 (不阻塞)
+     *
+     * 已恢复了协程之后才出错时先返回恢复的协程数，错误码在下一次调用时返回。
+     *
+     * @return int 恢复的协程数，出错时返回负的错误码
+     */
+    int poll() noexcept {
+        if (poll_error_ < 0) {
+            return std::exchange(poll_error_, 0);
+        }
+
+        at24c256_completion_t done[16];
+        int total = 0;
+        int n;
+        do {
+            n = at24c256_poll_completions(handle_, done, 16);
+            for (int i = 0; i < n; i++) {
+                static_cast<operation*>(done[i].user_data)->complete(done[i].result);
+            }
+            total += n > 0 ? n : 0;
+        } while (n == 16);
+
+        if (n < 0 && total > 0) {
+            poll_error_ = n;
+        }
+        return n < 0 && total == 0 ? n : total;
+    }
+
+private:
+    void close() noexcept {
+        if (handle_) {
+            at24c256_deinit(handle_);
+            handle_ = nullptr;
+        }
+    }
+
+    at24c256_handle_t handle_ = nullptr;
+    at24c256_err_t error_ = AT24C256_OK;
+    int poll_error_ = 0;         /**< 推迟到下一次poll返回的错误码 */
+};
+
+} // namespace at24c256
+
+#endif /* AT24C256_HPP */
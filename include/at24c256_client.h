@@ -0,0 +1,98 @@
+/**
+ * @file at24c256_client.h
+ * @brief at24c256d 守护进程客户端库
+ *
+ * 多个进程通过at24c256d共享同一个设备、同一份缓存和同一个调度器。
+ * 控制消息经Unix域套接字发送，读取结果直接从共享内存镜像获取。
+ */
+
+#ifndef AT24C256_CLIENT_H
+#define AT24C256_CLIENT_H
+
+#include "at24c256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 守护进程默认监听的套接字路径
+ */
+#define AT24C256_DAEMON_SOCKET "/run/at24c256d.sock"
+
+/**
+ * @brief 客户端句柄
+ */
+typedef struct at24c256_client_s* at24c256_client_t;
+
+/**
+ * @brief 连接到at24c256d
+ *
+ * @param socket_path 套接字路径，NULL表示使用AT24C256_DAEMON_SOCKET
+ * @param client 返回的客户端句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_client_connect(const char* socket_path, at24c256_client_t* client);
+
+/**
+ * @brief 断开连接并释放资源
+ *
+ * @param client 客户端句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_client_close(at24c256_client_t client);
+
+/**
+ * @brief 读取数据 (从共享内存镜像拷贝一致的快照)
+ *
+ * @param client 客户端句柄
+ * @param address 起始地址
+ * @param data 数据缓冲区
+ * @param length 数据长度
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_client_read(at24c256_client_t client, uint16_t address,
+                                   uint8_t* data, uint16_t length);
+
+/**
+ * @brief 零拷贝读取
+ *
+ * 返回指向共享内存镜像的只读指针。其他客户端的后续写入会直接反映到该区域，
+ * 需要一致快照时请使用at24c256_client_read。
+ *
+ * @param client 客户端句柄
+ * @param address 起始地址
+ * @param length 数据长度
+ * @param data 返回的只读指针
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_client_read_ptr(at24c256_client_t client, uint16_t address,
+                                       uint16_t length, const uint8_t** data);
+
+/**
+ * @brief 写入数据
+ *
+ * @param client 客户端句柄
+ * @param address 起始地址
+ * @param data 数据缓冲区
+ * @param length 数据长度
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_client_write(at24c256_client_t client, uint16_t address,
+                                    const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 擦除区域 (写入0xFF)
+ *
+ * @param client 客户端句柄
+ * @param address 起始地址
+ * @param length 擦除长度
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_client_erase(at24c256_client_t client, uint16_t address, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AT24C256_CLIENT_H */
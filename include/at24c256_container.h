@@ -0,0 +1,167 @@
+/**
+ * @file at24c256_container.h
+ * @brief EEPROM文件容器
+ *
+ * 访问camera_data_write写入的片上文件容器：地址0处为索引头，其后为固定数量的
+ * 文件索引项，文件数据依次存放在索引区之后。挂载时一次读取整个索引区，
+ * 文件内容经设备的回写页缓存访问，修改在at24c256_container_sync时统一写回。
+ */
+
+#ifndef AT24C256_CONTAINER_H
+#define AT24C256_CONTAINER_H
+
+#include "at24c256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AT24C256_CONTAINER_MAX_FILES 16     /**< 索引项数量 */
+#define AT24C256_CONTAINER_NAME_MAX 64      /**< 文件名最大长度 (含结尾'\0') */
+
+/**
+ * @brief 文件容器句柄
+ */
+typedef struct at24c256_container_s* at24c256_container_t;
+
+/**
+ * @brief 文件信息
+ */
+typedef struct {
+    char name[AT24C256_CONTAINER_NAME_MAX];  /**< 文件名 */
+    uint16_t address;                        /**< 数据起始地址 */
+    uint16_t size;                           /**< 文件大小 */
+    uint8_t checksum;                        /**< 异或校验和 */
+} at24c256_file_info_t;
+
+/**
+ * @brief 挂载文件容器
+ *
+ * 为设备启用回写页缓存 (若尚未启用) 并一次读取整个索引区。芯片上没有有效索引时
+ * 挂载为空容器，首次sync时写入索引。
+ *
+ * @param handle 设备句柄
+ * @param container 返回的容器句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_mount(at24c256_handle_t handle, at24c256_container_t* container);
+
+/**
+ * @brief 写回所有修改并卸载
+ *
+ * @param container 容器句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_unmount(at24c256_container_t container);
+
+/**
+ * @brief 获取文件数量
+ *
+ * @param container 容器句柄
+ * @return int 文件数量
+ */
+int at24c256_container_count(at24c256_container_t container);
+
+/**
+ * @brief 获取文件信息
+ *
+ * @param container 容器句柄
+ * @param index 文件序号
+ * @param info 返回的文件信息
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_stat(at24c256_container_t container, int index,
+                                      at24c256_file_info_t* info);
+
+/**
+ * @brief 按文件名查找
+ *
+ * @param container 容器句柄
+ * @param name 文件名
+ * @return int 文件序号，不存在时返回-1
+ */
+int at24c256_container_find(at24c256_container_t container, const char* name);
+
+/**
+ * @brief 读取文件内容
+ *
+ * @param container 容器句柄
+ * @param index 文件序号
+ * @param offset 文件内偏移
+ * @param data 数据缓冲区
+ * @param length 请求长度
+ * @param done 返回实际读取的字节数 (到达文件末尾时小于length)
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_read(at24c256_container_t container, int index, uint32_t offset,
+                                      uint8_t* data, uint32_t length, uint32_t* done);
+
+/**
+ * @brief 写入文件内容 (必要时扩展文件)
+ *
+ * 文件只能扩展到下一个文件的起始地址或芯片末尾，空间不足时返回AT24C256_ERROR_MEMORY。
+ *
+ * @param container 容器句柄
+ * @param index 文件序号
+ * @param offset 文件内偏移
+ * @param data 数据缓冲区
+ * @param length 数据长度
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_write(at24c256_container_t container, int index, uint32_t offset,
+                                       const uint8_t* data, uint32_t length);
+
+/**
+ * @brief 修改文件大小
+ *
+ * @param container 容器句柄
+ * @param index 文件序号
+ * @param size 新大小
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_truncate(at24c256_container_t container, int index, uint32_t size);
+
+/**
+ * @brief 创建空文件，数据区位于现有文件之后
+ *
+ * @param container 容器句柄
+ * @param name 文件名
+ * @param index 返回的文件序号
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_create(at24c256_container_t container, const char* name,
+                                        int* index);
+
+/**
+ * @brief 删除文件索引项 (数据区不回收)
+ *
+ * @param container 容器句柄
+ * @param index 文件序号
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_remove(at24c256_container_t container, int index);
+
+/**
+ * @brief 重命名文件
+ *
+ * @param container 容器句柄
+ * @param index 文件序号
+ * @param name 新文件名
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_rename(at24c256_container_t container, int index,
+                                        const char* name);
+
+/**
+ * @brief 更新校验和与索引，并将所有脏页写回芯片
+ *
+ * @param container 容器句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_container_sync(at24c256_container_t container);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AT24C256_CONTAINER_H */
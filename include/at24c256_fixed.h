@@ -0,0 +1,94 @@
+/**
+ * @file at24c256_fixed.h
+ * @brief 编译期固定页几何的特化读写
+ *
+ * at24c256_write在运行时按at24c256_config_t做分页计算。页大小、容量与地址宽度在编译期
+ * 已知时，用AT24C256_DEFINE_GEOMETRY生成一组static inline函数：
+ *   - 页大小必须是2的幂，分页用掩码代替除法
+ *   - 范围检查与常量比较，几何参数错误在编译期报错
+ *   - 每页直接调用at24c256_program_page，不再经过通用分页循环
+ * 通用路径不受影响，两者可以对同一句柄混用。
+ *
+ * 用法示例：
+ *   AT24C256_DEFINE_GEOMETRY(eeprom, 64, 32768, 2)
+ *
+ *   at24c256_config_t config = eeprom_config("/dev/i2c-5", 0x50);
+ *   at24c256_init(&config, &handle);
+ *   eeprom_write(handle, 0x0100, data, 16);
+ */
+
+#ifndef AT24C256_FIXED_H
+#define AT24C256_FIXED_H
+
+#include "at24c256.h"
+
+#ifdef __cplusplus
+#define AT24C256_STATIC_ASSERT static_assert
+#else
+#define AT24C256_STATIC_ASSERT _Static_assert
+#endif
+
+/**
+ * @brief 生成固定几何的特化函数
+ *
+ * 生成 prefix##_config、prefix##_read、prefix##_write、prefix##_write_page。
+ *
+ * @param prefix 函数名前缀
+ * @param PAGE 页大小 (2的幂，不超过AT24C256_MAX_PAGE_SIZE)
+ * @param TOTAL 总容量 (页大小的整数倍，不超过64KB)
+ * @param ADDR_BYTES 字地址字节数 (1或2，1字节时容量不超过2KB)
+ */
+#define AT24C256_DEFINE_GEOMETRY(prefix, PAGE, TOTAL, ADDR_BYTES)                                   \
+    AT24C256_STATIC_ASSERT((PAGE) > 0 && ((PAGE) & ((PAGE) - 1)) == 0,                              \
+                           #prefix ": 页大小必须是2的幂");                                          \
+    AT24C256_STATIC_ASSERT((PAGE) <= AT24C256_MAX_PAGE_SIZE, #prefix ": 页大小超过上限");           \
+    AT24C256_STATIC_ASSERT((TOTAL) % (PAGE) == 0 && (TOTAL) <= 65536L,                              \
+                           #prefix ": 容量必须是页大小的整数倍且不超过64KB");                       \
+    AT24C256_STATIC_ASSERT((ADDR_BYTES) == 1 || (ADDR_BYTES) == 2, #prefix ": 字地址为1或2字节");   \
+    AT24C256_STATIC_ASSERT((ADDR_BYTES) == 2 || (TOTAL) <= 2048, #prefix ": 1字节字地址最多2KB");   \
+                                                                                                    \
+    /** 按几何参数填好的默认配置 */                                                                 \
+    static inline at24c256_config_t prefix##_config(const char* i2c_bus, uint8_t device_addr) {     \
+        at24c256_config_t config = AT24C256_DEFAULT_CONFIG;                                         \
+        config.i2c_bus = i2c_bus;                                                                   \
+        config.device_addr = device_addr;                                                           \
+        config.page_size = (PAGE);                                                                  \
+        config.total_size = (TOTAL);                                                                \
+        config.addr_bytes = (ADDR_BYTES);                                                           \
+        return config;                                                                              \
+    }                                                                                               \
+                                                                                                    \
+    /** 编程一页内的数据，调用者保证不跨页 */                                                       \
+    static inline at24c256_err_t prefix##_write_page(at24c256_handle_t handle, uint16_t address,    \
+                                                     const uint8_t* data, uint16_t length) {        \
+        return at24c256_program_page(handle, address, data, length);                                \
+    }                                                                                               \
+                                                                                                    \
+    static inline at24c256_err_t prefix##_read(at24c256_handle_t handle, uint16_t address,          \
+                                               uint8_t* data, uint16_t length) {                    \
+        if (length == 0 || (uint32_t)address + length > (TOTAL)) {                                  \
+            return AT24C256_ERROR_PARAM;                                                            \
+        }                                                                                           \
+        return at24c256_read(handle, address, data, length);                                        \
+    }                                                                                               \
+                                                                                                    \
+    static inline at24c256_err_t prefix##_write(at24c256_handle_t handle, uint16_t address,         \
+                                                const uint8_t* data, uint16_t length) {             \
+        if (length == 0 || (uint32_t)address + length > (TOTAL)) {                                  \
+            return AT24C256_ERROR_PARAM;                                                            \
+        }                                                                                           \
+        while (length > 0) {                                                                        \
+            uint16_t room = (uint16_t)((PAGE) - (address & ((PAGE) - 1)));                          \
+            uint16_t chunk = length < room ? length : room;                                         \
+            at24c256_err_t ret = at24c256_program_page(handle, address, data, chunk);               \
+            if (ret != AT24C256_OK) {                                                               \
+                return ret;                                                                         \
+            }                                                                                       \
+            address = (uint16_t)(address + chunk);                                                  \
+            data += chunk;                                                                          \
+            length = (uint16_t)(length - chunk);                                                    \
+        }                                                                                           \
+        return AT24C256_OK;                                                                         \
+    }
+
+#endif /* AT24C256_FIXED_H */
@@ -0,0 +1,97 @@
+/**
+ * @file at24c256_kv.h
+ * @brief EEPROM键值存储
+ *
+ * 在芯片的一段区域上保存少量带名字的小配置项。区域划分为固定大小的记录槽，
+ * 修改一个键时把新记录写入下一个空闲槽，再把旧槽标记为空闲 (追加式更新)，
+ * 写入中途掉电时旧值仍然有效。挂载时一次读取整个区域，在内存中建立
+ * 哈希索引与Bloom过滤器：
+ *   - 读取一个键最多一次定向读取 (只读该键所在的槽)，不存在的键不访问芯片
+ *   - 写入只编程新记录所在的页与旧记录的首字节所在的页
+ */
+
+#ifndef AT24C256_KV_H
+#define AT24C256_KV_H
+
+#include "at24c256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 键值存储句柄
+ */
+typedef struct at24c256_kv_s* at24c256_kv_t;
+
+/**
+ * @brief 挂载键值存储
+ *
+ * 一次读取整个区域，校验通过的记录进入索引。同一个键存在两条有效记录时
+ * (更新过程中掉电) 保留序号较新的一条，并把旧记录标记为空闲。
+ *
+ * @param handle 设备句柄
+ * @param address 区域起始地址 (槽大小对齐)
+ * @param length 区域长度 (槽大小的整数倍)
+ * @param slot_size 记录槽大小 (16到页大小之间的2的幂)，键长+值长不超过slot_size-5
+ * @param kv 返回的存储句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_kv_mount(at24c256_handle_t handle, uint16_t address, uint32_t length,
+                                uint16_t slot_size, at24c256_kv_t* kv);
+
+/**
+ * @brief 读取一个键
+ *
+ * @param kv 存储句柄
+ * @param key 键 (以'\0'结尾)
+ * @param value 输出缓冲区
+ * @param size 缓冲区大小，小于值长度时返回AT24C256_ERROR_PARAM
+ * @param length 返回值长度 (可为NULL)
+ * @return at24c256_err_t 错误码，键不存在返回AT24C256_ERROR_NOT_FOUND
+ */
+at24c256_err_t at24c256_kv_get(at24c256_kv_t kv, const char* key, void* value, uint16_t size,
+                              uint16_t* length);
+
+/**
+ * @brief 写入一个键 (新值与旧值相同时不编程)
+ *
+ * @param kv 存储句柄
+ * @param key 键 (以'\0'结尾，非空)
+ * @param value 值
+ * @param length 值长度 (可为0)
+ * @return at24c256_err_t 错误码，没有空闲槽时返回AT24C256_ERROR_MEMORY
+ */
+at24c256_err_t at24c256_kv_put(at24c256_kv_t kv, const char* key, const void* value,
+                              uint16_t length);
+
+/**
+ * @brief 删除一个键
+ *
+ * @param kv 存储句柄
+ * @param key 键 (以'\0'结尾)
+ * @return at24c256_err_t 错误码，键不存在返回AT24C256_ERROR_NOT_FOUND
+ */
+at24c256_err_t at24c256_kv_delete(at24c256_kv_t kv, const char* key);
+
+/**
+ * @brief 获取键的数量
+ *
+ * @param kv 存储句柄
+ * @return int 键的数量，参数无效返回-1
+ */
+int at24c256_kv_count(at24c256_kv_t kv);
+
+/**
+ * @brief 卸载键值存储 (所有修改在put/delete返回时已编程)
+ *
+ * @param kv 存储句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_kv_unmount(at24c256_kv_t kv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AT24C256_KV_H */
@@ -0,0 +1,133 @@
+/**
+ * @file at24c256_layout.h
+ * @brief 冷热数据布局建议
+ *
+ * 应用登记其片上字段 (地址范围) 后，驱动统计每个字段的读写次数以及哪些字段在同一次
+ * 应用层更新中一起被写入。据此给出建议布局：一起更新的热字段聚集到同一页，
+ * 不写入的冷字段放到其后，并估算记录到的更新在新旧布局下各需编程多少页。
+ * 迁移函数把字段内容搬到建议的位置，只编程内容变化的页。
+ */
+
+#ifndef AT24C256_LAYOUT_H
+#define AT24C256_LAYOUT_H
+
+#include "at24c256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AT24C256_LAYOUT_MAX_FIELDS 64     /**< 最多登记的字段数 */
+#define AT24C256_LAYOUT_MAX_PATTERNS 256  /**< 记录的不同更新组合数 */
+
+/**
+ * @brief 片上字段
+ */
+typedef struct {
+    uint16_t address;            /**< 起始地址 */
+    uint16_t length;             /**< 长度 */
+} at24c256_field_t;
+
+/**
+ * @brief 字段的访问统计
+ */
+typedef struct {
+    uint32_t reads;              /**< 读取次数 */
+    uint32_t writes;             /**< 写入该字段的更新次数 */
+} at24c256_field_stats_t;
+
+/**
+ * @brief 布局建议的估算结果
+ */
+typedef struct {
+    uint32_t updates;            /**< 记录的更新次数 */
+    uint32_t estimated;          /**< 参与估算的更新次数 (组合表满后的新组合不参与) */
+    uint32_t hot_fields;         /**< 被写入过的字段数 */
+    uint64_t pages_before;       /**< 按当前布局，参与估算的更新共需编程的页数 */
+    uint64_t pages_after;        /**< 按建议布局 */
+} at24c256_layout_report_t;
+
+/**
+ * @brief 登记字段并开始统计
+ *
+ * 之后每次at24c256_read/write/program_page/erase (以及异步请求) 按地址计入重叠的字段。
+ * 每次写入或擦除视为一次更新，
+ * 用at24c256_layout_update_begin/end括起的多次写入合并为一次更新。
+ *
+ * @param handle 设备句柄
+ * @param fields 字段数组 (互不重叠)
+ * @param count 字段数，不超过AT24C256_LAYOUT_MAX_FIELDS
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_layout_track(at24c256_handle_t handle, const at24c256_field_t* fields,
+                                    int count);
+
+/**
+ * @brief 开始一次由多次写入组成的应用层更新
+ *
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码，未登记字段时返回AT24C256_ERROR_PARAM
+ */
+at24c256_err_t at24c256_layout_update_begin(at24c256_handle_t handle);
+
+/**
+ * @brief 结束应用层更新
+ *
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_layout_update_end(at24c256_handle_t handle);
+
+/**
+ * @brief 获取一个字段的访问统计
+ *
+ * @param handle 设备句柄
+ * @param index 字段序号 (登记时的顺序)
+ * @param stats 返回的统计
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_layout_field_stats(at24c256_handle_t handle, int index,
+                                          at24c256_field_stats_t* stats);
+
+/**
+ * @brief 给出建议布局
+ *
+ * 一起更新的热字段按共同更新次数聚成不超过一页的组，组按页装箱，不超过一页的字段
+ * 不跨页；冷字段按原地址顺序紧接其后。
+ *
+ * @param handle 设备句柄
+ * @param region 可用区域起始地址
+ * @param region_length 可用区域长度
+ * @param layout 返回每个字段的新位置 (与登记的顺序相同)
+ * @param report 返回的估算结果 (可为NULL)
+ * @return at24c256_err_t 错误码，区域放不下时返回AT24C256_ERROR_MEMORY
+ */
+at24c256_err_t at24c256_layout_advise(at24c256_handle_t handle, uint16_t region,
+                                     uint32_t region_length, at24c256_field_t* layout,
+                                     at24c256_layout_report_t* report);
+
+/**
+ * @brief 把字段内容搬到新位置，之后的统计按新位置进行
+ *
+ * 先读出所有字段，再只编程内容变化的页。迁移不是原子的，应用应在迁移成功后
+ * 再切换自己的地址表，并自行保存迁移状态以便掉电后重做。
+ *
+ * @param handle 设备句柄
+ * @param layout 每个字段的新位置 (长度须与登记时相同)
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_layout_migrate(at24c256_handle_t handle, const at24c256_field_t* layout);
+
+/**
+ * @brief 停止统计并释放状态
+ *
+ * @param handle 设备句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_layout_untrack(at24c256_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AT24C256_LAYOUT_H */
@@ -0,0 +1,126 @@
+/**
+ * @file at24c256_mirror.h
+ * @brief 镜像设备对
+ *
+ * 两个内容相同的AT24C256 (可以在不同的总线上) 组成一对：
+ *   - 写入同时发往两个设备，两个设备的写周期重叠
+ *   - 较长的读取按页边界一分为二，两个设备并行读取各自的一半
+ *   - 并发的短读取发往当前空闲的设备
+ *   - 读取结果未通过校验或一个设备出错时，改从另一个设备完整读取
+ *   - 只在一个设备上成功的写入使另一个设备的该范围过期，读取该范围时只使用有效的设备
+ *
+ * 每个设备句柄由镜像内部串行访问，镜像的函数可以从多个线程并发调用。
+ * 打开镜像后不要再直接使用两个设备句柄。
+ */
+
+#ifndef AT24C256_MIRROR_H
+#define AT24C256_MIRROR_H
+
+#include "at24c256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AT24C256_MIRROR_SPLIT_MIN 256   /**< 不短于此长度的读取分给两个设备 */
+
+/**
+ * @brief 镜像句柄
+ */
+typedef struct at24c256_mirror_s* at24c256_mirror_t;
+
+/**
+ * @brief 读取结果的校验函数
+ *
+ * @param address 读取的起始地址
+ * @param data 读到的数据
+ * @param length 长度
+ * @param ctx 打开镜像时传入的参数
+ * @return bool 数据有效返回true
+ */
+typedef bool (*at24c256_mirror_verify_t)(uint16_t address, const uint8_t* data,
+                                         uint16_t length, void* ctx);
+
+/**
+ * @brief 镜像统计
+ */
+typedef struct {
+    uint64_t reads[2];           /**< 每个设备执行的读取次数 */
+    uint64_t split_reads;        /**< 分给两个设备的读取次数 */
+    uint64_t fallbacks;          /**< 改从单个设备完整读取的次数 */
+    uint64_t diverged;           /**< 只在另一个设备上成功的写入次数 (按失败的设备计) */
+    uint32_t stale_length[2];    /**< 每个设备过期范围的长度，0表示与另一个设备一致 */
+} at24c256_mirror_stats_t;
+
+/**
+ * @brief 打开镜像
+ *
+ * @param primary 第一个设备
+ * @param secondary 第二个设备 (容量与页大小须相同)
+ * @param verify 读取结果的校验函数，NULL表示只在设备出错时改读另一个设备
+ * @param ctx 传给校验函数的参数
+ * @param mirror 返回的镜像句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_mirror_open(at24c256_handle_t primary, at24c256_handle_t secondary,
+                                   at24c256_mirror_verify_t verify, void* ctx,
+                                   at24c256_mirror_t* mirror);
+
+/**
+ * @brief 从镜像读取
+ *
+ * @param mirror 镜像句柄
+ * @param address 起始地址
+ * @param data 接收缓冲区
+ * @param length 读取长度
+ * @return at24c256_err_t 错误码，两个设备都无法读出有效数据时返回AT24C256_ERROR_READ
+ */
+at24c256_err_t at24c256_mirror_read(at24c256_mirror_t mirror, uint16_t address, uint8_t* data,
+                                   uint16_t length);
+
+/**
+ * @brief 写入两个设备
+ *
+ * 两个设备并行写入，都完成后返回。一个设备失败时返回其错误码，该设备的这一范围记为过期，
+ * 之后读取与之重叠的范围只使用另一个设备；重新写入完整覆盖过期范围或调用
+ * at24c256_mirror_resync后恢复。两个设备都失败时不记录，两份内容都可能只写了一部分。
+ *
+ * @param mirror 镜像句柄
+ * @param address 起始地址
+ * @param data 待写数据
+ * @param length 写入长度
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_mirror_write(at24c256_mirror_t mirror, uint16_t address,
+                                    const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 从有效的设备复制过期范围，使两份内容重新一致
+ *
+ * @param mirror 镜像句柄
+ * @return at24c256_err_t 错误码，失败时过期范围保留
+ */
+at24c256_err_t at24c256_mirror_resync(at24c256_mirror_t mirror);
+
+/**
+ * @brief 获取镜像统计
+ *
+ * @param mirror 镜像句柄
+ * @param stats 返回的统计
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_mirror_get_stats(at24c256_mirror_t mirror, at24c256_mirror_stats_t* stats);
+
+/**
+ * @brief 关闭镜像 (不关闭两个设备句柄)
+ *
+ * @param mirror 镜像句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_mirror_close(at24c256_mirror_t mirror);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AT24C256_MIRROR_H */
@@ -0,0 +1,109 @@
+/**
+ * @file at24c256_schema.h
+ * @brief 片上记录的声明式编解码
+ *
+ * 用X宏列出记录的字段，生成内存中的结构体、紧凑片上格式的长度常量与编解码函数：
+ *   - 片上格式按字段顺序紧密排列，不含编译器填充，多字节整数一律小端
+ *   - 编解码是按固定偏移展开的直线代码，没有分支，不依赖主机字节序与ABI
+ *
+ * 字段写作 X(类型, 名称, 个数)，类型为：
+ *   U8 / U16 / U32    无符号整数 (个数填1)
+ *   BYTES             uint8_t数组
+ *   CHARS             char数组 (按原样保存，不保证以'\0'结尾)
+ *
+ * 例：
+ *   #define MY_RECORD_FIELDS(X) X(U16, id, 1) X(CHARS, name, 8)
+ *   AT24C256_SCHEMA_DEFINE(my_record, MY_RECORD, MY_RECORD_FIELDS)
+ * 生成 my_record_t、MY_RECORD_SIZE (10)、my_record_encode() 与 my_record_decode()。
+ */
+
+#ifndef AT24C256_SCHEMA_H
+#define AT24C256_SCHEMA_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define AT24C256_SCHEMA_TYPE_U8(name, n)     uint8_t name
+#define AT24C256_SCHEMA_TYPE_U16(name, n)    uint16_t name
+#define AT24C256_SCHEMA_TYPE_U32(name, n)    uint32_t name
+#define AT24C256_SCHEMA_TYPE_BYTES(name, n)  uint8_t name[n]
+#define AT24C256_SCHEMA_TYPE_CHARS(name, n)  char name[n]
+
+#define AT24C256_SCHEMA_WIDTH_U8(n)     1
+#define AT24C256_SCHEMA_WIDTH_U16(n)    2
+#define AT24C256_SCHEMA_WIDTH_U32(n)    4
+#define AT24C256_SCHEMA_WIDTH_BYTES(n)  (n)
+#define AT24C256_SCHEMA_WIDTH_CHARS(n)  (n)
+
+#define AT24C256_SCHEMA_ENC_U8(v, n)    p[0] = (v);
+#define AT24C256_SCHEMA_ENC_U16(v, n)   p[0] = (uint8_t)(v); p[1] = (uint8_t)((v) >> 8);
+#define AT24C256_SCHEMA_ENC_U32(v, n)   p[0] = (uint8_t)(v); p[1] = (uint8_t)((v) >> 8); \
+                                        p[2] = (uint8_t)((v) >> 16); p[3] = (uint8_t)((v) >> 24);
+#define AT24C256_SCHEMA_ENC_BYTES(v, n) memcpy(p, (v), (n));
+#define AT24C256_SCHEMA_ENC_CHARS(v, n) memcpy(p, (v), (n));
+
+#define AT24C256_SCHEMA_DEC_U8(v, n)    (v) = p[0];
+#define AT24C256_SCHEMA_DEC_U16(v, n)   (v) = (uint16_t)(p[0] | (p[1] << 8));
+#define AT24C256_SCHEMA_DEC_U32(v, n)   (v) = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | \
+                                              ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+#define AT24C256_SCHEMA_DEC_BYTES(v, n) memcpy((v), p, (n));
+#define AT24C256_SCHEMA_DEC_CHARS(v, n) memcpy((v), p, (n));
+
+#define AT24C256_SCHEMA_MEMBER(kind, name, n)  AT24C256_SCHEMA_TYPE_##kind(name, n);
+#define AT24C256_SCHEMA_WIDTH(kind, name, n)   + AT24C256_SCHEMA_WIDTH_##kind(n)
+#define AT24C256_SCHEMA_ENCODE(kind, name, n) \
+    AT24C256_SCHEMA_ENC_##kind(s->name, n) p += AT24C256_SCHEMA_WIDTH_##kind(n);
+#define AT24C256_SCHEMA_DECODE(kind, name, n) \
+    AT24C256_SCHEMA_DEC_##kind(s->name, n) p += AT24C256_SCHEMA_WIDTH_##kind(n);
+
+/**
+ * @brief 片上格式的长度 (字节，常量表达式)
+ */
+#define AT24C256_SCHEMA_SIZE(FIELDS) (0 FIELDS(AT24C256_SCHEMA_WIDTH))
+
+/**
+ * @brief 生成 type_t、SIZE常量、type_encode(const type_t*, uint8_t*) 与
+ *        type_decode(type_t*, const uint8_t*)
+ */
+#define AT24C256_SCHEMA_DEFINE(type, SIZE, FIELDS)                              \
+    typedef struct { FIELDS(AT24C256_SCHEMA_MEMBER) } type##_t;                 \
+    enum { SIZE##_SIZE = AT24C256_SCHEMA_SIZE(FIELDS) };                        \
+    static inline void type##_encode(const type##_t* s, uint8_t* p) {           \
+        FIELDS(AT24C256_SCHEMA_ENCODE)                                          \
+        (void)p;                                                                \
+    }                                                                           \
+    static inline void type##_decode(type##_t* s, const uint8_t* p) {           \
+        FIELDS(AT24C256_SCHEMA_DECODE)                                          \
+        (void)p;                                                                \
+    }
+
+/* ---- 文件容器 (camera_data_write / at24c256_container) ---- */
+
+#define AT24C256_INDEX_MAGIC "CAM\0"
+#define AT24C256_INDEX_VERSION 2            /**< 2: 紧凑索引项；1: 按内存布局保存 (每项含1字节填充) */
+#define AT24C256_FILE_INDEX_V1_STRIDE 70    /**< 版本1中索引项的间距 */
+#define AT24C256_FILE_NAME_MAX 64           /**< 文件名字段长度 (含结尾'\0') */
+
+/**
+ * @brief 索引头 (地址0处)
+ */
+#define AT24C256_INDEX_HEADER_FIELDS(X) \
+    X(BYTES, magic, 4)                  \
+    X(U8, version, 1)                   \
+    X(U8, file_count, 1)                \
+    X(U16, total_size, 1)               \
+    X(BYTES, reserved, 8)
+
+/**
+ * @brief 文件索引项 (紧跟索引头)
+ */
+#define AT24C256_FILE_INDEX_FIELDS(X)                 \
+    X(CHARS, filename, AT24C256_FILE_NAME_MAX)        \
+    X(U16, address, 1)                                \
+    X(U16, size, 1)                                   \
+    X(U8, checksum, 1)
+
+AT24C256_SCHEMA_DEFINE(at24c256_index_header, AT24C256_INDEX_HEADER, AT24C256_INDEX_HEADER_FIELDS)
+AT24C256_SCHEMA_DEFINE(at24c256_file_index, AT24C256_FILE_INDEX, AT24C256_FILE_INDEX_FIELDS)
+
+#endif /* AT24C256_SCHEMA_H */
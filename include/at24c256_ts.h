@@ -0,0 +1,115 @@
+/**
+ * @file at24c256_ts.h
+ * @brief EEPROM时序数据存储
+ *
+ * 在芯片的一段区域上记录周期性采样 (32位时间戳 + float值，原始格式8字节)。
+ * 区域按页划分为数据块，循环使用，写满后覆盖最旧的块。块内按Gorilla方式压缩：
+ *   - 时间戳：二阶差分 (delta-of-delta)，等间隔采样每个只占1位
+ *   - 数值：与上一个值的IEEE754位模式异或，只保存有效位
+ * 每块的块头记录序号与时间范围，打开时只读取块头建立内存索引，
+ * 范围查询只读取与时间窗口重叠的块。
+ */
+
+#ifndef AT24C256_TS_H
+#define AT24C256_TS_H
+
+#include "at24c256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 时序存储句柄
+ */
+typedef struct at24c256_ts_s* at24c256_ts_t;
+
+/**
+ * @brief 一个采样
+ */
+typedef struct {
+    uint32_t timestamp;          /**< 时间戳 (单位由调用者决定，必须不减) */
+    float value;                 /**< 采样值 */
+} at24c256_ts_sample_t;
+
+/**
+ * @brief 存储状态
+ */
+typedef struct {
+    uint32_t samples;            /**< 保存的采样数 */
+    uint32_t blocks_used;        /**< 已使用的块数 */
+    uint32_t block_count;        /**< 区域中的块数 */
+    uint32_t first_ts;           /**< 最早的时间戳 */
+    uint32_t last_ts;            /**< 最新的时间戳 */
+} at24c256_ts_info_t;
+
+/**
+ * @brief 打开时序存储
+ *
+ * 区域中已有的块 (块头校验通过) 被恢复，最新的块未写满时继续追加。
+ *
+ * @param handle 设备句柄
+ * @param address 区域起始地址 (页对齐)
+ * @param length 区域长度 (页大小的整数倍，至少两页)
+ * @param ts 返回的存储句柄
+ * @return at24c256_err_t 错误码，页小于32字节时返回AT24C256_ERROR_UNSUPPORTED
+ */
+at24c256_err_t at24c256_ts_open(at24c256_handle_t handle, uint16_t address, uint32_t length,
+                               at24c256_ts_t* ts);
+
+/**
+ * @brief 追加一个采样 (只修改内存，块写满时编程该块)
+ *
+ * @param ts 存储句柄
+ * @param timestamp 时间戳，小于上一个采样时返回AT24C256_ERROR_PARAM
+ * @param value 采样值
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_ts_append(at24c256_ts_t ts, uint32_t timestamp, float value);
+
+/**
+ * @brief 把未写满的当前块编程到芯片 (每次调用编程一页)
+ *
+ * @param ts 存储句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_ts_flush(at24c256_ts_t ts);
+
+/**
+ * @brief 查询时间窗口 [from, to] 内的采样
+ *
+ * 只读取时间范围与窗口重叠的块，当前块直接从内存解码。
+ *
+ * @param ts 存储句柄
+ * @param from 起始时间戳
+ * @param to 结束时间戳
+ * @param samples 输出数组
+ * @param max 数组容量，装满时停止
+ * @param count 返回输出的采样数
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_ts_query(at24c256_ts_t ts, uint32_t from, uint32_t to,
+                                at24c256_ts_sample_t* samples, uint32_t max, uint32_t* count);
+
+/**
+ * @brief 获取存储状态
+ *
+ * @param ts 存储句柄
+ * @param info 返回的状态
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_ts_info(at24c256_ts_t ts, at24c256_ts_info_t* info);
+
+/**
+ * @brief 写回当前块并关闭
+ *
+ * @param ts 存储句柄
+ * @return at24c256_err_t 错误码
+ */
+at24c256_err_t at24c256_ts_close(at24c256_ts_t ts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AT24C256_TS_H */
@@ -6,25 +6,19 @@
  */
 
 #include "at24c256.h"
+#include "at24c256_internal.h"
+#include "at24c256_layout.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include <errno.h>
 #include <time.h>
 
-/**
- * @brief AT24C256设备结构体
- */
-struct at24c256_dev_s {
-    int fd;                     /**< I2C文件描述符 */
-    at24c256_config_t config;   /**< 设备配置 */
-    bool initialized;           /**< 初始化标志 */
-};
-
 /**
  * @brief 错误描述字符串
  */
@@ -36,7 +30,9 @@ static const char* error_strings[] = {
     "Invalid parameter",
     "Memory allocation failed",
     "Device busy",
-    "Operation timeout"
+    "Operation timeout",
+    "Operation not supported",
+    "Key not found"
 };
 
 /**
@@ -59,18 +55,145 @@ static at24c256_err_t check_address_length(at24c256_handle_t handle,
     return AT24C256_OK;
 }
 
+#define I2C_MAX_TRANSFER 8192   // i2c-dev单条消息的最大长度
+
+/**
+ * @brief 按地址宽度编码字地址，返回本次传输使用的从设备地址
+ * 
+ * 1字节字地址的器件 (AT24C02~16) 由设备地址的低位选择256字节块。
+ */
+static uint8_t i2c_encode_address(at24c256_handle_t handle, uint16_t address,
+                                  uint8_t* word, uint16_t* word_len) {
+    if (handle->config.addr_bytes == 1) {
+        word[0] = (uint8_t)(address & 0xFF);
+        *word_len = 1;
+        return (uint8_t)(handle->config.device_addr | (address >> 8));
+    }
+    
+    word[0] = (uint8_t)((address >> 8) & 0xFF);
+    word[1] = (uint8_t)(address & 0xFF);
+    *word_len = 2;
+    return handle->config.device_addr;
+}
+
+/**
+ * @brief i2c-dev后端：设置地址指针后顺序读取 (重复起始条件，一次ioctl)
+ */
+static at24c256_err_t i2c_read(at24c256_handle_t handle, uint16_t address, 
+                               uint8_t* data, uint16_t length) {
+    uint16_t done = 0;
+    
+    while (done < length) {
+        uint16_t current_addr = (uint16_t)(address + done);
+        uint32_t chunk = length - done;
+        if (chunk > I2C_MAX_TRANSFER) {
+            chunk = I2C_MAX_TRANSFER;
+        }
+        
+        // 1字节地址的器件按256字节块拆分
+        if (handle->config.addr_bytes == 1 && chunk > 256u - (current_addr & 0xFF)) {
+            chunk = 256u - (current_addr & 0xFF);
+        }
+        
+        uint8_t word[2];
+        uint16_t word_len;
+        uint8_t slave = i2c_encode_address(handle, current_addr, word, &word_len);
+        
+        struct i2c_msg msgs[2] = {
+            { .addr = slave, .flags = 0, .len = word_len, .buf = word },
+            { .addr = slave, .flags = I2C_M_RD, .len = (uint16_t)chunk, .buf = data + done },
+        };
+        struct i2c_rdwr_ioctl_data xfer = { .msgs = msgs, .nmsgs = 2 };
+        if (ioctl(handle->fd, I2C_RDWR, &xfer) != 2) {
+            return AT24C256_ERROR_READ;
+        }
+        
+        done += (uint16_t)chunk;
+    }
+    
+    return AT24C256_OK;
+}
+
+/**
+ * @brief i2c-dev后端：编程一页内的数据
+ */
+static at24c256_err_t i2c_program_page(at24c256_handle_t handle, uint16_t address, 
+                                       const uint8_t* data, uint16_t length) {
+    // 准备写入缓冲区 (地址 + 数据)，页大小在初始化时已检查
+    uint8_t buffer[AT24C256_MAX_PAGE_SIZE + 2];
+    uint16_t word_len;
+    uint8_t slave = i2c_encode_address(handle, address, buffer, &word_len);
+    memcpy(&buffer[word_len], data, length);
+    
+    // 执行写入
+    struct i2c_msg msg = {
+        .addr = slave, .flags = 0, .len = (uint16_t)(word_len + length), .buf = buffer
+    };
+    struct i2c_rdwr_ioctl_data xfer = { .msgs = &msg, .nmsgs = 1 };
+    if (ioctl(handle->fd, I2C_RDWR, &xfer) != 1) {
+        return AT24C256_ERROR_WRITE;
+    }
+    
+    return AT24C256_OK;
+}
+
+/**
+ * @brief i2c-dev后端：应答查询，写周期内芯片不应答
+ */
+static at24c256_err_t i2c_poll_ready(at24c256_handle_t handle) {
+    uint8_t dummy;
+    
+    // 尝试读取一个字节来检查设备是否就绪
+    return read(handle->fd, &dummy, 1) >= 0 ? AT24C256_OK : AT24C256_ERROR_BUSY;
+}
+
+/**
+ * @brief i2c-dev后端
+ */
+static const at24c256_backend_t i2c_backend = {
+    .name = "i2c-dev",
+    .read = i2c_read,
+    .program_page = i2c_program_page,
+    .poll_ready = i2c_poll_ready,
+    .write_cycle = true,
+};
+
+/**
+ * @brief 打开i2c-dev总线并绑定设备地址
+ */
+static at24c256_err_t i2c_open(at24c256_handle_t dev) {
+    // 1字节字地址的器件由设备地址的低位选择块 (AT24C16为3位)，配置的地址中这些位必须为0
+    if (dev->config.addr_bytes == 1 &&
+        (dev->config.device_addr & ((dev->config.total_size - 1) >> 8)) != 0) {
+        return AT24C256_ERROR_PARAM;
+    }
+    
+    // 打开I2C总线
+    dev->fd = open(dev->config.i2c_bus, O_RDWR);
+    if (dev->fd < 0) {
+        return AT24C256_ERROR_INIT;
+    }
+    
+    // 设置I2C从设备地址
+    if (ioctl(dev->fd, I2C_SLAVE, dev->config.device_addr) < 0) {
+        close(dev->fd);
+        return AT24C256_ERROR_INIT;
+    }
+    
+    dev->backend = &i2c_backend;
+    return AT24C256_OK;
+}
+
 /**
  * @brief 等待设备就绪
  */
 static at24c256_err_t internal_wait_ready(at24c256_handle_t handle, uint32_t timeout_ms) {
     struct timespec start, current;
-    uint8_t dummy;
     
     clock_gettime(CLOCK_MONOTONIC, &start);
     
     while (1) {
-        // 尝试读取一个字节来检查设备是否就绪
-        if (read(handle->fd, &dummy, 1) >= 0) {
+        if (handle->backend->poll_ready(handle) == AT24C256_OK) {
             return AT24C256_OK;
         }
         
@@ -86,6 +209,16 @@ static at24c256_err_t internal_wait_ready(at24c256_handle_t handle, uint32_t tim
     }
 }
 
+uint64_t at24c256_now_ns(at24c256_handle_t handle) {
+    if (handle->backend->now_ns) {
+        return handle->backend->now_ns(handle);
+    }
+    
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 at24c256_err_t at24c256_init(const at24c256_config_t* config, at24c256_handle_t* handle) {
     if (!config || !handle) {
         return AT24C256_ERROR_PARAM;
@@ -102,18 +235,31 @@ at24c256_err_t at24c256_init(const at24c256_config_t* config, at24c256_handle_t*
     // 复制配置
     memcpy(&dev->config, config, sizeof(at24c256_config_t));
     
-    // 打开I2C总线
-    dev->fd = open(config->i2c_bus, O_RDWR);
-    if (dev->fd < 0) {
+    if (dev->config.addr_bytes == 0) {
+        dev->config.addr_bytes = 2;
+    }
+    
+    // 1字节字地址加3位块选择最多寻址2KB，2字节字地址最多64KB
+    uint32_t max_size = dev->config.addr_bytes == 1 ? 256u << 3 : 65536u;
+    if (config->page_size == 0 || config->page_size > AT24C256_MAX_PAGE_SIZE ||
+        (dev->config.addr_bytes != 1 && dev->config.addr_bytes != 2) ||
+        config->total_size == 0 || config->total_size > max_size) {
         free(dev);
-        return AT24C256_ERROR_INIT;
+        return AT24C256_ERROR_PARAM;
     }
     
-    // 设置I2C从设备地址
-    if (ioctl(dev->fd, I2C_SLAVE, config->device_addr) < 0) {
-        close(dev->fd);
+    // 打开后端：模拟器优先，其次配置了nvmem路径时使用内核nvmem，否则直接访问i2c-dev
+    at24c256_err_t ret;
+    if (config->sim) {
+        ret = at24c256_sim_open(dev);
+    } else if (config->nvmem_path) {
+        ret = at24c256_nvmem_open(dev);
+    } else {
+        ret = i2c_open(dev);
+    }
+    if (ret != AT24C256_OK) {
         free(dev);
-        return AT24C256_ERROR_INIT;
+        return ret;
     }
     
     dev->initialized = true;
@@ -127,59 +273,114 @@ at24c256_err_t at24c256_deinit(at24c256_handle_t handle) {
         return AT24C256_ERROR_PARAM;
     }
     
+    // 结束访问记录，之后的写回不再记录
+    if (handle->trace) {
+        at24c256_trace_stop(handle);
+    }
+    
+    // 丢弃未完成的异步请求
+    if (handle->async) {
+        at24c256_async_free(handle);
+    }
+    
+    // 释放内存映射
+    if (handle->map) {
+        at24c256_unmap(handle);
+    }
+    
+    if (handle->group) {
+        at24c256_group_commit_disable(handle);
+    }
+    
+    // 写回并释放页缓存；写回失败时仍释放，错误返回给调用者
+    at24c256_err_t result = AT24C256_OK;
+    if (handle->cache) {
+        result = at24c256_cache_disable(handle);
+        if (result != AT24C256_OK) {
+            at24c256_cache_free(handle);
+        }
+    }
+    
+    // 页缓存写回时已更新哈希目录
+    free(handle->hashdir);
+    
+    if (handle->readahead) {
+        at24c256_readahead_disable(handle);
+    }
+    
+    if (handle->layout) {
+        at24c256_layout_untrack(handle);
+    }
+    
+    if (handle->sim) {
+        at24c256_sim_free(handle);
+    }
+    
     if (handle->fd >= 0) {
         close(handle->fd);
     }
     
     free(handle);
-    return AT24C256_OK;
+    return result;
 }
 
-at24c256_err_t at24c256_read(at24c256_handle_t handle, uint16_t address, 
-                            uint8_t* data, uint16_t length) {
-    at24c256_err_t ret = check_address_length(handle, address, length);
+at24c256_err_t at24c256_raw_read(at24c256_handle_t handle, uint16_t address, 
+                                uint8_t* data, uint16_t length) {
+    return handle->backend->read(handle, address, data, length);
+}
+
+/**
+ * @brief 编程一页并等待写周期
+ */
+static at24c256_err_t program_one(at24c256_handle_t handle, uint16_t address, 
+                                  const uint8_t* data, uint16_t length) {
+    at24c256_err_t ret = handle->backend->program_page(handle, address, data, length);
     if (ret != AT24C256_OK) {
         return ret;
     }
-    
-    if (!data) {
-        return AT24C256_ERROR_PARAM;
-    }
-    
-    // 设置地址指针
-    uint8_t addr_buffer[2] = {
-        (uint8_t)((address >> 8) & 0xFF),
-        (uint8_t)(address & 0xFF)
-    };
-    
-    if (write(handle->fd, addr_buffer, 2) != 2) {
-        return AT24C256_ERROR_READ;
+    if (handle->readahead) {
+        at24c256_readahead_store(handle, address, data, length);
     }
     
-    // 读取数据
-    ssize_t bytes_read = read(handle->fd, data, length);
-    if (bytes_read != length) {
-        return AT24C256_ERROR_READ;
+    // 等待写入完成
+    if (handle->backend->write_cycle) {
+        usleep(handle->config.write_delay_ms * 1000);
     }
     
     return AT24C256_OK;
 }
 
-at24c256_err_t at24c256_write(at24c256_handle_t handle, uint16_t address, 
-                             const uint8_t* data, uint16_t length) {
-    at24c256_err_t ret = check_address_length(handle, address, length);
-    if (ret != AT24C256_OK) {
-        return ret;
+at24c256_err_t at24c256_program_nowait(at24c256_handle_t handle, uint16_t address,
+                                      const uint8_t* data, uint16_t length) {
+    if (handle->layout) {
+        at24c256_layout_record(handle, true, address, length);
     }
     
-    if (!data) {
-        return AT24C256_ERROR_PARAM;
+    uint64_t start = handle->trace ? at24c256_now_ns(handle) : 0;
+    at24c256_err_t ret = handle->backend->program_page(handle, address, data, length);
+    if (ret == AT24C256_OK && handle->readahead) {
+        at24c256_readahead_store(handle, address, data, length);
     }
-    
+    if (handle->trace) {
+        at24c256_trace_record(handle, AT24C256_TRACE_PROGRAM_PAGE, address, length, start, ret);
+    }
+    return ret;
+}
+
+at24c256_err_t at24c256_raw_write(at24c256_handle_t handle, uint16_t address, 
+                                 const uint8_t* data, uint16_t length) {
     uint16_t remaining = length;
     uint16_t current_addr = address;
     const uint8_t* current_data = data;
     
+    // 哈希目录：编程前先使所涉及区域的片上哈希失效
+    if (handle->hashdir) {
+        at24c256_err_t ret = at24c256_hashdir_before_write(handle, address, length);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+    
     while (remaining > 0) {
         // 计算当前页的剩余空间
         uint16_t page_offset = current_addr % handle->config.page_size;
@@ -190,21 +391,12 @@ at24c256_err_t at24c256_write(at24c256_handle_t handle, uint16_t address,
             bytes_in_page = remaining;
         }
         
-        // 准备写入缓冲区 (地址 + 数据)
-        uint8_t buffer[bytes_in_page + 2];
-        buffer[0] = (uint8_t)((current_addr >> 8) & 0xFF);
-        buffer[1] = (uint8_t)(current_addr & 0xFF);
-        memcpy(&buffer[2], current_data, bytes_in_page);
-        
         // 执行写入
-        ssize_t bytes_written = write(handle->fd, buffer, bytes_in_page + 2);
-        if (bytes_written != bytes_in_page + 2) {
-            return AT24C256_ERROR_WRITE;
+        at24c256_err_t ret = program_one(handle, current_addr, current_data, bytes_in_page);
+        if (ret != AT24C256_OK) {
+            return ret;
         }
         
-        // 等待写入完成
-        usleep(handle->config.write_delay_ms * 1000);
-        
         // 更新指针和剩余长度
         current_addr += bytes_in_page;
         current_data += bytes_in_page;
@@ -214,6 +406,228 @@ at24c256_err_t at24c256_write(at24c256_handle_t handle, uint16_t address,
     return AT24C256_OK;
 }
 
+/**
+ * @brief 写入公共路径：热缓存与页缓存的钩子
+ * 
+ * single_page为true时调用者保证数据不跨页，无缓存时直接编程一页。
+ * 哈希目录在编程前使区域哈希失效 (at24c256_raw_write)，新哈希推迟到flush时统一计算。
+ */
+static at24c256_err_t write_common(at24c256_handle_t handle, uint16_t address, 
+                                   const uint8_t* data, uint16_t length, bool single_page) {
+    at24c256_err_t ret;
+    
+    // 热缓存：会话中第一次写入前先使片上代数戳失效
+    if (handle->warm) {
+        ret = at24c256_warm_begin_write(handle);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+    
+    if (handle->cache) {
+        ret = at24c256_cache_write(handle, address, data, length);
+    } else if (single_page && !handle->hashdir) {
+        ret = program_one(handle, address, data, length);
+    } else {
+        ret = at24c256_raw_write(handle, address, data, length);
+    }
+    
+    return ret;
+}
+
+at24c256_err_t at24c256_read(at24c256_handle_t handle, uint16_t address, 
+                            uint8_t* data, uint16_t length) {
+    at24c256_err_t ret = check_address_length(handle, address, length);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    
+    if (!data) {
+        return AT24C256_ERROR_PARAM;
+    }
+    
+    ret = at24c256_commit_read(handle, address, data, length);
+    if (handle->layout && ret == AT24C256_OK) {
+        at24c256_layout_record(handle, false, address, length);
+    }
+    return ret;
+}
+
+at24c256_err_t at24c256_commit_read(at24c256_handle_t handle, uint16_t address,
+                                   uint8_t* data, uint16_t length) {
+    uint64_t start = handle->trace ? at24c256_now_ns(handle) : 0;
+    at24c256_err_t ret;
+    
+    if (handle->cache) {
+        ret = at24c256_cache_read(handle, address, data, length);
+    } else if (handle->readahead) {
+        ret = at24c256_readahead_read(handle, address, data, length);
+    } else {
+        ret = at24c256_raw_read(handle, address, data, length);
+    }
+    
+    if (handle->trace) {
+        at24c256_trace_record(handle, AT24C256_TRACE_READ, address, length, start, ret);
+    }
+    return ret;
+}
+
+/**
+ * @brief 批量读取时可以直接合并到I2C_RDWR中的请求
+ * 
+ * 只有不经过缓存层、单条消息即可完成的i2c-dev读取才合并。
+ */
+static bool batchable(const at24c256_read_req_t* req) {
+    at24c256_handle_t handle = req->handle;
+    if (handle->backend != &i2c_backend || handle->cache || handle->readahead ||
+        handle->trace || handle->layout || handle->map || req->length > I2C_MAX_TRANSFER) {
+        return false;
+    }
+    return handle->config.addr_bytes != 1 || (uint32_t)(req->address & 0xFF) + req->length <= 256u;
+}
+
+/**
+ * @brief 把同一总线上的一组读取合并为一次I2C_RDWR
+ */
+static bool read_batch_rdwr(at24c256_read_req_t* reqs, const int* index, int n) {
+    struct i2c_msg msgs[AT24C256_BATCH_MAX_MSGS];
+    uint8_t words[AT24C256_BATCH_MAX_MSGS / 2][2];
+    
+    for (int i = 0; i < n; i++) {
+        at24c256_read_req_t* req = &reqs[index[i]];
+        uint16_t word_len;
+        uint8_t slave = i2c_encode_address(req->handle, req->address, words[i], &word_len);
+        msgs[2 * i] = (struct i2c_msg){ .addr = slave, .flags = 0, .len = word_len,
+                                        .buf = words[i] };
+        msgs[2 * i + 1] = (struct i2c_msg){ .addr = slave, .flags = I2C_M_RD,
+                                            .len = req->length, .buf = req->data };
+    }
+    struct i2c_rdwr_ioctl_data xfer = { .msgs = msgs, .nmsgs = (uint32_t)(2 * n) };
+    return ioctl(reqs[index[0]].handle->fd, I2C_RDWR, &xfer) == 2 * n;
+}
+
+at24c256_err_t at24c256_read_batch(at24c256_read_req_t* reqs, int count) {
+    if (!reqs || count < 0) {
+        return AT24C256_ERROR_PARAM;
+    }
+    
+    bool* handled = (bool*)calloc((size_t)count + 1, sizeof(bool));
+    if (!handled) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        if (handled[i]) {
+            continue;
+        }
+        at24c256_read_req_t* req = &reqs[i];
+        handled[i] = true;
+        req->result = check_address_length(req->handle, req->address, req->length);
+        if (req->result == AT24C256_OK && !req->data) {
+            req->result = AT24C256_ERROR_PARAM;
+        }
+        if (req->result != AT24C256_OK) {
+            continue;
+        }
+        if (!batchable(req)) {
+            req->result = at24c256_read(req->handle, req->address, req->data, req->length);
+            continue;
+        }
+        
+        // 收集同一总线上其余可合并的请求
+        int index[AT24C256_BATCH_MAX_MSGS / 2];
+        int n = 0;
+        index[n++] = i;
+        for (int j = i + 1; j < count && n < AT24C256_BATCH_MAX_MSGS / 2; j++) {
+            at24c256_read_req_t* other = &reqs[j];
+            if (handled[j] || !other->data ||
+                check_address_length(other->handle, other->address, other->length) != AT24C256_OK ||
+                !batchable(other) || strcmp(other->handle->config.i2c_bus,
+                                            req->handle->config.i2c_bus) != 0) {
+                continue;
+            }
+            handled[j] = true;
+            index[n++] = j;
+        }
+        
+        bool ok = read_batch_rdwr(reqs, index, n);
+        for (int k = 0; k < n; k++) {
+            at24c256_read_req_t* r = &reqs[index[k]];
+            r->result = ok ? AT24C256_OK : i2c_read(r->handle, r->address, r->data, r->length);
+        }
+    }
+    free(handled);
+    
+    for (int i = 0; i < count; i++) {
+        if (reqs[i].result != AT24C256_OK) {
+            return reqs[i].result;
+        }
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_write(at24c256_handle_t handle, uint16_t address, 
+                             const uint8_t* data, uint16_t length) {
+    at24c256_err_t ret = check_address_length(handle, address, length);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    
+    if (!data) {
+        return AT24C256_ERROR_PARAM;
+    }
+    
+    if (handle->layout) {
+        at24c256_layout_record(handle, true, address, length);
+    }
+    
+    // 组提交：由提交线程按页编程，访问记录中是合并后的页编程
+    if (handle->group) {
+        return at24c256_group_write(handle, address, data, length);
+    }
+    
+    uint64_t start = handle->trace ? at24c256_now_ns(handle) : 0;
+    ret = write_common(handle, address, data, length, false);
+    if (handle->trace) {
+        at24c256_trace_record(handle, AT24C256_TRACE_WRITE, address, length, start, ret);
+    }
+    return ret;
+}
+
+at24c256_err_t at24c256_program_page(at24c256_handle_t handle, uint16_t address, 
+                                    const uint8_t* data, uint16_t length) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    
+    // 不跨页由调用者保证，这里只做不需要除法的检查
+    if (!data || length == 0 || length > handle->config.page_size ||
+        (uint32_t)address + length > handle->config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+    
+    if (handle->layout) {
+        at24c256_layout_record(handle, true, address, length);
+    }
+    
+    // 组提交：与其他写入一起由提交线程编程，不与提交线程同时访问总线
+    if (handle->group) {
+        return at24c256_group_write(handle, address, data, length);
+    }
+    
+    return at24c256_commit_page(handle, address, data, length);
+}
+
+at24c256_err_t at24c256_commit_page(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length) {
+    uint64_t start = handle->trace ? at24c256_now_ns(handle) : 0;
+    at24c256_err_t ret = write_common(handle, address, data, length, true);
+    if (handle->trace) {
+        at24c256_trace_record(handle, AT24C256_TRACE_PROGRAM_PAGE, address, length, start, ret);
+    }
+    return ret;
+}
+
 at24c256_err_t at24c256_erase(at24c256_handle_t handle, uint16_t address, uint16_t length) {
     at24c256_err_t ret = check_address_length(handle, address, length);
     if (ret != AT24C256_OK) {
@@ -228,13 +642,239 @@ at24c256_err_t at24c256_erase(at24c256_handle_t handle, uint16_t address, uint16
     
     memset(erase_data, 0xFF, length);
     
-    // 执行擦除写入
-    ret = at24c256_write(handle, address, erase_data, length);
+    if (handle->layout) {
+        at24c256_layout_record(handle, true, address, length);
+    }
+    
+    // 执行擦除写入 (组提交时与写入一样暂存，访问记录中是合并后的页编程)
+    if (handle->group) {
+        ret = at24c256_group_write(handle, address, erase_data, length);
+    } else {
+        uint64_t start = handle->trace ? at24c256_now_ns(handle) : 0;
+        ret = write_common(handle, address, erase_data, length, false);
+        if (handle->trace) {
+            at24c256_trace_record(handle, AT24C256_TRACE_ERASE, address, length, start, ret);
+        }
+    }
     
     free(erase_data);
     return ret;
 }
 
+/**
+ * @brief 复制中写入一块目标页
+ * 
+ * 有写周期的后端上编程后应答查询，芯片一应答就返回，不按write_delay_ms固定等待；
+ * write_delay_ms只作为查询的超时。缓存、热缓存、哈希目录与组提交需要写入钩子，走同步写入路径。
+ */
+static at24c256_err_t copy_program(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length) {
+    if (!handle->backend->write_cycle || handle->cache || handle->warm || handle->hashdir ||
+        handle->group) {
+        return at24c256_write(handle, address, data, length);
+    }
+    
+    at24c256_err_t ret = at24c256_program_nowait(handle, address, data, length);
+    if (ret == AT24C256_OK) {
+        ret = internal_wait_ready(handle, handle->config.write_delay_ms);
+    }
+    return ret;
+}
+
+/**
+ * @brief 芯片内复制的公共路径，每块之前检查截止时间
+ */
+static at24c256_err_t copy_common(at24c256_handle_t handle, uint16_t src, uint16_t dst,
+                                  uint16_t length, uint64_t deadline_ns, uint16_t* copied) {
+    at24c256_err_t ret = check_address_length(handle, src, length);
+    if (ret == AT24C256_OK) {
+        ret = check_address_length(handle, dst, length);
+    }
+    if (copied) {
+        *copied = 0;
+    }
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    if (src == dst) {
+        if (copied) {
+            *copied = length;
+        }
+        return AT24C256_OK;
+    }
+    
+    // 目标在源之后且重叠时从末尾向前复制，否则从开头向后，已读的源数据不会先被覆盖
+    uint8_t buffer[AT24C256_MAX_PAGE_SIZE];
+    uint16_t page_size = handle->config.page_size;
+    bool backward = dst > src && dst < src + length;
+    uint32_t done = 0;
+    
+    while (done < length) {
+        if (at24c256_now_ns(handle) >= deadline_ns) {
+            ret = AT24C256_ERROR_TIMEOUT;
+            break;
+        }
+        
+        // 每块正好是目标的一页 (首尾可能不满)，一次读取对应一次页编程
+        uint32_t offset;
+        uint32_t chunk;
+        if (backward) {
+            uint32_t end = (uint32_t)dst + length - done;
+            uint32_t page_start = (end - 1) / page_size * page_size;
+            uint32_t start = page_start > dst ? page_start : dst;
+            chunk = end - start;
+            offset = start - dst;
+        } else {
+            offset = done;
+            uint32_t room = page_size - (dst + offset) % page_size;
+            chunk = length - done < room ? length - done : room;
+        }
+        
+        ret = at24c256_read(handle, (uint16_t)(src + offset), buffer, (uint16_t)chunk);
+        if (ret == AT24C256_OK) {
+            ret = copy_program(handle, (uint16_t)(dst + offset), buffer, (uint16_t)chunk);
+        }
+        if (ret != AT24C256_OK) {
+            break;
+        }
+        done += chunk;
+    }
+    
+    if (copied) {
+        *copied = (uint16_t)done;
+    }
+    return ret;
+}
+
+at24c256_err_t at24c256_copy(at24c256_handle_t handle, uint16_t src, uint16_t dst,
+                            uint16_t length) {
+    return copy_common(handle, src, dst, length, AT24C256_NO_DEADLINE, NULL);
+}
+
+uint64_t at24c256_deadline_after(at24c256_handle_t handle, uint32_t timeout_us) {
+    if (!handle || !handle->initialized) {
+        return 0;
+    }
+    return at24c256_now_ns(handle) + (uint64_t)timeout_us * 1000u;
+}
+
+/**
+ * @brief 有截止时间的操作
+ */
+typedef enum {
+    DEADLINE_READ,
+    DEADLINE_WRITE,
+    DEADLINE_ERASE,
+} deadline_op_t;
+
+/**
+ * @brief 分块执行，每块之前检查截止时间，返回已完成的字节数
+ * 
+ * 写入与擦除按页边界分块 (一块一次页编程)。读取不受页边界限制：第一块一页，之后按已测得的
+ * 速率取剩余时间内能读完的长度 (至少一页，不超过I2C_MAX_TRANSFER)；不限时间时一次读完。
+ */
+static at24c256_err_t run_until(at24c256_handle_t handle, deadline_op_t op, uint16_t address,
+                                uint8_t* rdata, const uint8_t* wdata, uint16_t length,
+                                uint64_t deadline_ns, uint16_t* done) {
+    if (done) {
+        *done = 0;
+    }
+    at24c256_err_t ret = check_address_length(handle, address, length);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    if ((op == DEADLINE_READ && !rdata) || (op == DEADLINE_WRITE && !wdata)) {
+        return AT24C256_ERROR_PARAM;
+    }
+    
+    uint16_t page_size = handle->config.page_size;
+    uint64_t begin = at24c256_now_ns(handle);
+    uint32_t offset = 0;
+    while (offset < length) {
+        uint64_t now = at24c256_now_ns(handle);
+        if (now >= deadline_ns) {
+            ret = AT24C256_ERROR_TIMEOUT;
+            break;
+        }
+        
+        uint16_t current = (uint16_t)(address + offset);
+        uint32_t chunk;
+        if (op != DEADLINE_READ) {
+            chunk = page_size - current % page_size;
+        } else if (deadline_ns == AT24C256_NO_DEADLINE) {
+            chunk = I2C_MAX_TRANSFER;
+        } else if (offset == 0 || now <= begin) {
+            chunk = page_size;
+        } else {
+            uint64_t ns_per_byte = (now - begin + offset - 1) / offset;
+            uint64_t budget = (deadline_ns - now) / ns_per_byte;
+            chunk = budget < page_size ? page_size
+                  : budget > I2C_MAX_TRANSFER ? I2C_MAX_TRANSFER : (uint32_t)budget;
+        }
+        if (chunk > length - offset) {
+            chunk = length - offset;
+        }
+        
+        if (op == DEADLINE_READ) {
+            ret = at24c256_read(handle, current, rdata + offset, (uint16_t)chunk);
+        } else if (op == DEADLINE_WRITE) {
+            ret = at24c256_write(handle, current, wdata + offset, (uint16_t)chunk);
+        } else {
+            ret = at24c256_erase(handle, current, (uint16_t)chunk);
+        }
+        if (ret != AT24C256_OK) {
+            break;
+        }
+        offset += chunk;
+        if (done) {
+            *done = (uint16_t)offset;
+        }
+    }
+    
+    return ret;
+}
+
+at24c256_err_t at24c256_read_deadline(at24c256_handle_t handle, uint16_t address, uint8_t* data,
+                                     uint16_t length, uint64_t deadline_ns, uint16_t* done) {
+    return run_until(handle, DEADLINE_READ, address, data, NULL, length, deadline_ns, done);
+}
+
+at24c256_err_t at24c256_write_deadline(at24c256_handle_t handle, uint16_t address,
+                                      const uint8_t* data, uint16_t length,
+                                      uint64_t deadline_ns, uint16_t* done) {
+    return run_until(handle, DEADLINE_WRITE, address, NULL, data, length, deadline_ns, done);
+}
+
+at24c256_err_t at24c256_erase_deadline(at24c256_handle_t handle, uint16_t address,
+                                      uint16_t length, uint64_t deadline_ns, uint16_t* done) {
+    return run_until(handle, DEADLINE_ERASE, address, NULL, NULL, length, deadline_ns, done);
+}
+
+at24c256_err_t at24c256_copy_deadline(at24c256_handle_t handle, uint16_t src, uint16_t dst,
+                                     uint16_t length, uint64_t deadline_ns, uint16_t* done) {
+    return copy_common(handle, src, dst, length, deadline_ns, done);
+}
+
+at24c256_err_t at24c256_wait_ready_deadline(at24c256_handle_t handle, uint64_t deadline_ns) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    
+    for (;;) {
+        if (handle->backend->poll_ready(handle) == AT24C256_OK) {
+            return AT24C256_OK;
+        }
+        uint64_t now = at24c256_now_ns(handle);
+        if (now >= deadline_ns) {
+            return AT24C256_ERROR_TIMEOUT;
+        }
+        
+        // 每1ms查询一次，最后一次不超过截止时间
+        uint64_t wait_us = (deadline_ns - now + 999) / 1000;
+        usleep(wait_us < 1000 ? (useconds_t)wait_us : 1000);
+    }
+}
+
 at24c256_err_t at24c256_wait_ready(at24c256_handle_t handle, uint32_t timeout_ms) {
     if (!handle || !handle->initialized) {
         return AT24C256_ERROR_INIT;
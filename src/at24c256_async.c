@@ -0,0 +1,316 @@
+/**
+ * @file at24c256_async.c
+ * @brief 由事件循环驱动的异步读写
+ *
+ * 每个句柄一个异步引擎，对外暴露一个epoll文件描述符，内部包含：
+ *   - eventfd  有工作可做或有完成结果待收取
+ *   - timerfd  页编程后的写周期结束
+ * 调用者把该描述符加入自己的epoll循环，可读时调用at24c256_poll_completions。
+ * 每次调用最多执行若干步总线传输 (一次页编程或一块读取)，写周期期间不占用线程，
+ * 由timerfd唤醒后继续。请求按提交顺序逐个执行。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define STEP_BUDGET 8        // 每次调用最多执行的总线传输次数
+#define READ_CHUNK 256       // 读取每步的字节数
+#define POLL_INTERVAL_US 500 // write_delay_ms为0时应答查询的间隔
+#define POLL_LIMIT 20        // 同步查询的最多次数 (10ms，超过tWR上限)
+
+/**
+ * @brief 一个异步请求
+ */
+typedef struct async_op_s {
+    struct async_op_s* next;
+    uint32_t id;
+    void* user_data;
+    bool write;
+    uint16_t address;
+    uint8_t* data;               /**< 调用者的缓冲区，完成前必须保持有效 */
+    uint16_t length;
+    uint16_t done;               /**< 已传输的字节数 */
+    at24c256_err_t result;
+} async_op_t;
+
+/**
+ * @brief 异步引擎
+ */
+struct at24c256_async_s {
+    int epoll_fd;                /**< 对外暴露的描述符 */
+    int event_fd;
+    int timer_fd;
+    bool waiting;                /**< 写周期进行中 */
+    bool polling;                /**< 定时器到期后应答查询，未就绪时继续等待 */
+    uint32_t next_id;
+    async_op_t* head;            /**< 等待执行的请求 */
+    async_op_t* tail;
+    async_op_t* done_head;       /**< 已完成待收取的请求 */
+    async_op_t* done_tail;
+    uint32_t pending;
+};
+
+static void push(async_op_t** head, async_op_t** tail, async_op_t* op) {
+    op->next = NULL;
+    if (*tail) {
+        (*tail)->next = op;
+    } else {
+        *head = op;
+    }
+    *tail = op;
+}
+
+static async_op_t* pop(async_op_t** head, async_op_t** tail) {
+    async_op_t* op = *head;
+    if (op) {
+        *head = op->next;
+        if (!*head) {
+            *tail = NULL;
+        }
+    }
+    return op;
+}
+
+static void signal_event(struct at24c256_async_s* a) {
+    uint64_t one = 1;
+    ssize_t n = write(a->event_fd, &one, sizeof(one));
+    (void)n;   // 计数器已满时同样可读
+}
+
+static void free_list(async_op_t* op) {
+    while (op) {
+        async_op_t* next = op->next;
+        free(op);
+        op = next;
+    }
+}
+
+/**
+ * @brief 按需创建异步引擎
+ */
+static at24c256_err_t ensure_engine(at24c256_handle_t handle) {
+    if (handle->async) {
+        return AT24C256_OK;
+    }
+
+    struct at24c256_async_s* a = (struct at24c256_async_s*)calloc(1, sizeof(*a));
+    if (!a) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    a->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    a->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    a->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    struct epoll_event ev = { .events = EPOLLIN };
+    bool ok = a->epoll_fd >= 0 && a->event_fd >= 0 && a->timer_fd >= 0;
+    if (ok) {
+        ev.data.fd = a->event_fd;
+        ok = epoll_ctl(a->epoll_fd, EPOLL_CTL_ADD, a->event_fd, &ev) == 0;
+    }
+    if (ok) {
+        ev.data.fd = a->timer_fd;
+        ok = epoll_ctl(a->epoll_fd, EPOLL_CTL_ADD, a->timer_fd, &ev) == 0;
+    }
+    if (!ok) {
+        if (a->epoll_fd >= 0) close(a->epoll_fd);
+        if (a->event_fd >= 0) close(a->event_fd);
+        if (a->timer_fd >= 0) close(a->timer_fd);
+        free(a);
+        return AT24C256_ERROR_INIT;
+    }
+
+    handle->async = a;
+    return AT24C256_OK;
+}
+
+/**
+ * @brief 写周期开始：到期前不再访问总线
+ *
+ * 没有配置write_delay_ms时每POLL_INTERVAL_US应答查询一次，芯片应答后才继续。
+ */
+static void arm_write_cycle(at24c256_handle_t handle) {
+    struct at24c256_async_s* a = handle->async;
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    a->polling = handle->config.write_delay_ms == 0;
+    if (a->polling) {
+        spec.it_value.tv_nsec = POLL_INTERVAL_US * 1000L;
+    } else {
+        spec.it_value.tv_sec = handle->config.write_delay_ms / 1000;
+        spec.it_value.tv_nsec = (long)(handle->config.write_delay_ms % 1000) * 1000000L;
+    }
+    a->waiting = timerfd_settime(a->timer_fd, 0, &spec, NULL) == 0;
+    if (!a->waiting) {
+        // 定时器不可用时同步查询 (最多POLL_LIMIT次)，不在写周期内编程下一页
+        for (int i = 0; i < POLL_LIMIT && handle->backend->poll_ready(handle) != AT24C256_OK; i++) {
+            usleep(POLL_INTERVAL_US);
+        }
+    }
+}
+
+/**
+ * @brief 执行请求的下一步，返回是否需要等待写周期
+ */
+static bool step(at24c256_handle_t handle, async_op_t* op) {
+    uint16_t address = (uint16_t)(op->address + op->done);
+    uint16_t left = op->length - op->done;
+
+    if (!op->write) {
+        uint16_t len = left < READ_CHUNK ? left : READ_CHUNK;
+        op->result = at24c256_read(handle, address, op->data + op->done, len);
+        op->done += len;
+        return false;
+    }
+
+    // 回写缓存只修改内存，一步完成
+    if (at24c256_cache_write_back(handle)) {
+        op->result = at24c256_write(handle, op->address, op->data, op->length);
+        op->done = op->length;
+        return false;
+    }
+
+    uint16_t page_size = handle->config.page_size;
+    uint16_t room = page_size - address % page_size;
+    uint16_t len = left < room ? left : room;
+    op->done += len;
+
+    if (handle->cache || handle->group) {
+        // 直写缓存 (以及依赖它的热缓存、哈希目录) 走同步路径，写周期在其中等待；
+        // 组提交时由提交线程编程，不能与它同时访问总线
+        op->result = at24c256_write(handle, address, op->data + op->done - len, len);
+        return false;
+    }
+
+    op->result = at24c256_program_nowait(handle, address, op->data + op->done - len, len);
+    return op->result == AT24C256_OK && handle->backend->write_cycle;
+}
+
+int at24c256_async_fd(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized || ensure_engine(handle) != AT24C256_OK) {
+        return -1;
+    }
+    return handle->async->epoll_fd;
+}
+
+static at24c256_err_t submit(at24c256_handle_t handle, bool write, uint16_t address,
+                             uint8_t* data, uint16_t length, void* user_data, uint32_t* id) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!data || length == 0 || (uint32_t)address + length > handle->config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+    at24c256_err_t ret = ensure_engine(handle);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    async_op_t* op = (async_op_t*)calloc(1, sizeof(*op));
+    if (!op) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    struct at24c256_async_s* a = handle->async;
+    op->id = ++a->next_id;
+    op->user_data = user_data;
+    op->write = write;
+    op->address = address;
+    op->data = data;
+    op->length = length;
+    op->result = AT24C256_OK;
+
+    push(&a->head, &a->tail, op);
+    a->pending++;
+    signal_event(a);
+
+    if (id) {
+        *id = op->id;
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_async_read(at24c256_handle_t handle, uint16_t address, uint8_t* data,
+                                  uint16_t length, void* user_data, uint32_t* id) {
+    return submit(handle, false, address, data, length, user_data, id);
+}
+
+at24c256_err_t at24c256_async_write(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length,
+                                   void* user_data, uint32_t* id) {
+    // 写请求只读取缓冲区
+    return submit(handle, true, address, (uint8_t*)data, length, user_data, id);
+}
+
+int at24c256_poll_completions(at24c256_handle_t handle, at24c256_completion_t* completions,
+                              int max) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!completions || max <= 0) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (!handle->async) {
+        return 0;
+    }
+
+    struct at24c256_async_s* a = handle->async;
+    uint64_t count;
+    while (read(a->event_fd, &count, sizeof(count)) > 0) {
+    }
+    if (a->waiting && read(a->timer_fd, &count, sizeof(count)) > 0) {
+        a->waiting = false;
+        if (a->polling && handle->backend->poll_ready(handle) != AT24C256_OK) {
+            arm_write_cycle(handle);
+        }
+    }
+
+    // 推进请求，直到需要等待写周期或用完本次的预算
+    for (int steps = 0; steps < STEP_BUDGET && a->head && !a->waiting; steps++) {
+        async_op_t* op = a->head;
+        if (step(handle, op)) {
+            arm_write_cycle(handle);
+        }
+        if (op->result != AT24C256_OK || op->done == op->length) {
+            pop(&a->head, &a->tail);
+            push(&a->done_head, &a->done_tail, op);
+        }
+    }
+
+    int n = 0;
+    async_op_t* op;
+    while (n < max && (op = pop(&a->done_head, &a->done_tail)) != NULL) {
+        completions[n].id = op->id;
+        completions[n].user_data = op->user_data;
+        completions[n].result = op->result;
+        n++;
+        a->pending--;
+        free(op);
+    }
+
+    // 还有可立即执行的工作或未收取的结果时保持描述符可读
+    if ((a->head && !a->waiting) || a->done_head) {
+        signal_event(a);
+    }
+    return n;
+}
+
+uint32_t at24c256_async_pending(at24c256_handle_t handle) {
+    return handle && handle->async ? handle->async->pending : 0;
+}
+
+void at24c256_async_free(at24c256_handle_t handle) {
+    struct at24c256_async_s* a = handle->async;
+    free_list(a->head);
+    free_list(a->done_head);
+    close(a->timer_fd);
+    close(a->event_fd);
+    close(a->epoll_fd);
+    free(a);
+    handle->async = NULL;
+}
@@ -0,0 +1,348 @@
+/**
+ * @file at24c256_cache.c
+ * @brief AT24C256 页缓存
+ *
+ * 以EEPROM页为单位缓存芯片内容。每页记录是否已加载以及脏字节范围[lo, hi)：
+ * 写入已加载的页时只有与缓存内容不同的字节才扩展脏范围，因此写回时每个脏页
+ * 只需一次页内编程，内容未变的页不会被编程。未加载的页只有一段相连的脏范围时
+ * 不必读取芯片；写入与已有脏范围不相连时先加载该页，脏范围内不会有未知字节。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief 页缓存状态
+ */
+struct at24c256_cache_s {
+    at24c256_cache_mode_t mode;  /**< 缓存模式 */
+    uint32_t page_count;         /**< 页数 */
+    uint8_t* image;              /**< 芯片内容镜像 */
+    uint8_t* valid;              /**< 每页一个标志：已从芯片加载 */
+    uint16_t* dirty_lo;          /**< 每页脏范围起点 (页内偏移) */
+    uint16_t* dirty_hi;          /**< 每页脏范围终点，lo == hi 表示干净 */
+};
+
+static bool page_dirty(const struct at24c256_cache_s* c, uint32_t page) {
+    return c->dirty_lo[page] != c->dirty_hi[page];
+}
+
+/**
+ * @brief 扩展页的脏范围
+ */
+static void mark_dirty(struct at24c256_cache_s* c, uint32_t page, uint16_t lo, uint16_t hi) {
+    if (!page_dirty(c, page)) {
+        c->dirty_lo[page] = lo;
+        c->dirty_hi[page] = hi;
+        return;
+    }
+    if (lo < c->dirty_lo[page]) {
+        c->dirty_lo[page] = lo;
+    }
+    if (hi > c->dirty_hi[page]) {
+        c->dirty_hi[page] = hi;
+    }
+}
+
+/**
+ * @brief 从芯片加载连续的若干页，保留其中尚未写回的脏字节
+ */
+static at24c256_err_t load_pages(at24c256_handle_t handle, uint32_t first, uint32_t count) {
+    struct at24c256_cache_s* c = handle->cache;
+    uint16_t page_size = handle->config.page_size;
+    uint32_t address = first * page_size;
+    uint32_t length = count * page_size;
+    if (address + length > handle->config.total_size) {
+        length = handle->config.total_size - address;
+    }
+
+    uint8_t* buffer = (uint8_t*)malloc(length);
+    if (!buffer) {
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    at24c256_err_t ret = at24c256_raw_read(handle, (uint16_t)address, buffer, (uint16_t)length);
+    if (ret == AT24C256_OK) {
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t page = first + i;
+            uint8_t* dst = &c->image[page * page_size];
+            const uint8_t* src = &buffer[i * page_size];
+            if (page_dirty(c, page)) {
+                // 只填充脏范围之外的字节
+                memcpy(dst, src, c->dirty_lo[page]);
+                memcpy(dst + c->dirty_hi[page], src + c->dirty_hi[page],
+                       page_size - c->dirty_hi[page]);
+            } else {
+                memcpy(dst, src, page_size);
+            }
+            c->valid[page] = 1;
+        }
+    }
+
+    free(buffer);
+    return ret;
+}
+
+/**
+ * @brief 确保地址范围覆盖的页都已加载，连续的缺失页合并为一次读取
+ */
+static at24c256_err_t ensure_loaded(at24c256_handle_t handle, uint16_t address, uint16_t length) {
+    struct at24c256_cache_s* c = handle->cache;
+    uint16_t page_size = handle->config.page_size;
+    uint32_t page = address / page_size;
+    uint32_t last = ((uint32_t)address + length - 1) / page_size;
+
+    while (page <= last) {
+        if (c->valid[page]) {
+            page++;
+            continue;
+        }
+        uint32_t run = 1;
+        while (page + run <= last && !c->valid[page + run]) {
+            run++;
+        }
+        at24c256_err_t ret = load_pages(handle, page, run);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+        page += run;
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_cache_read(at24c256_handle_t handle, uint16_t address,
+                                  uint8_t* data, uint16_t length) {
+    at24c256_err_t ret = ensure_loaded(handle, address, length);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    memcpy(data, &handle->cache->image[address], length);
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_cache_write(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length) {
+    struct at24c256_cache_s* c = handle->cache;
+    uint16_t page_size = handle->config.page_size;
+
+    if (c->mode == AT24C256_CACHE_WRITE_THROUGH) {
+        at24c256_err_t ret = at24c256_raw_write(handle, address, data, length);
+        if (ret == AT24C256_OK) {
+            memcpy(&c->image[address], data, length);
+        }
+        return ret;
+    }
+
+    // 回写模式：按页合并，已加载的页只记录真正变化的字节
+    uint32_t offset = 0;
+    while (offset < length) {
+        uint32_t addr = address + offset;
+        uint32_t page = addr / page_size;
+        uint16_t in_page = (uint16_t)(addr % page_size);
+        uint32_t chunk = page_size - in_page;
+        if (chunk > length - offset) {
+            chunk = length - offset;
+        }
+
+        uint8_t* dst = &c->image[addr];
+        const uint8_t* src = &data[offset];
+        if (c->valid[page]) {
+            uint32_t lo = 0;
+            while (lo < chunk && dst[lo] == src[lo]) {
+                lo++;
+            }
+            if (lo < chunk) {
+                uint32_t hi = chunk;
+                while (dst[hi - 1] == src[hi - 1]) {
+                    hi--;
+                }
+                memcpy(dst + lo, src + lo, hi - lo);
+                mark_dirty(c, page, (uint16_t)(in_page + lo), (uint16_t)(in_page + hi));
+            }
+        } else if (chunk < page_size && page_dirty(c, page) &&
+                   (in_page + chunk < c->dirty_lo[page] || in_page > c->dirty_hi[page])) {
+            // 与未加载页已有的脏范围不相连：合并后的范围会包含未知字节，先加载整页
+            at24c256_err_t ret = load_pages(handle, page, 1);
+            if (ret != AT24C256_OK) {
+                return ret;
+            }
+            continue;
+        } else {
+            memcpy(dst, src, chunk);
+            mark_dirty(c, page, in_page, (uint16_t)(in_page + chunk));
+            if (chunk == page_size) {
+                c->valid[page] = 1;
+            }
+        }
+
+        offset += chunk;
+    }
+
+    return AT24C256_OK;
+}
+
+void at24c256_cache_fill(at24c256_handle_t handle, const uint8_t* image) {
+    struct at24c256_cache_s* c = handle->cache;
+    memcpy(c->image, image, handle->config.total_size);
+    memset(c->valid, 1, c->page_count);
+    memset(c->dirty_lo, 0, c->page_count * sizeof(uint16_t));
+    memset(c->dirty_hi, 0, c->page_count * sizeof(uint16_t));
+}
+
+void at24c256_cache_store(at24c256_handle_t handle, uint16_t address,
+                          const uint8_t* data, uint16_t length) {
+    memcpy(&handle->cache->image[address], data, length);
+}
+
+const uint8_t* at24c256_cache_image(at24c256_handle_t handle) {
+    return handle->cache->image;
+}
+
+bool at24c256_cache_write_back(at24c256_handle_t handle) {
+    return handle->cache && handle->cache->mode == AT24C256_CACHE_WRITE_BACK;
+}
+
+at24c256_err_t at24c256_cache_enable(at24c256_handle_t handle, at24c256_cache_mode_t mode) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (mode != AT24C256_CACHE_WRITE_THROUGH && mode != AT24C256_CACHE_WRITE_BACK) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    if (handle->cache) {
+        // 从回写切换为直写前先写回脏页
+        if (mode == AT24C256_CACHE_WRITE_THROUGH) {
+            at24c256_err_t ret = at24c256_flush(handle);
+            if (ret != AT24C256_OK) {
+                return ret;
+            }
+        }
+        handle->cache->mode = mode;
+        return AT24C256_OK;
+    }
+
+    uint16_t page_size = handle->config.page_size;
+    struct at24c256_cache_s* c = (struct at24c256_cache_s*)calloc(1, sizeof(*c));
+    if (!c) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    c->mode = mode;
+    c->page_count = (handle->config.total_size + page_size - 1) / page_size;
+    c->image = (uint8_t*)malloc((size_t)c->page_count * page_size);
+    c->valid = (uint8_t*)calloc(c->page_count, 1);
+    c->dirty_lo = (uint16_t*)calloc(c->page_count, sizeof(uint16_t));
+    c->dirty_hi = (uint16_t*)calloc(c->page_count, sizeof(uint16_t));
+    if (!c->image || !c->valid || !c->dirty_lo || !c->dirty_hi) {
+        free(c->image);
+        free(c->valid);
+        free(c->dirty_lo);
+        free(c->dirty_hi);
+        free(c);
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    handle->cache = c;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_cache_disable(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!handle->cache) {
+        return AT24C256_OK;
+    }
+
+    at24c256_err_t ret = at24c256_flush(handle);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    at24c256_cache_free(handle);
+    return AT24C256_OK;
+}
+
+void at24c256_cache_free(at24c256_handle_t handle) {
+    // 热缓存依赖页缓存，一并关闭
+    if (handle->warm) {
+        at24c256_warm_free(handle);
+    }
+
+    struct at24c256_cache_s* c = handle->cache;
+    free(c->image);
+    free(c->valid);
+    free(c->dirty_lo);
+    free(c->dirty_hi);
+    free(c);
+    handle->cache = NULL;
+}
+
+at24c256_err_t at24c256_cache_invalidate(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!handle->cache) {
+        return AT24C256_OK;
+    }
+
+    memset(handle->cache->valid, 0, handle->cache->page_count);
+    return AT24C256_OK;
+}
+
+/**
+ * @brief 写回所有脏页
+ */
+static at24c256_err_t flush_dirty(at24c256_handle_t handle) {
+    if (!handle->cache) {
+        return AT24C256_OK;
+    }
+
+    struct at24c256_cache_s* c = handle->cache;
+    uint16_t page_size = handle->config.page_size;
+    for (uint32_t page = 0; page < c->page_count; page++) {
+        if (!page_dirty(c, page)) {
+            continue;
+        }
+
+        // 每个脏页只做一次页内编程
+        uint32_t address = page * page_size + c->dirty_lo[page];
+        uint16_t length = c->dirty_hi[page] - c->dirty_lo[page];
+        at24c256_err_t ret = at24c256_raw_write(handle, (uint16_t)address,
+                                                &c->image[address], length);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+        c->dirty_lo[page] = c->dirty_hi[page] = 0;
+    }
+
+    // 数据写回后提交代数戳并更新主机侧镜像
+    if (handle->warm) {
+        at24c256_err_t ret = at24c256_warm_commit(handle);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+
+    // 代数戳的写入同样使所在区域的哈希失效，最后统一重新计算
+    if (handle->hashdir) {
+        return at24c256_hashdir_update(handle);
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_flush(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+
+    uint64_t start = handle->trace ? at24c256_now_ns(handle) : 0;
+    at24c256_err_t ret = flush_dirty(handle);
+    if (handle->trace) {
+        at24c256_trace_record(handle, AT24C256_TRACE_FLUSH, 0, 0, start, ret);
+    }
+    return ret;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file at24c256_client.c
+ * @brief at24c256d 客户端库实现
+ */
+
+#include "at24c256_client.h"
+#include "at24c256_ipc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/**
+ * @brief 客户端结构体
+ */
+struct at24c256_client_s {
+    int sock;                          /**< 与守护进程的连接 */
+    const at24c256_ipc_shm_t* shm;     /**< 只读映射的共享镜像 */
+    size_t shm_size;                   /**< 映射长度 */
+    uint32_t total_size;               /**< 芯片容量 */
+    uint32_t next_seq;                 /**< 下一个请求序号 */
+    pthread_mutex_t lock;              /**< 同一连接上请求串行化 */
+};
+
+/**
+ * @brief 完整发送缓冲区
+ */
+static int send_all(int fd, const void* buf, size_t len) {
+    const uint8_t* p = (const uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief 完整接收缓冲区
+ */
+static int recv_all(int fd, void* buf, size_t len) {
+    uint8_t* p = (uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n == 0) {
+            return -1;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief 发送一个请求并等待响应
+ */
+static at24c256_err_t transact(at24c256_client_t client, uint8_t op, uint16_t address,
+                               const uint8_t* payload, uint16_t length) {
+    if (!client) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (length == 0 || (uint32_t)address + length > client->total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_ipc_req_t req;
+    memset(&req, 0, sizeof(req));
+    req.magic = AT24C256_IPC_MAGIC;
+    req.op = op;
+    req.address = address;
+    req.length = length;
+
+    at24c256_ipc_resp_t resp;
+    at24c256_err_t ret = AT24C256_OK;
+
+    pthread_mutex_lock(&client->lock);
+    req.seq = client->next_seq++;
+    if (send_all(client->sock, &req, sizeof(req)) != 0 ||
+        (payload && send_all(client->sock, payload, length) != 0) ||
+        recv_all(client->sock, &resp, sizeof(resp)) != 0 ||
+        resp.seq != req.seq) {
+        ret = (op == AT24C256_IPC_OP_READ) ? AT24C256_ERROR_READ : AT24C256_ERROR_WRITE;
+    } else {
+        ret = (at24c256_err_t)resp.status;
+    }
+    pthread_mutex_unlock(&client->lock);
+
+    return ret;
+}
+
+at24c256_err_t at24c256_client_connect(const char* socket_path, at24c256_client_t* client) {
+    if (!client) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (!socket_path) {
+        socket_path = AT24C256_DAEMON_SOCKET;
+    }
+
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(sa.sun_path)) {
+        return AT24C256_ERROR_PARAM;
+    }
+    strcpy(sa.sun_path, socket_path);
+
+    at24c256_client_t c = (at24c256_client_t)calloc(1, sizeof(struct at24c256_client_s));
+    if (!c) {
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    c->sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (c->sock < 0 || connect(c->sock, (struct sockaddr*)&sa, sizeof(sa)) != 0) {
+        goto fail;
+    }
+
+    // 握手：获取容量与共享内存名
+    at24c256_ipc_hello_t hello;
+    if (recv_all(c->sock, &hello, sizeof(hello)) != 0 || hello.magic != AT24C256_IPC_MAGIC) {
+        goto fail;
+    }
+    hello.shm_name[AT24C256_IPC_NAME_MAX - 1] = '\0';
+
+    int shm_fd = shm_open(hello.shm_name, O_RDONLY | O_CLOEXEC, 0);
+    if (shm_fd < 0) {
+        goto fail;
+    }
+    c->shm_size = sizeof(at24c256_ipc_shm_t) + hello.total_size;
+    void* map = mmap(NULL, c->shm_size, PROT_READ, MAP_SHARED, shm_fd, 0);
+    close(shm_fd);
+    if (map == MAP_FAILED) {
+        goto fail;
+    }
+    c->shm = (const at24c256_ipc_shm_t*)map;
+    if (c->shm->magic != AT24C256_IPC_SHM_MAGIC || c->shm->total_size != hello.total_size) {
+        munmap(map, c->shm_size);
+        goto fail;
+    }
+
+    c->total_size = hello.total_size;
+    pthread_mutex_init(&c->lock, NULL);
+    *client = c;
+    return AT24C256_OK;
+
+fail:
+    if (c->sock >= 0) {
+        close(c->sock);
+    }
+    free(c);
+    return AT24C256_ERROR_INIT;
+}
+
+at24c256_err_t at24c256_client_close(at24c256_client_t client) {
+    if (!client) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    munmap((void*)client->shm, client->shm_size);
+    close(client->sock);
+    pthread_mutex_destroy(&client->lock);
+    free(client);
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_client_read(at24c256_client_t client, uint16_t address,
+                                   uint8_t* data, uint16_t length) {
+    if (!data) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_err_t ret = transact(client, AT24C256_IPC_OP_READ, address, NULL, length);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    // 顺序锁读取：拷贝期间镜像被更新则重试
+    at24c256_ipc_shm_t* shm = (at24c256_ipc_shm_t*)client->shm;
+    uint32_t before, after;
+    do {
+        before = atomic_load_explicit(&shm->seq, memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+        memcpy(data, &shm->image[address], length);
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+    } while ((before & 1u) || before != after);
+
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_client_read_ptr(at24c256_client_t client, uint16_t address,
+                                       uint16_t length, const uint8_t** data) {
+    if (!data) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_err_t ret = transact(client, AT24C256_IPC_OP_READ, address, NULL, length);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    *data = &client->shm->image[address];
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_client_write(at24c256_client_t client, uint16_t address,
+                                    const uint8_t* data, uint16_t length) {
+    if (!data) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    return transact(client, AT24C256_IPC_OP_WRITE, address, data, length);
+}
+
+at24c256_err_t at24c256_client_erase(at24c256_client_t client, uint16_t address, uint16_t length) {
+    return transact(client, AT24C256_IPC_OP_ERASE, address, NULL, length);
+}
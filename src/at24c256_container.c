@@ -0,0 +1,384 @@
+/**
+ * @file at24c256_container.c
+ * @brief EEPROM文件容器实现
+ *
+ * 片上布局与camera_data_write一致 (记录格式见at24c256_schema.h)：
+ *   0x0000                 索引头 (16字节)
+ *   0x0010                 文件索引项[AT24C256_CONTAINER_MAX_FILES] (版本2每项69字节)
+ *   索引区之后             各文件数据
+ * 挂载时兼容版本1 (按内存布局保存，每项70字节)，写回时统一写为版本2。
+ */
+
+#include "at24c256_container.h"
+#include "at24c256_internal.h"
+#include "at24c256_schema.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CONTAINER_START_ADDRESS 0x0000
+#define CONTAINER_INDEX_SIZE (AT24C256_INDEX_HEADER_SIZE + \
+                              AT24C256_CONTAINER_MAX_FILES * AT24C256_FILE_INDEX_SIZE)
+#define CONTAINER_V1_INDEX_SIZE (AT24C256_INDEX_HEADER_SIZE + \
+                                 AT24C256_CONTAINER_MAX_FILES * AT24C256_FILE_INDEX_V1_STRIDE)
+
+_Static_assert(AT24C256_FILE_NAME_MAX == AT24C256_CONTAINER_NAME_MAX, "文件名长度不一致");
+
+/**
+ * @brief 文件容器
+ */
+struct at24c256_container_s {
+    at24c256_handle_t dev;                            /**< 设备句柄 */
+    at24c256_config_t config;                         /**< 设备配置 */
+    bool owns_cache;                                  /**< 缓存是否由容器启用 */
+    bool index_dirty;                                 /**< 索引需要写回 */
+    int file_count;                                   /**< 文件数量 */
+    at24c256_file_index_t files[AT24C256_CONTAINER_MAX_FILES]; /**< 索引 */
+    bool modified[AT24C256_CONTAINER_MAX_FILES];      /**< 内容已修改，需要重新计算校验和 */
+};
+
+/**
+ * @brief 计算数据的校验和
+ */
+static uint8_t calculate_checksum(const uint8_t* data, size_t size) {
+    uint8_t checksum = 0;
+    for (size_t i = 0; i < size; i++) {
+        checksum ^= data[i];
+    }
+    return checksum;
+}
+
+static bool valid_index(at24c256_container_t c, int index) {
+    return c && index >= 0 && index < c->file_count;
+}
+
+/**
+ * @brief 文件可扩展到的最大结束地址 (下一个文件的起始地址或芯片末尾)
+ */
+static uint32_t growth_limit(at24c256_container_t c, int index) {
+    uint32_t start = c->files[index].address;
+    uint32_t limit = c->config.total_size;
+    for (int i = 0; i < c->file_count; i++) {
+        // 同一地址上的空文件按创建顺序排列，后创建的位于后面
+        bool after = c->files[i].address > start || (c->files[i].address == start && i > index);
+        if (i != index && after && c->files[i].address < limit) {
+            limit = c->files[i].address;
+        }
+    }
+    return limit;
+}
+
+at24c256_err_t at24c256_container_mount(at24c256_handle_t handle, at24c256_container_t* container) {
+    if (!handle || !container) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_container_t c = (at24c256_container_t)calloc(1, sizeof(struct at24c256_container_s));
+    if (!c) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    c->dev = handle;
+
+    at24c256_err_t ret = at24c256_get_info(handle, &c->config);
+    if (ret == AT24C256_OK && !handle->cache) {
+        // 已启用缓存时保持调用者的设置
+        ret = at24c256_cache_enable(handle, AT24C256_CACHE_WRITE_BACK);
+        c->owns_cache = (ret == AT24C256_OK);
+    }
+    if (ret != AT24C256_OK) {
+        free(c);
+        return ret;
+    }
+
+    // 一次读取整个索引区，版本1的索引项较长，需要时补读尾部
+    uint8_t index_area[CONTAINER_V1_INDEX_SIZE];
+    at24c256_index_header_t header;
+    ret = at24c256_read(handle, CONTAINER_START_ADDRESS, index_area, CONTAINER_INDEX_SIZE);
+    if (ret == AT24C256_OK) {
+        at24c256_index_header_decode(&header, index_area);
+        if (header.version == 1 && AT24C256_INDEX_HEADER_SIZE +
+            header.file_count * AT24C256_FILE_INDEX_V1_STRIDE > CONTAINER_INDEX_SIZE) {
+            ret = at24c256_read(handle, CONTAINER_START_ADDRESS + CONTAINER_INDEX_SIZE,
+                                index_area + CONTAINER_INDEX_SIZE,
+                                CONTAINER_V1_INDEX_SIZE - CONTAINER_INDEX_SIZE);
+        }
+    }
+    if (ret != AT24C256_OK) {
+        if (c->owns_cache) {
+            at24c256_cache_disable(handle);
+        }
+        free(c);
+        return ret;
+    }
+
+    if (memcmp(header.magic, AT24C256_INDEX_MAGIC, 4) == 0 &&
+        (header.version == 1 || header.version == AT24C256_INDEX_VERSION) &&
+        header.file_count <= AT24C256_CONTAINER_MAX_FILES) {
+        size_t stride = header.version == 1 ? AT24C256_FILE_INDEX_V1_STRIDE : AT24C256_FILE_INDEX_SIZE;
+        c->file_count = header.file_count;
+        for (int i = 0; i < c->file_count; i++) {
+            at24c256_file_index_decode(&c->files[i],
+                                       index_area + AT24C256_INDEX_HEADER_SIZE + i * stride);
+            c->files[i].filename[AT24C256_CONTAINER_NAME_MAX - 1] = '\0';
+        }
+        // 版本1的索引在下一次sync时改写为版本2
+        c->index_dirty = header.version != AT24C256_INDEX_VERSION;
+    }
+
+    *container = c;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_container_unmount(at24c256_container_t container) {
+    if (!container) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_err_t ret = at24c256_container_sync(container);
+    if (container->owns_cache) {
+        at24c256_err_t err = at24c256_cache_disable(container->dev);
+        if (ret == AT24C256_OK) {
+            ret = err;
+        }
+    }
+
+    free(container);
+    return ret;
+}
+
+int at24c256_container_count(at24c256_container_t container) {
+    return container ? container->file_count : 0;
+}
+
+at24c256_err_t at24c256_container_stat(at24c256_container_t container, int index,
+                                      at24c256_file_info_t* info) {
+    if (!valid_index(container, index) || !info) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    const at24c256_file_index_t* f = &container->files[index];
+    memcpy(info->name, f->filename, AT24C256_CONTAINER_NAME_MAX);
+    info->address = f->address;
+    info->size = f->size;
+    info->checksum = f->checksum;
+    return AT24C256_OK;
+}
+
+int at24c256_container_find(at24c256_container_t container, const char* name) {
+    if (!container || !name) {
+        return -1;
+    }
+
+    for (int i = 0; i < container->file_count; i++) {
+        if (strcmp(container->files[i].filename, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+at24c256_err_t at24c256_container_read(at24c256_container_t container, int index, uint32_t offset,
+                                      uint8_t* data, uint32_t length, uint32_t* done) {
+    if (!valid_index(container, index) || !data || !done) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    const at24c256_file_index_t* f = &container->files[index];
+    *done = 0;
+    if (offset >= f->size || length == 0) {
+        return AT24C256_OK;
+    }
+    if (length > f->size - offset) {
+        length = f->size - offset;
+    }
+
+    at24c256_err_t ret = at24c256_read(container->dev, (uint16_t)(f->address + offset),
+                                       data, (uint16_t)length);
+    if (ret == AT24C256_OK) {
+        *done = length;
+    }
+    return ret;
+}
+
+at24c256_err_t at24c256_container_write(at24c256_container_t container, int index, uint32_t offset,
+                                       const uint8_t* data, uint32_t length) {
+    if (!valid_index(container, index) || (!data && length > 0)) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (length == 0) {
+        return AT24C256_OK;
+    }
+
+    at24c256_file_index_t* f = &container->files[index];
+    if ((uint32_t)f->address + offset + length > growth_limit(container, index)) {
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    // 在文件末尾之后写入时先把中间的空洞清零
+    if (offset > f->size) {
+        at24c256_err_t ret = at24c256_container_truncate(container, index, offset);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+
+    at24c256_err_t ret = at24c256_write(container->dev, (uint16_t)(f->address + offset),
+                                        data, (uint16_t)length);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    if (offset + length > f->size) {
+        f->size = (uint16_t)(offset + length);
+    }
+    container->modified[index] = true;
+    container->index_dirty = true;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_container_truncate(at24c256_container_t container, int index, uint32_t size) {
+    if (!valid_index(container, index)) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_file_index_t* f = &container->files[index];
+    if (size > f->size) {
+        if ((uint32_t)f->address + size > growth_limit(container, index)) {
+            return AT24C256_ERROR_MEMORY;
+        }
+        uint32_t gap = size - f->size;
+        uint8_t* zeros = (uint8_t*)calloc(gap, 1);
+        if (!zeros) {
+            return AT24C256_ERROR_MEMORY;
+        }
+        at24c256_err_t ret = at24c256_write(container->dev, (uint16_t)(f->address + f->size),
+                                            zeros, (uint16_t)gap);
+        free(zeros);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+
+    if (f->size != size) {
+        f->size = (uint16_t)size;
+        container->modified[index] = true;
+        container->index_dirty = true;
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_container_create(at24c256_container_t container, const char* name,
+                                        int* index) {
+    if (!container || !name || !index || name[0] == '\0' ||
+        strlen(name) >= AT24C256_CONTAINER_NAME_MAX) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (at24c256_container_find(container, name) >= 0) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (container->file_count >= AT24C256_CONTAINER_MAX_FILES) {
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    // 新文件放在所有现有文件数据之后
+    uint32_t address = CONTAINER_START_ADDRESS + CONTAINER_INDEX_SIZE;
+    for (int i = 0; i < container->file_count; i++) {
+        uint32_t end = (uint32_t)container->files[i].address + container->files[i].size;
+        if (end > address) {
+            address = end;
+        }
+    }
+    if (address >= container->config.total_size) {
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    at24c256_file_index_t* f = &container->files[container->file_count];
+    memset(f, 0, sizeof(*f));
+    strcpy(f->filename, name);
+    f->address = (uint16_t)address;
+    container->modified[container->file_count] = false;
+    *index = container->file_count++;
+    container->index_dirty = true;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_container_remove(at24c256_container_t container, int index) {
+    if (!valid_index(container, index)) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    int tail = container->file_count - index - 1;
+    memmove(&container->files[index], &container->files[index + 1], tail * sizeof(at24c256_file_index_t));
+    memmove(&container->modified[index], &container->modified[index + 1], tail * sizeof(bool));
+    container->file_count--;
+    container->index_dirty = true;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_container_rename(at24c256_container_t container, int index,
+                                        const char* name) {
+    if (!valid_index(container, index) || !name || name[0] == '\0' ||
+        strlen(name) >= AT24C256_CONTAINER_NAME_MAX) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_file_index_t* f = &container->files[index];
+    memset(f->filename, 0, sizeof(f->filename));
+    strcpy(f->filename, name);
+    container->index_dirty = true;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_container_sync(at24c256_container_t container) {
+    if (!container) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    // 重新计算修改过的文件的校验和 (数据已在缓存中)
+    for (int i = 0; i < container->file_count; i++) {
+        at24c256_file_index_t* f = &container->files[i];
+        if (!container->modified[i]) {
+            continue;
+        }
+        uint8_t* buffer = (uint8_t*)malloc(f->size ? f->size : 1);
+        if (!buffer) {
+            return AT24C256_ERROR_MEMORY;
+        }
+        at24c256_err_t ret = f->size ? at24c256_read(container->dev, f->address, buffer, f->size)
+                                     : AT24C256_OK;
+        if (ret == AT24C256_OK) {
+            f->checksum = calculate_checksum(buffer, f->size);
+        }
+        free(buffer);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+        container->modified[i] = false;
+    }
+
+    if (container->index_dirty) {
+        uint8_t index_area[CONTAINER_INDEX_SIZE];
+        at24c256_index_header_t header;
+        memset(index_area, 0, sizeof(index_area));
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, AT24C256_INDEX_MAGIC, 4);
+        header.version = AT24C256_INDEX_VERSION;
+        header.file_count = (uint8_t)container->file_count;
+        for (int i = 0; i < container->file_count; i++) {
+            header.total_size += container->files[i].size;
+            at24c256_file_index_encode(&container->files[i],
+                                       index_area + AT24C256_INDEX_HEADER_SIZE +
+                                       i * AT24C256_FILE_INDEX_SIZE);
+        }
+        at24c256_index_header_encode(&header, index_area);
+
+        // 经回写缓存写入，内容未变化的页不会被编程
+        at24c256_err_t ret = at24c256_write(container->dev, CONTAINER_START_ADDRESS,
+                                            index_area, sizeof(index_area));
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+        container->index_dirty = false;
+    }
+
+    return at24c256_flush(container->dev);
+}
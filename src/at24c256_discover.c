@@ -0,0 +1,145 @@
+/**
+ * @file at24c256_discover.c
+ * @brief 多总线设备发现
+ *
+ * 每条总线一个线程并发探测。一条总线上的候选地址用零长度写消息 (只有地址字节，
+ * 与SMBus quick命令相同；适配器不支持零长度消息时改为读1字节) 放在一次I2C_RDWR中
+ * 探测：全部应答时一次调用即完成；任一地址不应答时整个调用失败，把这一组分成两半
+ * 分别重试，直到单个地址。芯片都在时每条总线只需一次系统调用，缺少的芯片只在所在的一半中重试。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+/**
+ * @brief 一条总线的探测任务
+ */
+typedef struct {
+    const char* bus;
+    const at24c256_config_t* config;
+    uint8_t candidates[AT24C256_DISCOVER_ADDRS];
+    int candidate_count;
+    at24c256_handle_t found[AT24C256_DISCOVER_ADDRS];
+    int found_count;
+} bus_probe_t;
+
+/**
+ * @brief 探测一组地址，应答的地址记入present
+ */
+static void probe_group(int fd, bool quick, const uint8_t* addrs, int n, bool* present) {
+    struct i2c_msg msgs[AT24C256_DISCOVER_ADDRS];
+    uint8_t scratch[AT24C256_DISCOVER_ADDRS];
+    for (int i = 0; i < n; i++) {
+        msgs[i] = (struct i2c_msg){ .addr = addrs[i], .flags = quick ? 0 : I2C_M_RD,
+                                    .len = quick ? 0 : 1, .buf = &scratch[i] };
+    }
+    struct i2c_rdwr_ioctl_data xfer = { .msgs = msgs, .nmsgs = (uint32_t)n };
+    if (ioctl(fd, I2C_RDWR, &xfer) == n) {
+        for (int i = 0; i < n; i++) {
+            present[i] = true;
+        }
+        return;
+    }
+    if (n > 1) {
+        probe_group(fd, quick, addrs, n / 2, present);
+        probe_group(fd, quick, addrs + n / 2, n - n / 2, present + n / 2);
+    }
+}
+
+static void* probe_bus(void* arg) {
+    bus_probe_t* probe = (bus_probe_t*)arg;
+    bool present[AT24C256_DISCOVER_ADDRS] = { false };
+
+    int fd = open(probe->bus, O_RDWR);
+    if (fd < 0) {
+        return NULL;
+    }
+    unsigned long funcs = 0;
+    if (ioctl(fd, I2C_FUNCS, &funcs) == 0 && (funcs & I2C_FUNC_I2C)) {
+        // 不支持零长度消息的适配器 (I2C_AQ_NO_ZERO_LEN) 由内核去掉SMBUS_QUICK
+        probe_group(fd, (funcs & I2C_FUNC_SMBUS_QUICK) != 0, probe->candidates,
+                    probe->candidate_count, present);
+    }
+    close(fd);
+
+    for (int i = 0; i < probe->candidate_count; i++) {
+        if (!present[i]) {
+            continue;
+        }
+        at24c256_config_t config = *probe->config;
+        config.i2c_bus = probe->bus;
+        config.device_addr = probe->candidates[i];
+        if (at24c256_init(&config, &probe->found[probe->found_count]) == AT24C256_OK) {
+            probe->found_count++;
+        }
+    }
+    return NULL;
+}
+
+at24c256_err_t at24c256_discover(const char* const* buses, int bus_count,
+                                const at24c256_config_t* config, at24c256_handle_t* handles,
+                                int max_handles, int* count) {
+    if (!buses || bus_count <= 0 || !config || !handles || !count || config->sim ||
+        config->nvmem_path) {
+        return AT24C256_ERROR_PARAM;
+    }
+    *count = 0;
+
+    // 1字节字地址且超过256字节的器件占用多个连续地址，只探测每个器件的基地址
+    uint8_t addr_bytes = config->addr_bytes ? config->addr_bytes : 2;
+    uint32_t span = addr_bytes == 1 && config->total_size > 256 ? config->total_size / 256 : 1;
+    if (span > AT24C256_DISCOVER_ADDRS) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    bus_probe_t* probes = (bus_probe_t*)calloc((size_t)bus_count, sizeof(bus_probe_t));
+    pthread_t* threads = (pthread_t*)calloc((size_t)bus_count, sizeof(pthread_t));
+    bool* started = (bool*)calloc((size_t)bus_count, sizeof(bool));
+    if (!probes || !threads || !started) {
+        free(probes);
+        free(threads);
+        free(started);
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    for (int b = 0; b < bus_count; b++) {
+        probes[b].bus = buses[b];
+        probes[b].config = config;
+        for (uint32_t a = 0; a < AT24C256_DISCOVER_ADDRS; a += span) {
+            probes[b].candidates[probes[b].candidate_count++] =
+                (uint8_t)(AT24C256_DISCOVER_BASE + a);
+        }
+        started[b] = pthread_create(&threads[b], NULL, probe_bus, &probes[b]) == 0;
+        if (!started[b]) {
+            probe_bus(&probes[b]);
+        }
+    }
+
+    at24c256_err_t ret = AT24C256_OK;
+    for (int b = 0; b < bus_count; b++) {
+        if (started[b]) {
+            pthread_join(threads[b], NULL);
+        }
+        for (int i = 0; i < probes[b].found_count; i++) {
+            if (*count < max_handles) {
+                handles[(*count)++] = probes[b].found[i];
+            } else {
+                at24c256_deinit(probes[b].found[i]);
+                ret = AT24C256_ERROR_MEMORY;
+            }
+        }
+    }
+
+    free(probes);
+    free(threads);
+    free(started);
+    return ret;
+}
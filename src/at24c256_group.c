@@ -0,0 +1,258 @@
+/**
+ * @file at24c256_group.c
+ * @brief 跨线程的组提交
+ *
+ * 写入者把数据暂存到芯片大小的暂存区 (每字节一个"已提供"标志，每页一个脏范围)，
+ * 挂到当前批的等待链表上。没有提交线程时，写入者自己成为提交线程：等待收集窗口后
+ * 取走整批 (清空暂存区)，释放锁后逐页编程，完成后唤醒这一批的写入者。编程期间
+ * 到达的写入进入下一批，提交线程在暂存区为空之前持续提交。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/**
+ * @brief 等待中的写入者
+ */
+typedef struct waiter_s {
+    struct waiter_s* next;
+    at24c256_err_t result;
+    bool done;
+} waiter_t;
+
+/**
+ * @brief 取走的一页
+ */
+typedef struct {
+    uint16_t address;            /**< 合并范围的起始地址 */
+    uint16_t length;             /**< 合并范围的长度 (不跨页) */
+    bool complete;               /**< 范围内每个字节都由写入者提供 */
+} batch_page_t;
+
+/**
+ * @brief 组提交状态
+ */
+struct at24c256_group_s {
+    pthread_mutex_t lock;
+    pthread_cond_t done;         /**< 一批提交完成 */
+    uint32_t window_us;
+    bool committing;             /**< 已有提交线程 */
+    uint8_t* staged;             /**< 暂存的数据 (按芯片地址) */
+    uint8_t* provided;           /**< 每字节一个标志：由写入者提供 */
+    uint16_t* lo;                /**< 每页脏范围起点 (页内偏移) */
+    uint16_t* hi;                /**< 每页脏范围终点，lo == hi 表示没有暂存 */
+    uint32_t* dirty;             /**< 有暂存数据的页 */
+    uint32_t dirty_count;
+    waiter_t* waiters;           /**< 当前批的写入者 */
+    batch_page_t* batch;         /**< 取走的一批 */
+    uint8_t* batch_data;         /**< 取走的数据，每页page_size字节 */
+    uint8_t* batch_provided;
+};
+
+/**
+ * @brief 把写入暂存到各页 (持有锁)
+ */
+static void stage(struct at24c256_group_s* g, uint16_t page_size, uint16_t address,
+                  const uint8_t* data, uint16_t length) {
+    memcpy(g->staged + address, data, length);
+    memset(g->provided + address, 1, length);
+
+    uint32_t end = (uint32_t)address + length;
+    for (uint32_t page = address / page_size; page * page_size < end; page++) {
+        uint32_t base = page * page_size;
+        uint16_t lo = (uint16_t)(address > base ? address - base : 0);
+        uint16_t hi = (uint16_t)(end < base + page_size ? end - base : page_size);
+        if (g->lo[page] == g->hi[page]) {
+            g->dirty[g->dirty_count++] = page;
+            g->lo[page] = lo;
+            g->hi[page] = hi;
+            continue;
+        }
+        if (lo < g->lo[page]) {
+            g->lo[page] = lo;
+        }
+        if (hi > g->hi[page]) {
+            g->hi[page] = hi;
+        }
+    }
+}
+
+/**
+ * @brief 取走暂存区中的一批并清空暂存区 (持有锁)
+ */
+static uint32_t take_batch(struct at24c256_group_s* g, uint16_t page_size) {
+    uint32_t count = g->dirty_count;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t page = g->dirty[i];
+        uint32_t address = page * page_size + g->lo[page];
+        uint16_t length = g->hi[page] - g->lo[page];
+        uint8_t* data = g->batch_data + (size_t)i * page_size;
+        uint8_t* provided = g->batch_provided + (size_t)i * page_size;
+
+        memcpy(data, g->staged + address, length);
+        memcpy(provided, g->provided + address, length);
+        memset(g->provided + address, 0, length);
+        g->batch[i].address = (uint16_t)address;
+        g->batch[i].length = length;
+        g->batch[i].complete = memchr(provided, 0, length) == NULL;
+        g->lo[page] = g->hi[page] = 0;
+    }
+    g->dirty_count = 0;
+    return count;
+}
+
+/**
+ * @brief 编程取走的一批 (不持有锁)
+ */
+static at24c256_err_t commit_batch(at24c256_handle_t handle, uint32_t count) {
+    struct at24c256_group_s* g = handle->group;
+    uint16_t page_size = handle->config.page_size;
+    uint8_t chip[AT24C256_MAX_PAGE_SIZE];
+    at24c256_err_t result = AT24C256_OK;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const batch_page_t* p = &g->batch[i];
+        uint8_t* data = g->batch_data + (size_t)i * page_size;
+        const uint8_t* provided = g->batch_provided + (size_t)i * page_size;
+
+        // 写入者之间的空隙保持芯片原有内容
+        if (!p->complete) {
+            at24c256_err_t ret = at24c256_commit_read(handle, p->address, chip, p->length);
+            if (ret != AT24C256_OK) {
+                result = ret;
+                continue;
+            }
+            for (uint16_t j = 0; j < p->length; j++) {
+                if (!provided[j]) {
+                    data[j] = chip[j];
+                }
+            }
+        }
+
+        at24c256_err_t ret = at24c256_commit_page(handle, p->address, data, p->length);
+        if (ret != AT24C256_OK) {
+            result = ret;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 作为提交线程提交，直到暂存区为空 (持有锁进入与返回)
+ */
+static void lead(at24c256_handle_t handle) {
+    struct at24c256_group_s* g = handle->group;
+    bool first = true;
+
+    while (g->dirty_count > 0) {
+        if (first && g->window_us > 0) {
+            pthread_mutex_unlock(&g->lock);
+            usleep(g->window_us);
+            pthread_mutex_lock(&g->lock);
+        }
+        first = false;
+
+        uint32_t count = take_batch(g, handle->config.page_size);
+        waiter_t* waiters = g->waiters;
+        g->waiters = NULL;
+
+        pthread_mutex_unlock(&g->lock);
+        at24c256_err_t result = commit_batch(handle, count);
+        pthread_mutex_lock(&g->lock);
+
+        for (waiter_t* w = waiters; w; w = w->next) {
+            w->result = result;
+            w->done = true;
+        }
+        pthread_cond_broadcast(&g->done);
+    }
+    g->committing = false;
+}
+
+at24c256_err_t at24c256_group_write(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length) {
+    struct at24c256_group_s* g = handle->group;
+    waiter_t self = { .next = NULL, .result = AT24C256_OK, .done = false };
+
+    pthread_mutex_lock(&g->lock);
+    stage(g, handle->config.page_size, address, data, length);
+    self.next = g->waiters;
+    g->waiters = &self;
+
+    if (!g->committing) {
+        g->committing = true;
+        lead(handle);
+    }
+    while (!self.done) {
+        pthread_cond_wait(&g->done, &g->lock);
+    }
+    pthread_mutex_unlock(&g->lock);
+    return self.result;
+}
+
+static void group_free(struct at24c256_group_s* g) {
+    free(g->staged);
+    free(g->provided);
+    free(g->lo);
+    free(g->hi);
+    free(g->dirty);
+    free(g->batch);
+    free(g->batch_data);
+    free(g->batch_provided);
+    free(g);
+}
+
+at24c256_err_t at24c256_group_commit_enable(at24c256_handle_t handle, uint32_t window_us) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (handle->group) {
+        handle->group->window_us = window_us;
+        return AT24C256_OK;
+    }
+
+    uint32_t total = handle->config.total_size;
+    uint16_t page_size = handle->config.page_size;
+    uint32_t pages = (total + page_size - 1) / page_size;
+    struct at24c256_group_s* g = (struct at24c256_group_s*)calloc(1, sizeof(*g));
+    if (!g) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    g->window_us = window_us;
+    g->staged = (uint8_t*)malloc(total);
+    g->provided = (uint8_t*)calloc(total, 1);
+    g->lo = (uint16_t*)calloc(pages, sizeof(uint16_t));
+    g->hi = (uint16_t*)calloc(pages, sizeof(uint16_t));
+    g->dirty = (uint32_t*)malloc(pages * sizeof(uint32_t));
+    g->batch = (batch_page_t*)malloc(pages * sizeof(batch_page_t));
+    g->batch_data = (uint8_t*)malloc((size_t)pages * page_size);
+    g->batch_provided = (uint8_t*)malloc((size_t)pages * page_size);
+    if (!g->staged || !g->provided || !g->lo || !g->hi || !g->dirty || !g->batch ||
+        !g->batch_data || !g->batch_provided) {
+        group_free(g);
+        return AT24C256_ERROR_MEMORY;
+    }
+    pthread_mutex_init(&g->lock, NULL);
+    pthread_cond_init(&g->done, NULL);
+
+    handle->group = g;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_group_commit_disable(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    struct at24c256_group_s* g = handle->group;
+    if (g) {
+        handle->group = NULL;
+        pthread_cond_destroy(&g->done);
+        pthread_mutex_destroy(&g->lock);
+        group_free(g);
+    }
+    return AT24C256_OK;
+}
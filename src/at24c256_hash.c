@@ -0,0 +1,70 @@
+/**
+ * @file at24c256_hash.c
+ * @brief 内容哈希与小端/CRC编码辅助
+ */
+
+#include "at24c256_internal.h"
+
+#define FNV64_PRIME 0x100000001B3ULL
+
+uint64_t at24c256_hash64(const uint8_t* data, size_t length, uint64_t seed) {
+    uint64_t hash = seed;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= FNV64_PRIME;
+    }
+    return hash;
+}
+
+uint64_t at24c256_hash64_except(const uint8_t* data, uint32_t base, uint32_t length,
+                                const at24c256_span_t* holes, int hole_count, uint64_t seed) {
+    uint32_t pos = base;
+    uint32_t end = base + length;
+
+    while (pos < end) {
+        // 跳过pos所在的空洞，否则哈希到下一个空洞起点为止
+        uint32_t stop = end;
+        bool skipped = false;
+        for (int i = 0; i < hole_count; i++) {
+            uint32_t lo = holes[i].address;
+            uint32_t hi = lo + holes[i].length;
+            if (pos >= lo && pos < hi) {
+                pos = hi;
+                skipped = true;
+                break;
+            }
+            if (lo > pos && lo < stop) {
+                stop = lo;
+            }
+        }
+        if (!skipped) {
+            seed = at24c256_hash64(data + (pos - base), stop - pos, seed);
+            pos = stop;
+        }
+    }
+    return seed;
+}
+
+void at24c256_put_le(uint8_t* p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+uint64_t at24c256_get_le(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+uint8_t at24c256_crc8(uint8_t crc, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (uint8_t)(crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
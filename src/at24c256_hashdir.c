@@ -0,0 +1,339 @@
+/**
+ * @file at24c256_hashdir.c
+ * @brief 片上内容哈希目录
+ *
+ * 芯片按1KB划分区域，片上保存每个区域的64位FNV-1a哈希 (小端)：
+ *   0   magic "A2HD"
+ *   4   region_count  区域数 (u16)
+ *   6   保留
+ *   8   hash[region_count]  0表示未知 (写入中途掉电)
+ *
+ * 区域哈希不包含目录本身。任何区域被编程前先把其哈希清零，因此目录中的非零哈希
+ * 总是与芯片内容一致。清零每个写入会话 (两次flush之间) 每个区域只做一次，新哈希推迟到
+ * flush (或diff) 时统一计算并连续写入一段目录项：连续的小写入不必每次额外编程目录。
+ * 比较目标镜像与芯片只需读取目录 (32KB芯片为264字节)，只有哈希不同的区域才需要读取或重新编程。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_SIZE 8
+#define HEADER_MAGIC "A2HD"
+#define MAX_REGIONS 64
+
+/**
+ * @brief 哈希目录状态
+ */
+struct at24c256_hashdir_s {
+    uint16_t address;            /**< 目录地址 */
+    uint16_t length;             /**< 目录字节数 */
+    uint32_t region_count;       /**< 区域数 */
+    uint64_t hash[MAX_REGIONS];  /**< 各区域哈希 (与片上一致) */
+    uint64_t stale;              /**< 片上已清零、等待重新计算的区域 */
+};
+
+/**
+ * @brief 计算一个区域的哈希 (跳过目录本身，结果不为0)
+ */
+static uint64_t region_hash(const struct at24c256_hashdir_s* d, uint32_t region,
+                            const uint8_t* data) {
+    at24c256_span_t hole = { d->address, d->length };
+    uint64_t hash = at24c256_hash64_except(data, region * AT24C256_HASHDIR_REGION_SIZE,
+                                           AT24C256_HASHDIR_REGION_SIZE, &hole, 1,
+                                           AT24C256_HASH64_SEED);
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief 从芯片 (有页缓存时经缓存) 读取区域并计算哈希
+ */
+static at24c256_err_t read_region_hash(at24c256_handle_t handle, uint32_t region, uint64_t* hash) {
+    uint8_t buffer[AT24C256_HASHDIR_REGION_SIZE];
+    uint16_t address = (uint16_t)(region * AT24C256_HASHDIR_REGION_SIZE);
+
+    at24c256_err_t ret = handle->cache
+        ? at24c256_cache_read(handle, address, buffer, sizeof(buffer))
+        : at24c256_raw_read(handle, address, buffer, sizeof(buffer));
+    if (ret == AT24C256_OK) {
+        *hash = region_hash(handle->hashdir, region, buffer);
+    }
+    return ret;
+}
+
+/**
+ * @brief 将区域 [first, first + count) 的哈希写入片上目录
+ */
+static at24c256_err_t store_hashes(at24c256_handle_t handle, uint32_t first, uint32_t count) {
+    struct at24c256_hashdir_s* d = handle->hashdir;
+    uint8_t buffer[MAX_REGIONS * 8];
+    for (uint32_t i = 0; i < count; i++) {
+        at24c256_put_le(buffer + i * 8, d->hash[first + i], 8);
+    }
+
+    uint16_t address = (uint16_t)(d->address + HEADER_SIZE + first * 8);
+    at24c256_err_t ret = at24c256_raw_write(handle, address, buffer, (uint16_t)(count * 8));
+    if (ret == AT24C256_OK && handle->cache) {
+        at24c256_cache_store(handle, address, buffer, (uint16_t)(count * 8));
+    }
+    return ret;
+}
+
+/**
+ * @brief 片上目录无效时整片重建
+ */
+static at24c256_err_t rebuild(at24c256_handle_t handle) {
+    struct at24c256_hashdir_s* d = handle->hashdir;
+    for (uint32_t region = 0; region < d->region_count; region++) {
+        at24c256_err_t ret = read_region_hash(handle, region, &d->hash[region]);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+
+    uint8_t header[HEADER_SIZE] = { 0 };
+    memcpy(header, HEADER_MAGIC, 4);
+    header[4] = (uint8_t)d->region_count;
+    header[5] = (uint8_t)(d->region_count >> 8);
+
+    at24c256_err_t ret = at24c256_raw_write(handle, d->address, header, HEADER_SIZE);
+    if (ret == AT24C256_OK && handle->cache) {
+        at24c256_cache_store(handle, d->address, header, HEADER_SIZE);
+    }
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    return store_hashes(handle, 0, d->region_count);
+}
+
+at24c256_err_t at24c256_hashdir_enable(at24c256_handle_t handle, uint16_t table_address) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (handle->hashdir) {
+        return AT24C256_OK;
+    }
+
+    uint32_t total = handle->config.total_size;
+    uint32_t region_count = total / AT24C256_HASHDIR_REGION_SIZE;
+    if (total % AT24C256_HASHDIR_REGION_SIZE != 0 || region_count == 0 ||
+        region_count > MAX_REGIONS) {
+        return AT24C256_ERROR_UNSUPPORTED;
+    }
+
+    uint16_t length = (uint16_t)(HEADER_SIZE + region_count * 8);
+    if (table_address == AT24C256_HASHDIR_AT_END) {
+        // 热缓存代数戳之前、按页对齐
+        uint32_t address = total - 16 - length;
+        table_address = (uint16_t)(address - address % handle->config.page_size);
+    }
+    if ((uint32_t)table_address + length > total) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    // 区域哈希的增量更新经页缓存读取，避免每次写入后重新从总线读1KB
+    at24c256_err_t ret = AT24C256_OK;
+    if (!handle->cache) {
+        ret = at24c256_cache_enable(handle, AT24C256_CACHE_WRITE_THROUGH);
+    } else {
+        ret = at24c256_flush(handle);
+    }
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    struct at24c256_hashdir_s* d = (struct at24c256_hashdir_s*)calloc(1, sizeof(*d));
+    if (!d) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    d->address = table_address;
+    d->length = length;
+    d->region_count = region_count;
+    handle->hashdir = d;
+
+    // 目录总是直接从芯片读取：热缓存镜像中的目录可能不是最新的
+    uint8_t table[HEADER_SIZE + MAX_REGIONS * 8];
+    ret = at24c256_raw_read(handle, table_address, table, length);
+    if (ret != AT24C256_OK) {
+        goto fail;
+    }
+
+    if (memcmp(table, HEADER_MAGIC, 4) != 0 ||
+        (uint32_t)(table[4] | (table[5] << 8)) != region_count) {
+        ret = rebuild(handle);
+        if (ret != AT24C256_OK) {
+            goto fail;
+        }
+        return AT24C256_OK;
+    }
+
+    // 上次写入中途掉电留下的未知哈希在此补算
+    for (uint32_t region = 0; region < region_count; region++) {
+        d->hash[region] = at24c256_get_le(table + HEADER_SIZE + region * 8, 8);
+        if (d->hash[region] == 0) {
+            d->stale |= 1ULL << region;
+        }
+    }
+    ret = at24c256_hashdir_update(handle);
+    if (ret != AT24C256_OK) {
+        goto fail;
+    }
+    return AT24C256_OK;
+
+fail:
+    handle->hashdir = NULL;
+    free(d);
+    return ret;
+}
+
+at24c256_err_t at24c256_hashdir_disable(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!handle->hashdir) {
+        return AT24C256_OK;
+    }
+
+    at24c256_err_t ret = at24c256_flush(handle);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    free(handle->hashdir);
+    handle->hashdir = NULL;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_hashdir_diff(at24c256_handle_t handle, const uint8_t* image,
+                                    uint64_t* mask) {
+    if (!handle || !handle->initialized || !handle->hashdir) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!image || !mask) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    // 先补算本会话中写入过的区域
+    at24c256_err_t ret = at24c256_hashdir_update(handle);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    const struct at24c256_hashdir_s* d = handle->hashdir;
+    *mask = 0;
+    for (uint32_t region = 0; region < d->region_count; region++) {
+        const uint8_t* data = image + region * AT24C256_HASHDIR_REGION_SIZE;
+        if (d->hash[region] == 0 || d->hash[region] != region_hash(d, region, data)) {
+            *mask |= 1ULL << region;
+        }
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_hashdir_sync(at24c256_handle_t handle, const uint8_t* image,
+                                    uint64_t* written) {
+    uint64_t mask = 0;
+    at24c256_err_t ret = at24c256_hashdir_diff(handle, image, &mask);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    const struct at24c256_hashdir_s* d = handle->hashdir;
+    uint32_t table_end = (uint32_t)d->address + d->length;
+    for (uint32_t region = 0; region < d->region_count; region++) {
+        if (!(mask & (1ULL << region))) {
+            continue;
+        }
+
+        // 目录本身不从镜像写入，区域被目录分成至多两段
+        uint32_t start = region * AT24C256_HASHDIR_REGION_SIZE;
+        uint32_t end = start + AT24C256_HASHDIR_REGION_SIZE;
+        uint32_t cut_lo = d->address > start ? d->address : start;
+        uint32_t cut_hi = table_end < end ? table_end : end;
+        if (cut_lo >= cut_hi) {
+            cut_lo = cut_hi = end;
+        }
+        if (cut_lo > start) {
+            ret = at24c256_write(handle, (uint16_t)start, image + start, (uint16_t)(cut_lo - start));
+        }
+        if (ret == AT24C256_OK && end > cut_hi) {
+            ret = at24c256_write(handle, (uint16_t)cut_hi, image + cut_hi, (uint16_t)(end - cut_hi));
+        }
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+
+    if (written) {
+        *written = mask;
+    }
+    return at24c256_flush(handle);
+}
+
+at24c256_err_t at24c256_hashdir_before_write(at24c256_handle_t handle, uint16_t address,
+                                            uint16_t length) {
+    struct at24c256_hashdir_s* d = handle->hashdir;
+    if (address >= d->address && (uint32_t)address + length <= (uint32_t)d->address + d->length) {
+        return AT24C256_OK;   // 写入目录本身
+    }
+
+    uint32_t first = address / AT24C256_HASHDIR_REGION_SIZE;
+    uint32_t last = ((uint32_t)address + length - 1) / AT24C256_HASHDIR_REGION_SIZE;
+    uint64_t range = 0;
+    for (uint32_t region = first; region <= last; region++) {
+        range |= 1ULL << region;
+    }
+    if ((d->stale & range) == range) {
+        return AT24C256_OK;   // 本会话中已经清零
+    }
+
+    // 编程数据前先在片上清零这些区域的哈希
+    for (uint32_t region = first; region <= last; region++) {
+        d->hash[region] = 0;
+    }
+    at24c256_err_t ret = store_hashes(handle, first, last - first + 1);
+    if (ret == AT24C256_OK) {
+        d->stale |= range;
+    }
+    return ret;
+}
+
+at24c256_err_t at24c256_hashdir_update(at24c256_handle_t handle) {
+    struct at24c256_hashdir_s* d = handle->hashdir;
+    if (!d->stale) {
+        return AT24C256_OK;
+    }
+
+    uint32_t first = MAX_REGIONS;
+    uint32_t last = 0;
+    for (uint32_t region = 0; region < d->region_count; region++) {
+        if (!(d->stale & (1ULL << region))) {
+            continue;
+        }
+        at24c256_err_t ret = read_region_hash(handle, region, &d->hash[region]);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+        if (region < first) {
+            first = region;
+        }
+        last = region;
+    }
+
+    // 连续写入一段目录项，中间未变化的项按原值写回
+    at24c256_err_t ret = store_hashes(handle, first, last - first + 1);
+    if (ret == AT24C256_OK) {
+        d->stale = 0;
+    }
+    return ret;
+}
+
+bool at24c256_hashdir_table(at24c256_handle_t handle, uint16_t* address, uint16_t* length) {
+    if (!handle->hashdir) {
+        return false;
+    }
+    *address = handle->hashdir->address;
+    *length = handle->hashdir->length;
+    return true;
+}
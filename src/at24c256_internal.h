@@ -0,0 +1,262 @@
+/**
+ * @file at24c256_internal.h
+ * @brief AT24C256 驱动内部定义 (不对外安装)
+ */
+
+#ifndef AT24C256_INTERNAL_H
+#define AT24C256_INTERNAL_H
+
+#include "at24c256.h"
+#include <stddef.h>
+
+struct at24c256_map_s;
+struct at24c256_cache_s;
+struct at24c256_warm_s;
+struct at24c256_hashdir_s;
+struct at24c256_async_s;
+struct at24c256_sim_s;
+struct at24c256_trace_s;
+struct at24c256_readahead_s;
+struct at24c256_group_s;
+struct at24c256_layout_s;
+
+/**
+ * @brief 设备访问后端
+ *
+ * 后端只负责单次传输，跨页拆分、缓存等由上层统一处理。
+ */
+typedef struct {
+    const char* name;           /**< 后端名称 */
+    /** 从address开始顺序读取length字节 */
+    at24c256_err_t (*read)(at24c256_handle_t handle, uint16_t address,
+                           uint8_t* data, uint16_t length);
+    /** 编程一页内的数据 (不跨页) */
+    at24c256_err_t (*program_page)(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length);
+    /** 检查一次是否就绪，写周期内返回AT24C256_ERROR_BUSY */
+    at24c256_err_t (*poll_ready)(at24c256_handle_t handle);
+    bool write_cycle;           /**< 编程后是否需要由驱动等待写周期 */
+    /** 当前时间 (纳秒)，NULL时使用CLOCK_MONOTONIC */
+    uint64_t (*now_ns)(at24c256_handle_t handle);
+} at24c256_backend_t;
+
+/**
+ * @brief AT24C256设备结构体
+ */
+struct at24c256_dev_s {
+    int fd;                     /**< I2C总线或nvmem文件描述符 */
+    const at24c256_backend_t* backend; /**< 访问后端 */
+    at24c256_config_t config;   /**< 设备配置 */
+    bool initialized;           /**< 初始化标志 */
+    struct at24c256_map_s* map; /**< 内存映射状态，未映射时为NULL */
+    struct at24c256_cache_s* cache; /**< 页缓存，未启用时为NULL */
+    struct at24c256_warm_s* warm;   /**< 持久化热缓存，未启用时为NULL */
+    struct at24c256_hashdir_s* hashdir; /**< 片上哈希目录，未启用时为NULL */
+    struct at24c256_async_s* async; /**< 异步引擎，首次使用时创建 */
+    struct at24c256_sim_s* sim;     /**< 模拟器状态，其他后端为NULL */
+    struct at24c256_trace_s* trace; /**< 访问记录，未开始时为NULL */
+    struct at24c256_readahead_s* readahead; /**< 预读缓冲区，未启用时为NULL */
+    struct at24c256_group_s* group; /**< 组提交状态，未启用时为NULL */
+    struct at24c256_layout_s* layout; /**< 字段访问统计，未登记时为NULL */
+};
+
+/**
+ * @brief 打开内核nvmem后端 (at24c256_nvmem.c)
+ */
+at24c256_err_t at24c256_nvmem_open(at24c256_handle_t handle);
+
+/**
+ * @brief 打开内存模拟器后端 (at24c256_sim.c)
+ */
+at24c256_err_t at24c256_sim_open(at24c256_handle_t handle);
+
+/**
+ * @brief 释放模拟器状态 (at24c256_sim.c)
+ */
+void at24c256_sim_free(at24c256_handle_t handle);
+
+/**
+ * @brief 后端的当前时间 (纳秒)
+ */
+uint64_t at24c256_now_ns(at24c256_handle_t handle);
+
+/**
+ * @brief 追加一条访问记录 (at24c256_trace.c)
+ */
+void at24c256_trace_record(at24c256_handle_t handle, at24c256_trace_op_t op, uint16_t address,
+                           uint16_t length, uint64_t start_ns, at24c256_err_t result);
+
+/**
+ * @brief 直接从芯片读取 (不经过缓存，不做参数检查)
+ */
+at24c256_err_t at24c256_raw_read(at24c256_handle_t handle, uint16_t address,
+                                uint8_t* data, uint16_t length);
+
+/**
+ * @brief 直接按页编程 (不经过缓存，不做参数检查)
+ */
+at24c256_err_t at24c256_raw_write(at24c256_handle_t handle, uint16_t address,
+                                 const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 编程一页但不等待写周期 (异步引擎自行等待)
+ *
+ * 与同步写入一样计入访问记录与布局统计，并更新预读缓冲区。不经过组提交，
+ * 调用者保证未启用组提交。
+ */
+at24c256_err_t at24c256_program_nowait(at24c256_handle_t handle, uint16_t address,
+                                      const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 经页缓存读取 (at24c256_cache.c)
+ */
+at24c256_err_t at24c256_cache_read(at24c256_handle_t handle, uint16_t address,
+                                  uint8_t* data, uint16_t length);
+
+/**
+ * @brief 经页缓存写入 (at24c256_cache.c)
+ */
+at24c256_err_t at24c256_cache_write(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 经预读缓冲区读取 (at24c256_readahead.c)
+ */
+at24c256_err_t at24c256_readahead_read(at24c256_handle_t handle, uint16_t address,
+                                      uint8_t* data, uint16_t length);
+
+/**
+ * @brief 编程完成后更新预读缓冲区中重叠的部分 (at24c256_readahead.c)
+ */
+void at24c256_readahead_store(at24c256_handle_t handle, uint16_t address,
+                              const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 读取 (不检查参数，不记录布局统计)
+ *
+ * 组提交线程读取合并范围中的空隙时使用，计入访问记录；at24c256_read在此之上记录布局统计。
+ */
+at24c256_err_t at24c256_commit_read(at24c256_handle_t handle, uint16_t address,
+                                   uint8_t* data, uint16_t length);
+
+/**
+ * @brief 编程一页 (不检查参数，不记录布局统计，不经过组提交)
+ *
+ * 组提交线程编程合并后的页时使用，计入访问记录。
+ */
+at24c256_err_t at24c256_commit_page(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 暂存写入并等待所在的一批编程完成 (at24c256_group.c)
+ */
+at24c256_err_t at24c256_group_write(at24c256_handle_t handle, uint16_t address,
+                                   const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 按地址把一次读写计入重叠的字段 (at24c256_layout.c)
+ */
+void at24c256_layout_record(at24c256_handle_t handle, bool write, uint16_t address,
+                            uint16_t length);
+
+/**
+ * @brief 不写回直接释放页缓存 (与热缓存) (at24c256_cache.c)
+ */
+void at24c256_cache_free(at24c256_handle_t handle);
+
+/**
+ * @brief 用完整镜像填充缓存，所有页标记为已加载且干净 (at24c256_cache.c)
+ */
+void at24c256_cache_fill(at24c256_handle_t handle, const uint8_t* image);
+
+/**
+ * @brief 更新缓存内容但不标记为脏 (数据已直接写入芯片)
+ */
+void at24c256_cache_store(at24c256_handle_t handle, uint16_t address,
+                          const uint8_t* data, uint16_t length);
+
+/**
+ * @brief 缓存镜像 (只在所有页都已加载时完整有效)
+ */
+const uint8_t* at24c256_cache_image(at24c256_handle_t handle);
+
+/**
+ * @brief 是否启用了回写缓存 (at24c256_cache.c)
+ */
+bool at24c256_cache_write_back(at24c256_handle_t handle);
+
+/**
+ * @brief 首次写入前将片上代数戳标记为修改中 (at24c256_warm.c)
+ */
+at24c256_err_t at24c256_warm_begin_write(at24c256_handle_t handle);
+
+/**
+ * @brief 写回完成后提交代数戳并保存主机侧镜像 (at24c256_warm.c)
+ */
+at24c256_err_t at24c256_warm_commit(at24c256_handle_t handle);
+
+/**
+ * @brief 释放热缓存状态 (at24c256_warm.c)
+ */
+void at24c256_warm_free(at24c256_handle_t handle);
+
+/**
+ * @brief 释放异步引擎，未完成的请求直接丢弃 (at24c256_async.c)
+ */
+void at24c256_async_free(at24c256_handle_t handle);
+
+/**
+ * @brief 写入前使所涉及区域的片上哈希失效 (at24c256_hashdir.c)
+ */
+at24c256_err_t at24c256_hashdir_before_write(at24c256_handle_t handle, uint16_t address,
+                                            uint16_t length);
+
+/**
+ * @brief 重新计算失效区域的哈希并写入片上目录，在flush与diff中调用 (at24c256_hashdir.c)
+ */
+at24c256_err_t at24c256_hashdir_update(at24c256_handle_t handle);
+
+/**
+ * @brief 片上哈希目录占用的地址范围，未启用时返回false (at24c256_hashdir.c)
+ */
+bool at24c256_hashdir_table(at24c256_handle_t handle, uint16_t* address, uint16_t* length);
+
+/**
+ * @brief 地址范围 [address, address + length)
+ */
+typedef struct {
+    uint32_t address;
+    uint32_t length;
+} at24c256_span_t;
+
+/**
+ * @brief 64位FNV-1a哈希，seed为上一段的结果以便分段计算 (at24c256_hash.c)
+ */
+uint64_t at24c256_hash64(const uint8_t* data, size_t length, uint64_t seed);
+
+/**
+ * @brief 对地址范围 [base, base + length) 求哈希，跳过holes中的地址 (at24c256_hash.c)
+ *
+ * data对应地址base处的内容，holes使用芯片绝对地址。
+ */
+uint64_t at24c256_hash64_except(const uint8_t* data, uint32_t base, uint32_t length,
+                                const at24c256_span_t* holes, int hole_count, uint64_t seed);
+
+#define AT24C256_HASH64_SEED 0xCBF29CE484222325ULL
+
+/**
+ * @brief 按小端写入v的低bytes个字节 (at24c256_hash.c)
+ */
+void at24c256_put_le(uint8_t* p, uint64_t v, int bytes);
+
+/**
+ * @brief 按小端读取bytes个字节 (at24c256_hash.c)
+ */
+uint64_t at24c256_get_le(const uint8_t* p, int bytes);
+
+/**
+ * @brief CRC-8 (多项式0x07)，crc为上一段的结果以便分段计算 (at24c256_hash.c)
+ */
+uint8_t at24c256_crc8(uint8_t crc, const uint8_t* data, size_t length);
+
+#endif /* AT24C256_INTERNAL_H */
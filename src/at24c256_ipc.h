@@ -0,0 +1,73 @@
+/**
+ * @file at24c256_ipc.h
+ * @brief at24c256d 守护进程与客户端库之间的通信协议 (内部头文件)
+ *
+ * 控制消息走Unix域套接字，读取结果通过共享内存中的芯片镜像返回。
+ */
+
+#ifndef AT24C256_IPC_H
+#define AT24C256_IPC_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define AT24C256_IPC_MAGIC      0x32344344u  /* "DC42" */
+#define AT24C256_IPC_SHM_MAGIC  0x32344D53u  /* "SM42" */
+#define AT24C256_IPC_NAME_MAX   64
+
+/**
+ * @brief 请求操作码
+ */
+enum {
+    AT24C256_IPC_OP_READ  = 1,  /**< 读取，数据经共享内存返回 */
+    AT24C256_IPC_OP_WRITE = 2,  /**< 写入，请求头后紧跟length字节数据 */
+    AT24C256_IPC_OP_ERASE = 3,  /**< 擦除 */
+};
+
+/**
+ * @brief 客户端请求头
+ */
+typedef struct {
+    uint32_t magic;     /**< AT24C256_IPC_MAGIC */
+    uint32_t seq;       /**< 请求序号，原样返回 */
+    uint8_t op;         /**< 操作码 */
+    uint8_t reserved;
+    uint16_t address;   /**< 起始地址 */
+    uint16_t length;    /**< 数据长度 */
+    uint16_t reserved2;
+} at24c256_ipc_req_t;
+
+/**
+ * @brief 守护进程响应
+ */
+typedef struct {
+    uint32_t seq;       /**< 对应请求序号 */
+    int32_t status;     /**< at24c256_err_t */
+} at24c256_ipc_resp_t;
+
+/**
+ * @brief 连接建立后守护进程发送的欢迎消息
+ */
+typedef struct {
+    uint32_t magic;                          /**< AT24C256_IPC_MAGIC */
+    uint32_t total_size;                     /**< 芯片容量 */
+    uint16_t page_size;                      /**< 页大小 */
+    uint16_t reserved;
+    char shm_name[AT24C256_IPC_NAME_MAX];    /**< 共享内存对象名 */
+} at24c256_ipc_hello_t;
+
+/**
+ * @brief 共享内存布局
+ *
+ * seq为顺序锁计数器：守护进程更新镜像前后各加一次，奇数表示正在更新。
+ * 客户端拷贝前后比较seq，不一致则重试。
+ */
+typedef struct {
+    uint32_t magic;          /**< AT24C256_IPC_SHM_MAGIC */
+    uint32_t total_size;     /**< 镜像长度 */
+    _Atomic uint32_t seq;    /**< 顺序锁计数器 */
+    uint32_t reserved;
+    uint8_t image[];         /**< 芯片内容镜像 */
+} at24c256_ipc_shm_t;
+
+#endif /* AT24C256_IPC_H */
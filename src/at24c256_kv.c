@@ -0,0 +1,451 @@
+/**
+ * @file at24c256_kv.c
+ * @brief EEPROM键值存储实现
+ *
+ * 每个记录槽以5字节记录头开始 (小端)，其后依次是键与值：
+ *   0   key_len    键长度，0x00或0xFF表示空闲槽
+ *   1   value_len  值长度
+ *   2   seq        该键的更新序号 (u16，按回绕比较)
+ *   4   crc        记录头前4字节、键与值的CRC-8
+ * 槽大小整除页大小，一条记录总在同一页内，写入只需一次页编程。
+ * 内存索引是线性探测的开放寻址哈希表，项中保存键的64位哈希与槽号，
+ * 删除时后移探测链而不留墓碑。Bloom过滤器用同一个哈希的高低两半做双重散列；
+ * 删除的键仍留在过滤器中，过时的键多于有效键时按索引重建。
+ */
+
+#include "at24c256_kv.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RECORD_HEADER 5
+#define MIN_SLOT_SIZE 16
+#define BLOOM_BITS_PER_SLOT 8
+#define BLOOM_HASHES 4
+#define FREE_MARK 0xFF
+#define NO_SLOT 0xFFFFFFFFu
+#define MAX_READ 0x8000
+
+/**
+ * @brief 索引项
+ */
+typedef struct {
+    uint64_t hash;               /**< 键的64位哈希 */
+    uint16_t slot;               /**< 记录所在的槽 */
+    bool used;
+} entry_t;
+
+/**
+ * @brief 键值存储
+ */
+struct at24c256_kv_s {
+    at24c256_handle_t dev;
+    uint16_t address;            /**< 区域起始地址 */
+    uint16_t slot_size;
+    uint32_t slot_count;
+    uint8_t* used;               /**< 每槽一个字节，非0表示槽中是有效记录 */
+    uint32_t cursor;             /**< 下一次从此槽开始查找空闲槽 */
+    entry_t* entries;
+    uint32_t entry_mask;         /**< 索引容量-1 (容量为2的幂，不小于槽数的两倍) */
+    uint32_t keys;
+    uint64_t* bloom;
+    uint32_t bloom_mask;         /**< 过滤器位数-1 */
+    uint32_t stale;              /**< 过滤器中已删除的键数 */
+    uint8_t* record;             /**< 一个槽的缓冲区 */
+};
+
+static uint8_t record_crc(const uint8_t* rec) {
+    uint8_t crc = at24c256_crc8(0, rec, 4);
+    return at24c256_crc8(crc, rec + RECORD_HEADER, (size_t)rec[0] + rec[1]);
+}
+
+/**
+ * @brief 检查槽中是否是完整的记录
+ */
+static bool record_valid(const at24c256_kv_t kv, const uint8_t* rec) {
+    if (rec[0] == 0x00 || rec[0] == FREE_MARK ||
+        RECORD_HEADER + rec[0] + rec[1] > kv->slot_size) {
+        return false;
+    }
+    return rec[4] == record_crc(rec);
+}
+
+static bool record_has_key(const uint8_t* rec, const char* key, size_t key_len) {
+    return rec[0] == key_len && memcmp(rec + RECORD_HEADER, key, key_len) == 0;
+}
+
+/**
+ * @brief 序号a是否比b新 (按u16回绕比较)
+ */
+static bool seq_newer(uint16_t a, uint16_t b) {
+    return (int16_t)(uint16_t)(a - b) > 0;
+}
+
+static uint64_t key_hash(const char* key, size_t key_len) {
+    return at24c256_hash64((const uint8_t*)key, key_len, AT24C256_HASH64_SEED);
+}
+
+static uint16_t slot_address(const at24c256_kv_t kv, uint32_t slot) {
+    return (uint16_t)(kv->address + slot * kv->slot_size);
+}
+
+static void bloom_add(at24c256_kv_t kv, uint64_t hash) {
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    for (uint32_t i = 0; i < BLOOM_HASHES; i++) {
+        uint32_t bit = (h1 + i * h2) & kv->bloom_mask;
+        kv->bloom[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+static bool bloom_test(const at24c256_kv_t kv, uint64_t hash) {
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    for (uint32_t i = 0; i < BLOOM_HASHES; i++) {
+        uint32_t bit = (h1 + i * h2) & kv->bloom_mask;
+        if (!(kv->bloom[bit >> 6] & (1ULL << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 按索引重建过滤器，清除已删除键留下的位
+ */
+static void bloom_rebuild(at24c256_kv_t kv) {
+    memset(kv->bloom, 0, ((size_t)kv->bloom_mask + 1) / 8);
+    for (uint32_t i = 0; i <= kv->entry_mask; i++) {
+        if (kv->entries[i].used) {
+            bloom_add(kv, kv->entries[i].hash);
+        }
+    }
+    kv->stale = 0;
+}
+
+static void index_insert(at24c256_kv_t kv, uint64_t hash, uint32_t slot) {
+    uint32_t i = (uint32_t)hash & kv->entry_mask;
+    while (kv->entries[i].used) {
+        i = (i + 1) & kv->entry_mask;
+    }
+    kv->entries[i].hash = hash;
+    kv->entries[i].slot = (uint16_t)slot;
+    kv->entries[i].used = true;
+    kv->keys++;
+    bloom_add(kv, hash);
+}
+
+/**
+ * @brief 删除索引项，把探测链上后面的项前移填补空位
+ */
+static void index_remove(at24c256_kv_t kv, uint32_t pos) {
+    uint32_t hole = pos;
+    for (uint32_t i = (pos + 1) & kv->entry_mask; kv->entries[i].used;
+         i = (i + 1) & kv->entry_mask) {
+        uint32_t home = (uint32_t)kv->entries[i].hash & kv->entry_mask;
+        if (((i - home) & kv->entry_mask) >= ((i - hole) & kv->entry_mask)) {
+            kv->entries[hole] = kv->entries[i];
+            hole = i;
+        }
+    }
+    kv->entries[hole].used = false;
+    kv->keys--;
+}
+
+/**
+ * @brief 查找键，找到时返回索引项位置，记录读入kv->record
+ *
+ * 过滤器与索引都在内存中，不存在的键不访问芯片；
+ * 只有64位哈希相同的项才读取对应的槽确认键。
+ */
+static at24c256_err_t find_key(at24c256_kv_t kv, const char* key, size_t key_len,
+                               uint64_t hash, uint32_t* pos) {
+    if (!bloom_test(kv, hash)) {
+        return AT24C256_ERROR_NOT_FOUND;
+    }
+
+    for (uint32_t i = (uint32_t)hash & kv->entry_mask; kv->entries[i].used;
+         i = (i + 1) & kv->entry_mask) {
+        if (kv->entries[i].hash != hash) {
+            continue;
+        }
+        at24c256_err_t ret = at24c256_read(kv->dev, slot_address(kv, kv->entries[i].slot),
+                                           kv->record, kv->slot_size);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+        if (record_has_key(kv->record, key, key_len)) {
+            if (!record_valid(kv, kv->record)) {
+                return AT24C256_ERROR_READ;
+            }
+            *pos = i;
+            return AT24C256_OK;
+        }
+    }
+    return AT24C256_ERROR_NOT_FOUND;
+}
+
+/**
+ * @brief 把槽标记为空闲 (编程记录的首字节)
+ */
+static at24c256_err_t release_slot(at24c256_kv_t kv, uint32_t slot) {
+    uint8_t mark = FREE_MARK;
+    kv->used[slot] = 0;
+    return at24c256_write(kv->dev, slot_address(kv, slot), &mark, 1);
+}
+
+/**
+ * @brief 从游标开始找一个空闲槽，依次轮换使用以分散磨损
+ */
+static uint32_t alloc_slot(at24c256_kv_t kv) {
+    for (uint32_t n = 0; n < kv->slot_count; n++) {
+        uint32_t slot = (kv->cursor + n) % kv->slot_count;
+        if (!kv->used[slot]) {
+            kv->cursor = (slot + 1) % kv->slot_count;
+            return slot;
+        }
+    }
+    return NO_SLOT;
+}
+
+/**
+ * @brief 一次读取整个区域，建立索引与过滤器
+ */
+static at24c256_err_t scan(at24c256_kv_t kv, uint8_t* image) {
+    uint32_t length = kv->slot_count * kv->slot_size;
+    for (uint32_t offset = 0; offset < length; offset += MAX_READ) {
+        uint32_t chunk = length - offset < MAX_READ ? length - offset : MAX_READ;
+        at24c256_err_t ret = at24c256_read(kv->dev, (uint16_t)(kv->address + offset),
+                                           image + offset, (uint16_t)chunk);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+
+    uint32_t last = NO_SLOT;
+    for (uint32_t slot = 0; slot < kv->slot_count; slot++) {
+        const uint8_t* rec = image + slot * kv->slot_size;
+        if (!record_valid(kv, rec)) {
+            continue;
+        }
+
+        uint64_t hash = key_hash((const char*)rec + RECORD_HEADER, rec[0]);
+        uint32_t i = (uint32_t)hash & kv->entry_mask;
+        for (; kv->entries[i].used; i = (i + 1) & kv->entry_mask) {
+            const uint8_t* other = image + kv->entries[i].slot * kv->slot_size;
+            if (kv->entries[i].hash == hash && other[0] == rec[0] &&
+                memcmp(other + RECORD_HEADER, rec + RECORD_HEADER, rec[0]) == 0) {
+                break;
+            }
+        }
+
+        if (!kv->entries[i].used) {
+            index_insert(kv, hash, slot);
+            kv->used[slot] = 1;
+            last = slot;
+            continue;
+        }
+
+        // 更新中途掉电留下的两条记录：保留较新的，释放较旧的
+        uint32_t older = slot;
+        const uint8_t* other = image + kv->entries[i].slot * kv->slot_size;
+        if (seq_newer((uint16_t)at24c256_get_le(rec + 2, 2),
+                      (uint16_t)at24c256_get_le(other + 2, 2))) {
+            older = kv->entries[i].slot;
+            kv->entries[i].slot = (uint16_t)slot;
+            kv->used[slot] = 1;
+            last = slot;
+        }
+        at24c256_err_t ret = release_slot(kv, older);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+
+    kv->cursor = last == NO_SLOT ? 0 : (last + 1) % kv->slot_count;
+    return AT24C256_OK;
+}
+
+static void kv_free(at24c256_kv_t kv) {
+    free(kv->used);
+    free(kv->entries);
+    free(kv->bloom);
+    free(kv->record);
+    free(kv);
+}
+
+at24c256_err_t at24c256_kv_mount(at24c256_handle_t handle, uint16_t address, uint32_t length,
+                                uint16_t slot_size, at24c256_kv_t* kv) {
+    if (!handle || !kv) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_config_t config;
+    at24c256_err_t ret = at24c256_get_info(handle, &config);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    if (slot_size < MIN_SLOT_SIZE || slot_size > config.page_size ||
+        (slot_size & (slot_size - 1)) != 0 || address % slot_size != 0 ||
+        length % slot_size != 0 || length == 0 || (uint32_t)address + length > config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_kv_t k = (at24c256_kv_t)calloc(1, sizeof(*k));
+    if (!k) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    k->dev = handle;
+    k->address = address;
+    k->slot_size = slot_size;
+    k->slot_count = length / slot_size;
+
+    uint32_t capacity = 2;
+    while (capacity < 2 * k->slot_count) {
+        capacity *= 2;
+    }
+    uint32_t bits = 64;
+    while (bits < BLOOM_BITS_PER_SLOT * k->slot_count) {
+        bits *= 2;
+    }
+    k->entry_mask = capacity - 1;
+    k->bloom_mask = bits - 1;
+    k->used = (uint8_t*)calloc(k->slot_count, 1);
+    k->entries = (entry_t*)calloc(capacity, sizeof(entry_t));
+    k->bloom = (uint64_t*)calloc(bits / 64, sizeof(uint64_t));
+    k->record = (uint8_t*)malloc(slot_size);
+
+    uint8_t* image = (uint8_t*)malloc(length);
+    if (!k->used || !k->entries || !k->bloom || !k->record || !image) {
+        ret = AT24C256_ERROR_MEMORY;
+    } else {
+        ret = scan(k, image);
+    }
+    free(image);
+    if (ret != AT24C256_OK) {
+        kv_free(k);
+        return ret;
+    }
+
+    *kv = k;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_kv_get(at24c256_kv_t kv, const char* key, void* value, uint16_t size,
+                              uint16_t* length) {
+    if (!kv || !key || (!value && size > 0)) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    size_t key_len = strlen(key);
+    uint32_t pos;
+    at24c256_err_t ret = find_key(kv, key, key_len, key_hash(key, key_len), &pos);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    uint8_t value_len = kv->record[1];
+    if (value_len > size) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (value_len > 0) {
+        memcpy(value, kv->record + RECORD_HEADER + key_len, value_len);
+    }
+    if (length) {
+        *length = value_len;
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_kv_put(at24c256_kv_t kv, const char* key, const void* value,
+                              uint16_t length) {
+    if (!kv || !key || (!value && length > 0)) {
+        return AT24C256_ERROR_PARAM;
+    }
+    size_t key_len = strlen(key);
+    if (key_len == 0 || key_len >= FREE_MARK || RECORD_HEADER + key_len + length > kv->slot_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    uint64_t hash = key_hash(key, key_len);
+    uint32_t pos = 0;
+    at24c256_err_t ret = find_key(kv, key, key_len, hash, &pos);
+    if (ret != AT24C256_OK && ret != AT24C256_ERROR_NOT_FOUND) {
+        return ret;
+    }
+    bool exists = ret == AT24C256_OK;
+
+    uint16_t seq = 0;
+    if (exists) {
+        if (kv->record[1] == length &&
+            memcmp(kv->record + RECORD_HEADER + key_len, value, length) == 0) {
+            return AT24C256_OK;
+        }
+        seq = (uint16_t)(at24c256_get_le(kv->record + 2, 2) + 1);
+    }
+
+    uint32_t slot = alloc_slot(kv);
+    if (slot == NO_SLOT) {
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    // 先写入新记录，再释放旧记录：两步之间掉电时挂载按序号取新值
+    uint8_t* rec = kv->record;
+    rec[0] = (uint8_t)key_len;
+    rec[1] = (uint8_t)length;
+    at24c256_put_le(rec + 2, seq, 2);
+    memcpy(rec + RECORD_HEADER, key, key_len);
+    if (length > 0) {
+        memcpy(rec + RECORD_HEADER + key_len, value, length);
+    }
+    rec[4] = record_crc(rec);
+    ret = at24c256_write(kv->dev, slot_address(kv, slot), rec,
+                         (uint16_t)(RECORD_HEADER + key_len + length));
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    kv->used[slot] = 1;
+
+    if (!exists) {
+        index_insert(kv, hash, slot);
+        return AT24C256_OK;
+    }
+    uint32_t old = kv->entries[pos].slot;
+    kv->entries[pos].slot = (uint16_t)slot;
+    return release_slot(kv, old);
+}
+
+at24c256_err_t at24c256_kv_delete(at24c256_kv_t kv, const char* key) {
+    if (!kv || !key) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    size_t key_len = strlen(key);
+    uint32_t pos;
+    at24c256_err_t ret = find_key(kv, key, key_len, key_hash(key, key_len), &pos);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    ret = release_slot(kv, kv->entries[pos].slot);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    index_remove(kv, pos);
+    if (++kv->stale > kv->keys) {
+        bloom_rebuild(kv);
+    }
+    return AT24C256_OK;
+}
+
+int at24c256_kv_count(at24c256_kv_t kv) {
+    return kv ? (int)kv->keys : -1;
+}
+
+at24c256_err_t at24c256_kv_unmount(at24c256_kv_t kv) {
+    if (!kv) {
+        return AT24C256_ERROR_PARAM;
+    }
+    kv_free(kv);
+    return AT24C256_OK;
+}
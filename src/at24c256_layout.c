@@ -0,0 +1,515 @@
+/**
+ * @file at24c256_layout.c
+ * @brief 冷热数据布局建议实现
+ *
+ * 每次更新写入的字段集合记为一个64位掩码：累计每个字段的更新次数、每对字段的
+ * 共同更新次数，并把不同的掩码及其出现次数记入组合表，用于精确估算每种布局下
+ * 记录到的更新需要编程的页数。
+ *
+ * 建议布局分三步：
+ *   1. 按更新次数从高到低取未分组的热字段作为种子，反复加入与组内字段共同更新
+ *      次数之和最大、且放得下的热字段，每组不超过一页
+ *   2. 组按大小降序首次适应装入页中，超过一页的字段独占连续的页
+ *   3. 冷字段按原地址顺序紧接在热数据页之后
+ *
+ * 启用组提交时写入者在各自线程中记录，统计由一把锁保护。
+ */
+
+#include "at24c256_layout.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * @brief 一种更新组合
+ */
+typedef struct {
+    uint64_t mask;               /**< 更新写入的字段 */
+    uint32_t count;              /**< 出现次数 */
+} pattern_t;
+
+/**
+ * @brief 统计状态
+ */
+struct at24c256_layout_s {
+    pthread_mutex_t lock;        /**< 保护下列全部状态 */
+    int count;
+    at24c256_field_t fields[AT24C256_LAYOUT_MAX_FIELDS];
+    at24c256_field_stats_t stats[AT24C256_LAYOUT_MAX_FIELDS];
+    uint32_t co[AT24C256_LAYOUT_MAX_FIELDS][AT24C256_LAYOUT_MAX_FIELDS]; /**< 共同更新次数 */
+    pattern_t patterns[AT24C256_LAYOUT_MAX_PATTERNS];
+    int pattern_count;
+    uint32_t updates;
+    uint32_t estimated;
+    bool in_update;              /**< 在update_begin/end之间 */
+    bool paused;                 /**< 迁移期间不统计 */
+    uint64_t pending;            /**< 当前更新已写入的字段 */
+    uint8_t* seen;               /**< 每页一个标志，计算页数时使用 */
+};
+
+/**
+ * @brief 与地址范围重叠的字段
+ */
+static uint64_t overlap_mask(const struct at24c256_layout_s* l, uint32_t address, uint32_t length) {
+    uint64_t mask = 0;
+    for (int i = 0; i < l->count; i++) {
+        uint32_t start = l->fields[i].address;
+        if (start < address + length && address < start + l->fields[i].length) {
+            mask |= 1ULL << i;
+        }
+    }
+    return mask;
+}
+
+static void commit_update(struct at24c256_layout_s* l, uint64_t mask) {
+    if (mask == 0) {
+        return;
+    }
+    l->updates++;
+    for (int i = 0; i < l->count; i++) {
+        if (!(mask >> i & 1)) {
+            continue;
+        }
+        l->stats[i].writes++;
+        for (int j = i + 1; j < l->count; j++) {
+            if (mask >> j & 1) {
+                l->co[i][j]++;
+                l->co[j][i]++;
+            }
+        }
+    }
+
+    for (int i = 0; i < l->pattern_count; i++) {
+        if (l->patterns[i].mask == mask) {
+            l->patterns[i].count++;
+            l->estimated++;
+            return;
+        }
+    }
+    if (l->pattern_count < AT24C256_LAYOUT_MAX_PATTERNS) {
+        l->patterns[l->pattern_count].mask = mask;
+        l->patterns[l->pattern_count].count = 1;
+        l->pattern_count++;
+        l->estimated++;
+    }
+}
+
+void at24c256_layout_record(at24c256_handle_t handle, bool write, uint16_t address,
+                            uint16_t length) {
+    struct at24c256_layout_s* l = handle->layout;
+    pthread_mutex_lock(&l->lock);
+    if (l->paused) {
+        pthread_mutex_unlock(&l->lock);
+        return;
+    }
+
+    uint64_t mask = overlap_mask(l, address, length);
+    if (!write) {
+        for (int i = 0; i < l->count; i++) {
+            if (mask >> i & 1) {
+                l->stats[i].reads++;
+            }
+        }
+    } else if (l->in_update) {
+        l->pending |= mask;
+    } else {
+        commit_update(l, mask);
+    }
+    pthread_mutex_unlock(&l->lock);
+}
+
+/**
+ * @brief 一次更新在给定布局下编程的页数
+ */
+static uint32_t pages_touched(struct at24c256_layout_s* l, uint16_t page_size,
+                              const at24c256_field_t* fields, uint64_t mask) {
+    uint32_t pages = 0;
+    for (int i = 0; i < l->count; i++) {
+        if (!(mask >> i & 1)) {
+            continue;
+        }
+        uint32_t last = ((uint32_t)fields[i].address + fields[i].length - 1) / page_size;
+        for (uint32_t p = fields[i].address / page_size; p <= last; p++) {
+            if (!l->seen[p]) {
+                l->seen[p] = 1;
+                pages++;
+            }
+        }
+    }
+    for (int i = 0; i < l->count; i++) {
+        if (mask >> i & 1) {
+            uint32_t last = ((uint32_t)fields[i].address + fields[i].length - 1) / page_size;
+            memset(l->seen + fields[i].address / page_size, 0,
+                   last - fields[i].address / page_size + 1);
+        }
+    }
+    return pages;
+}
+
+static uint64_t total_pages(struct at24c256_layout_s* l, uint16_t page_size,
+                            const at24c256_field_t* fields) {
+    uint64_t total = 0;
+    for (int i = 0; i < l->pattern_count; i++) {
+        total += (uint64_t)l->patterns[i].count *
+                 pages_touched(l, page_size, fields, l->patterns[i].mask);
+    }
+    return total;
+}
+
+/**
+ * @brief 检查字段都在芯片内且互不重叠
+ */
+static bool valid_fields(at24c256_handle_t handle, const at24c256_field_t* fields, int count) {
+    for (int i = 0; i < count; i++) {
+        if (fields[i].length == 0 ||
+            (uint32_t)fields[i].address + fields[i].length > handle->config.total_size) {
+            return false;
+        }
+        for (int j = 0; j < i; j++) {
+            if (fields[i].address < fields[j].address + fields[j].length &&
+                fields[j].address < fields[i].address + fields[i].length) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+at24c256_err_t at24c256_layout_track(at24c256_handle_t handle, const at24c256_field_t* fields,
+                                    int count) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!fields || count <= 0 || count > AT24C256_LAYOUT_MAX_FIELDS ||
+        !valid_fields(handle, fields, count)) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    struct at24c256_layout_s* l = (struct at24c256_layout_s*)calloc(1, sizeof(*l));
+    if (!l) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    l->seen = (uint8_t*)calloc(handle->config.total_size / handle->config.page_size + 1, 1);
+    if (!l->seen) {
+        free(l);
+        return AT24C256_ERROR_MEMORY;
+    }
+    pthread_mutex_init(&l->lock, NULL);
+    l->count = count;
+    memcpy(l->fields, fields, (size_t)count * sizeof(fields[0]));
+
+    if (handle->layout) {
+        at24c256_layout_untrack(handle);
+    }
+    handle->layout = l;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_layout_update_begin(at24c256_handle_t handle) {
+    if (!handle || !handle->layout) {
+        return AT24C256_ERROR_PARAM;
+    }
+    pthread_mutex_lock(&handle->layout->lock);
+    handle->layout->in_update = true;
+    handle->layout->pending = 0;
+    pthread_mutex_unlock(&handle->layout->lock);
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_layout_update_end(at24c256_handle_t handle) {
+    if (!handle || !handle->layout) {
+        return AT24C256_ERROR_PARAM;
+    }
+    struct at24c256_layout_s* l = handle->layout;
+    pthread_mutex_lock(&l->lock);
+    bool in_update = l->in_update;
+    if (in_update) {
+        l->in_update = false;
+        commit_update(l, l->pending);
+        l->pending = 0;
+    }
+    pthread_mutex_unlock(&l->lock);
+    return in_update ? AT24C256_OK : AT24C256_ERROR_PARAM;
+}
+
+at24c256_err_t at24c256_layout_field_stats(at24c256_handle_t handle, int index,
+                                          at24c256_field_stats_t* stats) {
+    if (!handle || !handle->layout || !stats || index < 0 || index >= handle->layout->count) {
+        return AT24C256_ERROR_PARAM;
+    }
+    pthread_mutex_lock(&handle->layout->lock);
+    *stats = handle->layout->stats[index];
+    pthread_mutex_unlock(&handle->layout->lock);
+    return AT24C256_OK;
+}
+
+/**
+ * @brief 计算建议布局 (持有锁)
+ */
+static at24c256_err_t advise(at24c256_handle_t handle, uint16_t region, uint32_t region_length,
+                             at24c256_field_t* layout, at24c256_layout_report_t* report) {
+    struct at24c256_layout_s* l = handle->layout;
+    uint16_t page_size = handle->config.page_size;
+    if (region % page_size != 0 || (uint32_t)region + region_length > handle->config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    int n = l->count;
+    int order[AT24C256_LAYOUT_MAX_FIELDS];
+    int group_of[AT24C256_LAYOUT_MAX_FIELDS];
+    int members[AT24C256_LAYOUT_MAX_FIELDS];    // 按组依次排列的字段
+    int group_start[AT24C256_LAYOUT_MAX_FIELDS + 1];
+    uint32_t group_size[AT24C256_LAYOUT_MAX_FIELDS];
+    int hot = 0;
+    int groups = 0;
+    int placed = 0;
+
+    // 热字段按更新次数降序 (插入排序，字段数很少)
+    for (int i = 0; i < n; i++) {
+        group_of[i] = -1;
+        if (l->stats[i].writes == 0) {
+            continue;
+        }
+        int k = hot++;
+        while (k > 0 && l->stats[order[k - 1]].writes < l->stats[i].writes) {
+            order[k] = order[k - 1];
+            k--;
+        }
+        order[k] = i;
+    }
+
+    // 1. 按共同更新聚组
+    for (int s = 0; s < hot; s++) {
+        int seed = order[s];
+        if (group_of[seed] >= 0) {
+            continue;
+        }
+        int g = groups++;
+        group_start[g] = placed;
+        group_of[seed] = g;
+        members[placed++] = seed;
+        group_size[g] = l->fields[seed].length;
+
+        for (;;) {
+            int best = -1;
+            uint32_t best_score = 0;
+            for (int c = 0; c < hot; c++) {
+                int j = order[c];
+                if (group_of[j] >= 0 || group_size[g] + l->fields[j].length > page_size) {
+                    continue;
+                }
+                uint32_t score = 0;
+                for (int m = group_start[g]; m < placed; m++) {
+                    score += l->co[members[m]][j];
+                }
+                if (score > best_score) {
+                    best = j;
+                    best_score = score;
+                }
+            }
+            if (best < 0) {
+                break;
+            }
+            group_of[best] = g;
+            members[placed++] = best;
+            group_size[g] += l->fields[best].length;
+        }
+    }
+    group_start[groups] = placed;
+
+    // 2. 组按大小降序首次适应装入页
+    int by_size[AT24C256_LAYOUT_MAX_FIELDS];
+    for (int g = 0; g < groups; g++) {
+        int k = g;
+        while (k > 0 && group_size[by_size[k - 1]] < group_size[g]) {
+            by_size[k] = by_size[k - 1];
+            k--;
+        }
+        by_size[k] = g;
+    }
+
+    uint32_t max_pages = region_length / page_size;
+    uint16_t* fill = (uint16_t*)calloc(max_pages ? max_pages : 1, sizeof(uint16_t));
+    if (!fill) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    uint32_t used_pages = 0;
+    at24c256_err_t ret = AT24C256_OK;
+    for (int k = 0; k < groups && ret == AT24C256_OK; k++) {
+        int g = by_size[k];
+        uint32_t page = used_pages;
+        if (group_size[g] <= page_size) {
+            for (page = 0; page < used_pages && fill[page] + group_size[g] > page_size; page++) {
+            }
+        }
+        uint32_t span = (group_size[g] + page_size - 1) / page_size;
+        if (page + (page == used_pages ? span : 1) > max_pages) {
+            ret = AT24C256_ERROR_MEMORY;
+            break;
+        }
+
+        uint32_t address = region + page * page_size + fill[page];
+        for (int m = group_start[g]; m < group_start[g + 1]; m++) {
+            int f = members[m];
+            layout[f].address = (uint16_t)address;
+            layout[f].length = l->fields[f].length;
+            address += l->fields[f].length;
+        }
+        if (page == used_pages) {
+            used_pages += span;
+            for (uint32_t p = page; p < used_pages; p++) {
+                fill[p] = page_size;
+            }
+            fill[used_pages - 1] = (uint16_t)(group_size[g] - (span - 1) * page_size);
+        } else {
+            fill[page] += group_size[g];
+        }
+    }
+    free(fill);
+
+    // 3. 冷字段按原地址顺序紧接其后
+    uint32_t cursor = region + used_pages * page_size;
+    for (uint32_t next = 0; ret == AT24C256_OK;) {
+        int f = -1;
+        for (int i = 0; i < n; i++) {
+            if (l->stats[i].writes == 0 && l->fields[i].address >= next &&
+                (f < 0 || l->fields[i].address < l->fields[f].address)) {
+                f = i;
+            }
+        }
+        if (f < 0) {
+            break;
+        }
+        if (cursor + l->fields[f].length > (uint32_t)region + region_length) {
+            ret = AT24C256_ERROR_MEMORY;
+            break;
+        }
+        layout[f].address = (uint16_t)cursor;
+        layout[f].length = l->fields[f].length;
+        cursor += l->fields[f].length;
+        next = (uint32_t)l->fields[f].address + 1;
+    }
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+
+    if (report) {
+        report->updates = l->updates;
+        report->estimated = l->estimated;
+        report->hot_fields = (uint32_t)hot;
+        report->pages_before = total_pages(l, page_size, l->fields);
+        report->pages_after = total_pages(l, page_size, layout);
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_layout_advise(at24c256_handle_t handle, uint16_t region,
+                                     uint32_t region_length, at24c256_field_t* layout,
+                                     at24c256_layout_report_t* report) {
+    if (!handle || !handle->layout || !layout) {
+        return AT24C256_ERROR_PARAM;
+    }
+    pthread_mutex_lock(&handle->layout->lock);
+    at24c256_err_t ret = advise(handle, region, region_length, layout, report);
+    pthread_mutex_unlock(&handle->layout->lock);
+    return ret;
+}
+
+at24c256_err_t at24c256_layout_migrate(at24c256_handle_t handle, const at24c256_field_t* layout) {
+    if (!handle || !handle->layout || !layout) {
+        return AT24C256_ERROR_PARAM;
+    }
+    struct at24c256_layout_s* l = handle->layout;
+    if (!valid_fields(handle, layout, l->count)) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    uint32_t lo = handle->config.total_size;
+    uint32_t hi = 0;
+    uint32_t total = 0;
+    for (int i = 0; i < l->count; i++) {
+        if (layout[i].length != l->fields[i].length) {
+            return AT24C256_ERROR_PARAM;
+        }
+        if (layout[i].address < lo) {
+            lo = layout[i].address;
+        }
+        if ((uint32_t)layout[i].address + layout[i].length > hi) {
+            hi = (uint32_t)layout[i].address + layout[i].length;
+        }
+        total += layout[i].length;
+    }
+
+    uint8_t* values = (uint8_t*)malloc(total);
+    uint8_t* old = (uint8_t*)malloc(hi - lo);
+    uint8_t* image = (uint8_t*)malloc(hi - lo);
+    at24c256_err_t ret = (!values || !old || !image) ? AT24C256_ERROR_MEMORY : AT24C256_OK;
+    pthread_mutex_lock(&l->lock);
+    l->paused = true;
+    pthread_mutex_unlock(&l->lock);
+
+    // 先读出所有字段，新旧位置重叠也不会互相覆盖
+    uint32_t offset = 0;
+    for (int i = 0; i < l->count && ret == AT24C256_OK; i++) {
+        ret = at24c256_read(handle, l->fields[i].address, values + offset, l->fields[i].length);
+        offset += l->fields[i].length;
+    }
+    if (ret == AT24C256_OK) {
+        ret = at24c256_read(handle, (uint16_t)lo, old, (uint16_t)(hi - lo));
+    }
+
+    if (ret == AT24C256_OK) {
+        memcpy(image, old, hi - lo);
+        offset = 0;
+        for (int i = 0; i < l->count; i++) {
+            memcpy(image + (layout[i].address - lo), values + offset, layout[i].length);
+            offset += layout[i].length;
+        }
+
+        // 每页只编程内容变化的范围
+        uint16_t page_size = handle->config.page_size;
+        for (uint32_t start = lo; start < hi && ret == AT24C256_OK;) {
+            uint32_t end = (start / page_size + 1) * page_size;
+            if (end > hi) {
+                end = hi;
+            }
+            uint32_t a = start;
+            uint32_t b = end;
+            while (a < b && image[a - lo] == old[a - lo]) {
+                a++;
+            }
+            while (b > a && image[b - 1 - lo] == old[b - 1 - lo]) {
+                b--;
+            }
+            if (a < b) {
+                ret = at24c256_write(handle, (uint16_t)a, image + (a - lo), (uint16_t)(b - a));
+            }
+            start = end;
+        }
+    }
+
+    pthread_mutex_lock(&l->lock);
+    if (ret == AT24C256_OK) {
+        memcpy(l->fields, layout, (size_t)l->count * sizeof(layout[0]));
+    }
+    l->paused = false;
+    pthread_mutex_unlock(&l->lock);
+    free(values);
+    free(old);
+    free(image);
+    return ret;
+}
+
+at24c256_err_t at24c256_layout_untrack(at24c256_handle_t handle) {
+    if (!handle) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (handle->layout) {
+        pthread_mutex_destroy(&handle->layout->lock);
+        free(handle->layout->seen);
+        free(handle->layout);
+        handle->layout = NULL;
+    }
+    return AT24C256_OK;
+}
@@ -0,0 +1,376 @@
+/**
+ * @file at24c256_map.c
+ * @brief 基于userfaultfd的EEPROM内存映射
+ *
+ * 映射区域注册为MISSING|WP模式：首次访问某个主机页时由缺页线程从芯片读入并以
+ * 写保护方式安装；第一次写入触发写保护缺页，记录脏页后解除保护。msync时逐个
+ * EEPROM页与影子副本比较，只编程发生变化的部分，然后重新写保护。
+ *
+ * 缺页粒度是主机页 (通常4KB，即64个EEPROM页)，一次缺页用一次连续读取加载。
+ * 加载失败的主机页以0xFF安装并标记为无效：msync不写回这些页 (其内容并非芯片数据)，
+ * 并返回AT24C256_ERROR_READ，直到解除映射。
+ */
+
+#define _GNU_SOURCE
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if defined(__NR_userfaultfd)
+#include <linux/userfaultfd.h>
+#endif
+
+#if defined(__NR_userfaultfd) && defined(UFFD_FEATURE_PAGEFAULT_FLAG_WP) && \
+    defined(UFFDIO_WRITEPROTECT)
+#define AT24C256_HAVE_UFFD_WP 1
+#endif
+
+#ifdef AT24C256_HAVE_UFFD_WP
+
+/**
+ * @brief 内存映射状态
+ */
+struct at24c256_map_s {
+    at24c256_handle_t dev;       /**< 所属设备 */
+    int uffd;                    /**< userfaultfd描述符 */
+    int stop_pipe[2];            /**< 通知缺页线程退出 */
+    uint8_t* base;               /**< 映射起始地址 */
+    size_t size;                 /**< 映射长度 (按主机页对齐) */
+    size_t host_page;            /**< 主机页大小 */
+    uint8_t* shadow;             /**< 芯片上当前内容的副本，用于msync比较 */
+    uint8_t* page_buf;           /**< 缺页加载缓冲区 */
+    uint8_t* dirty;              /**< 每个主机页一个标志 */
+    uint8_t* poisoned;           /**< 每个主机页一个标志，加载失败时置位 */
+    pthread_t thread;            /**< 缺页处理线程 */
+    pthread_mutex_t lock;        /**< 保护dirty与设备访问 */
+};
+
+/**
+ * @brief 修改主机页范围的写保护状态
+ */
+static int set_write_protect(struct at24c256_map_s* m, size_t offset, size_t len, bool wp) {
+    struct uffdio_writeprotect wp_arg;
+    wp_arg.range.start = (uintptr_t)(m->base + offset);
+    wp_arg.range.len = len;
+    wp_arg.mode = wp ? UFFDIO_WRITEPROTECT_MODE_WP : 0;
+    return ioctl(m->uffd, UFFDIO_WRITEPROTECT, &wp_arg);
+}
+
+/**
+ * @brief 处理缺页：从芯片加载主机页并以写保护方式安装
+ */
+static void handle_missing(struct at24c256_map_s* m, size_t offset) {
+    uint32_t total = m->dev->config.total_size;
+    memset(m->page_buf, 0xFF, m->host_page);
+
+    pthread_mutex_lock(&m->lock);
+    if (offset < total) {
+        size_t len = total - offset < m->host_page ? total - offset : m->host_page;
+        if (at24c256_read(m->dev, (uint16_t)offset, m->page_buf, (uint16_t)len) != AT24C256_OK) {
+            // 读取失败：以0xFF安装，msync跳过该页并报告错误
+            memset(m->page_buf, 0xFF, len);
+            m->poisoned[offset / m->host_page] = 1;
+        }
+        memcpy(&m->shadow[offset], m->page_buf, len);
+    }
+    pthread_mutex_unlock(&m->lock);
+
+    struct uffdio_copy copy;
+    int ret;
+    do {
+        copy.dst = (uintptr_t)(m->base + offset);
+        copy.src = (uintptr_t)m->page_buf;
+        copy.len = m->host_page;
+        copy.mode = UFFDIO_COPY_MODE_WP;
+        copy.copy = 0;
+        ret = ioctl(m->uffd, UFFDIO_COPY, &copy);
+    } while (ret < 0 && errno == EAGAIN);
+    if (ret == 0) {
+        return;
+    }
+
+    struct uffdio_range range = { .start = (uintptr_t)(m->base + offset), .len = m->host_page };
+    if (errno != EEXIST) {
+        // 无法安装读到的内容：安装零页并按读取失败处理，msync跳过该页并报告错误
+        pthread_mutex_lock(&m->lock);
+        if (offset < total) {
+            size_t len = total - offset < m->host_page ? total - offset : m->host_page;
+            memset(&m->shadow[offset], 0x00, len);
+            m->poisoned[offset / m->host_page] = 1;
+        }
+        pthread_mutex_unlock(&m->lock);
+
+        struct uffdio_zeropage zero = { .range = range, .mode = 0 };
+        if (ioctl(m->uffd, UFFDIO_ZEROPAGE, &zero) == 0) {
+            return;
+        }
+    }
+
+    // 页已存在 (或零页也无法安装)：唤醒等待的线程，由它重新访问
+    ioctl(m->uffd, UFFDIO_WAKE, &range);
+}
+
+/**
+ * @brief 缺页处理线程
+ */
+static void* fault_thread(void* arg) {
+    struct at24c256_map_s* m = (struct at24c256_map_s*)arg;
+
+    for (;;) {
+        struct pollfd pfds[2] = {
+            { .fd = m->uffd, .events = POLLIN },
+            { .fd = m->stop_pipe[0], .events = POLLIN },
+        };
+        if (poll(pfds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (pfds[1].revents) {
+            break;
+        }
+
+        struct uffd_msg msg;
+        if (read(m->uffd, &msg, sizeof(msg)) != (ssize_t)sizeof(msg) ||
+            msg.event != UFFD_EVENT_PAGEFAULT) {
+            continue;
+        }
+
+        size_t offset = ((uintptr_t)msg.arg.pagefault.address - (uintptr_t)m->base) &
+                        ~(m->host_page - 1);
+        if (msg.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP) {
+            // 第一次写入已加载的页：记录脏页并解除保护
+            pthread_mutex_lock(&m->lock);
+            m->dirty[offset / m->host_page] = 1;
+            pthread_mutex_unlock(&m->lock);
+            set_write_protect(m, offset, m->host_page, false);
+        } else {
+            handle_missing(m, offset);
+        }
+    }
+
+    return NULL;
+}
+
+static void map_free(struct at24c256_map_s* m) {
+    if (m->base && m->base != MAP_FAILED) {
+        munmap(m->base, m->size);
+    }
+    if (m->uffd >= 0) {
+        close(m->uffd);
+    }
+    if (m->stop_pipe[0] >= 0) {
+        close(m->stop_pipe[0]);
+        close(m->stop_pipe[1]);
+    }
+    free(m->shadow);
+    free(m->page_buf);
+    free(m->dirty);
+    free(m->poisoned);
+    free(m);
+}
+
+at24c256_err_t at24c256_map(at24c256_handle_t handle, void** ptr) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!ptr) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (handle->map) {
+        *ptr = handle->map->base;
+        return AT24C256_OK;
+    }
+
+    struct at24c256_map_s* m = (struct at24c256_map_s*)calloc(1, sizeof(*m));
+    if (!m) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    m->dev = handle;
+    m->uffd = -1;
+    m->stop_pipe[0] = m->stop_pipe[1] = -1;
+    m->host_page = (size_t)sysconf(_SC_PAGESIZE);
+    m->size = (handle->config.total_size + m->host_page - 1) & ~(m->host_page - 1);
+
+    m->shadow = (uint8_t*)malloc(m->size);
+    m->page_buf = (uint8_t*)malloc(m->host_page);
+    m->dirty = (uint8_t*)calloc(m->size / m->host_page, 1);
+    m->poisoned = (uint8_t*)calloc(m->size / m->host_page, 1);
+    if (!m->shadow || !m->page_buf || !m->dirty || !m->poisoned ||
+        pipe2(m->stop_pipe, O_CLOEXEC) != 0) {
+        map_free(m);
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    // 打开userfaultfd并确认支持写保护缺页；只需处理用户态缺页，
+    // 内核支持时加UFFD_USER_MODE_ONLY (无需CAP_SYS_PTRACE)，旧内核不认识该标志时去掉重试
+    int flags = O_CLOEXEC | O_NONBLOCK;
+#ifdef UFFD_USER_MODE_ONLY
+    m->uffd = (int)syscall(__NR_userfaultfd, flags | UFFD_USER_MODE_ONLY);
+    if (m->uffd < 0 && errno == EINVAL) {
+        m->uffd = (int)syscall(__NR_userfaultfd, flags);
+    }
+#else
+    m->uffd = (int)syscall(__NR_userfaultfd, flags);
+#endif
+    struct uffdio_api api = { .api = UFFD_API, .features = UFFD_FEATURE_PAGEFAULT_FLAG_WP };
+    if (m->uffd < 0 || ioctl(m->uffd, UFFDIO_API, &api) != 0 ||
+        !(api.features & UFFD_FEATURE_PAGEFAULT_FLAG_WP)) {
+        map_free(m);
+        return AT24C256_ERROR_UNSUPPORTED;
+    }
+
+    m->base = (uint8_t*)mmap(NULL, m->size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m->base == MAP_FAILED) {
+        m->base = NULL;
+        map_free(m);
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    struct uffdio_register reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.range.start = (uintptr_t)m->base;
+    reg.range.len = m->size;
+    reg.mode = UFFDIO_REGISTER_MODE_MISSING | UFFDIO_REGISTER_MODE_WP;
+    if (ioctl(m->uffd, UFFDIO_REGISTER, &reg) != 0) {
+        map_free(m);
+        return AT24C256_ERROR_UNSUPPORTED;
+    }
+
+    pthread_mutex_init(&m->lock, NULL);
+    if (pthread_create(&m->thread, NULL, fault_thread, m) != 0) {
+        pthread_mutex_destroy(&m->lock);
+        map_free(m);
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    handle->map = m;
+    *ptr = m->base;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_msync(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!handle->map) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    struct at24c256_map_s* m = handle->map;
+    uint32_t total = handle->config.total_size;
+    uint16_t page_size = handle->config.page_size;
+    at24c256_err_t ret = AT24C256_OK;
+
+    bool poisoned = false;
+
+    for (size_t hp = 0; hp < m->size / m->host_page; hp++) {
+        pthread_mutex_lock(&m->lock);
+        bool dirty = m->dirty[hp];
+        if (m->poisoned[hp]) {
+            // 加载失败的页内容不是芯片数据，写回会覆盖芯片上的原内容
+            poisoned = true;
+            dirty = false;
+        }
+        m->dirty[hp] = 0;
+        pthread_mutex_unlock(&m->lock);
+        if (!dirty) {
+            continue;
+        }
+
+        // 先恢复写保护，比较期间的新写入会再次标记脏页
+        size_t offset = hp * m->host_page;
+        set_write_protect(m, offset, m->host_page, true);
+
+        size_t end = offset + m->host_page < total ? offset + m->host_page : total;
+        for (size_t page = offset; page < end; page += page_size) {
+            size_t page_end = page + page_size < end ? page + page_size : end;
+
+            // 找出该EEPROM页内第一个和最后一个变化的字节
+            size_t first = page;
+            while (first < page_end && m->base[first] == m->shadow[first]) {
+                first++;
+            }
+            if (first == page_end) {
+                continue;
+            }
+            size_t last = page_end - 1;
+            while (m->base[last] == m->shadow[last]) {
+                last--;
+            }
+
+            size_t len = last - first + 1;
+            pthread_mutex_lock(&m->lock);
+            at24c256_err_t err = at24c256_write(handle, (uint16_t)first, &m->base[first],
+                                                (uint16_t)len);
+            if (err == AT24C256_OK) {
+                memcpy(&m->shadow[first], &m->base[first], len);
+            }
+            pthread_mutex_unlock(&m->lock);
+
+            if (err != AT24C256_OK) {
+                pthread_mutex_lock(&m->lock);
+                m->dirty[hp] = 1;
+                pthread_mutex_unlock(&m->lock);
+                set_write_protect(m, offset, m->host_page, false);
+                ret = err;
+                break;
+            }
+        }
+    }
+
+    if (ret == AT24C256_OK && poisoned) {
+        ret = AT24C256_ERROR_READ;
+    }
+    return ret;
+}
+
+at24c256_err_t at24c256_unmap(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!handle->map) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    struct at24c256_map_s* m = handle->map;
+    ssize_t ignored = write(m->stop_pipe[1], "x", 1);
+    (void)ignored;
+    pthread_join(m->thread, NULL);
+    pthread_mutex_destroy(&m->lock);
+
+    map_free(m);
+    handle->map = NULL;
+    return AT24C256_OK;
+}
+
+#else /* !AT24C256_HAVE_UFFD_WP */
+
+at24c256_err_t at24c256_map(at24c256_handle_t handle, void** ptr) {
+    (void)handle;
+    (void)ptr;
+    return AT24C256_ERROR_UNSUPPORTED;
+}
+
+at24c256_err_t at24c256_msync(at24c256_handle_t handle) {
+    (void)handle;
+    return AT24C256_ERROR_UNSUPPORTED;
+}
+
+at24c256_err_t at24c256_unmap(at24c256_handle_t handle) {
+    (void)handle;
+    return AT24C256_ERROR_UNSUPPORTED;
+}
+
+#endif /* AT24C256_HAVE_UFFD_WP */
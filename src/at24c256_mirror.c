@@ -0,0 +1,362 @@
+/**
+ * @file at24c256_mirror.c
+ * @brief 镜像设备对实现
+ *
+ * 每个设备一把锁，保证同一句柄不会被并发访问；读写之间用读写锁，读取期间
+ * 不会看到只写了一个设备的内容。需要两个设备同时工作时 (写入、分开的读取)，
+ * 第二个设备的部分在临时线程中执行，当前线程执行第一个设备的部分。
+ *
+ * 只在一个设备上成功的写入使另一个设备的该范围过期 (每个设备记一个包含所有过期写入的范围)。
+ * 读取与过期范围重叠时只使用另一个设备，完整覆盖过期范围的成功写入或重新同步后恢复。
+ */
+
+#include "at24c256_mirror.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * @brief 镜像中的一个设备
+ */
+typedef struct {
+    at24c256_handle_t handle;
+    pthread_mutex_t lock;        /**< 串行访问句柄 */
+    uint32_t inflight;           /**< 已分配到该设备、尚未完成的读取数 */
+    uint32_t stale_lo;           /**< 过期范围 [stale_lo, stale_hi)，相等表示没有 */
+    uint32_t stale_hi;
+} member_t;
+
+/**
+ * @brief 镜像状态
+ */
+struct at24c256_mirror_s {
+    member_t dev[2];
+    pthread_rwlock_t rw;         /**< 读取共享，写入独占 (过期范围只在独占时修改) */
+    pthread_mutex_t state;       /**< 保护inflight、next与统计 */
+    int next;                    /**< 两个设备同样空闲时轮流选择 */
+    at24c256_mirror_verify_t verify;
+    void* ctx;
+    at24c256_mirror_stats_t stats;
+};
+
+/**
+ * @brief 一个设备上的一次读写
+ */
+typedef struct {
+    struct at24c256_mirror_s* m;
+    int dev;
+    bool write;
+    uint16_t address;
+    uint8_t* data;
+    const uint8_t* source;
+    uint16_t length;
+    at24c256_err_t result;
+} job_t;
+
+static void* run_job(void* arg) {
+    job_t* job = (job_t*)arg;
+    member_t* member = &job->m->dev[job->dev];
+
+    pthread_mutex_lock(&member->lock);
+    if (job->write) {
+        job->result = at24c256_write(member->handle, job->address, job->source, job->length);
+    } else {
+        job->result = at24c256_read(member->handle, job->address, job->data, job->length);
+    }
+    pthread_mutex_unlock(&member->lock);
+    return NULL;
+}
+
+/**
+ * @brief 两个设备同时执行，都完成后返回第一个错误
+ */
+static at24c256_err_t run_pair(job_t* first, job_t* second) {
+    pthread_t thread;
+    bool threaded = pthread_create(&thread, NULL, run_job, second) == 0;
+    if (!threaded) {
+        run_job(second);
+    }
+    run_job(first);
+    if (threaded) {
+        pthread_join(thread, NULL);
+    }
+    return first->result != AT24C256_OK ? first->result : second->result;
+}
+
+/**
+ * @brief 设备在范围内的内容是否过期 (持有读写锁)
+ */
+static bool is_stale(const member_t* member, uint32_t address, uint32_t length) {
+    return member->stale_lo < member->stale_hi && address < member->stale_hi &&
+           member->stale_lo < address + length;
+}
+
+/**
+ * @brief 范围内内容有效的设备：两个都有效返回-1 (两个都过期时同样返回-1)
+ */
+static int only_fresh(const struct at24c256_mirror_s* m, uint32_t address, uint32_t length) {
+    bool stale0 = is_stale(&m->dev[0], address, length);
+    bool stale1 = is_stale(&m->dev[1], address, length);
+    return stale0 == stale1 ? -1 : stale0 ? 1 : 0;
+}
+
+/**
+ * @brief 为一次短读取选择设备 (进行中的读取少者优先，相同时轮流；only >= 0时只用该设备)
+ */
+static int pick_device(struct at24c256_mirror_s* m, int only) {
+    pthread_mutex_lock(&m->state);
+    int dev;
+    if (only >= 0) {
+        dev = only;
+    } else if (m->dev[0].inflight != m->dev[1].inflight) {
+        dev = m->dev[0].inflight < m->dev[1].inflight ? 0 : 1;
+    } else {
+        dev = m->next;
+        m->next ^= 1;
+    }
+    m->dev[dev].inflight++;
+    m->stats.reads[dev]++;
+    pthread_mutex_unlock(&m->state);
+    return dev;
+}
+
+static void finish_read(struct at24c256_mirror_s* m, int dev) {
+    pthread_mutex_lock(&m->state);
+    m->dev[dev].inflight--;
+    pthread_mutex_unlock(&m->state);
+}
+
+/**
+ * @brief 按负载均衡读取 (短读取一个设备，长读取两个设备各一半)
+ */
+static at24c256_err_t balanced_read(struct at24c256_mirror_s* m, uint16_t address,
+                                    uint8_t* data, uint16_t length) {
+    job_t jobs[2];
+    memset(jobs, 0, sizeof(jobs));
+
+    int only = only_fresh(m, address, length);
+    if (length < AT24C256_MIRROR_SPLIT_MIN || only >= 0) {
+        jobs[0] = (job_t){ .m = m, .dev = pick_device(m, only), .address = address, .data = data,
+                           .length = length };
+        run_job(&jobs[0]);
+        finish_read(m, jobs[0].dev);
+        return jobs[0].result;
+    }
+
+    // 中点取在页边界上，两半的事务都不额外跨页
+    uint16_t page_size = m->dev[0].handle->config.page_size;
+    uint32_t mid = ((uint32_t)address + length / 2) / page_size * page_size;
+    if (mid <= address) {
+        mid = (uint32_t)address + length / 2;
+    }
+    uint16_t head = (uint16_t)(mid - address);
+
+    pthread_mutex_lock(&m->state);
+    for (int i = 0; i < 2; i++) {
+        m->dev[i].inflight++;
+        m->stats.reads[i]++;
+    }
+    m->stats.split_reads++;
+    pthread_mutex_unlock(&m->state);
+
+    jobs[0] = (job_t){ .m = m, .dev = 0, .address = address, .data = data, .length = head };
+    jobs[1] = (job_t){ .m = m, .dev = 1, .address = (uint16_t)mid, .data = data + head,
+                       .length = (uint16_t)(length - head) };
+    at24c256_err_t ret = run_pair(&jobs[0], &jobs[1]);
+    finish_read(m, 0);
+    finish_read(m, 1);
+    return ret;
+}
+
+at24c256_err_t at24c256_mirror_open(at24c256_handle_t primary, at24c256_handle_t secondary,
+                                   at24c256_mirror_verify_t verify, void* ctx,
+                                   at24c256_mirror_t* mirror) {
+    if (!primary || !secondary || !primary->initialized || !secondary->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!mirror || primary == secondary ||
+        primary->config.total_size != secondary->config.total_size ||
+        primary->config.page_size != secondary->config.page_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    struct at24c256_mirror_s* m = (struct at24c256_mirror_s*)calloc(1, sizeof(*m));
+    if (!m) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    m->dev[0].handle = primary;
+    m->dev[1].handle = secondary;
+    for (int i = 0; i < 2; i++) {
+        pthread_mutex_init(&m->dev[i].lock, NULL);
+    }
+    pthread_rwlock_init(&m->rw, NULL);
+    pthread_mutex_init(&m->state, NULL);
+    m->verify = verify;
+    m->ctx = ctx;
+
+    *mirror = m;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_mirror_read(at24c256_mirror_t mirror, uint16_t address, uint8_t* data,
+                                   uint16_t length) {
+    if (!mirror || !data || length == 0 ||
+        (uint32_t)address + length > mirror->dev[0].handle->config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    pthread_rwlock_rdlock(&mirror->rw);
+    at24c256_err_t ret = balanced_read(mirror, address, data, length);
+    if (ret == AT24C256_OK &&
+        (!mirror->verify || mirror->verify(address, data, length, mirror->ctx))) {
+        pthread_rwlock_unlock(&mirror->rw);
+        return AT24C256_OK;
+    }
+
+    // 出错或校验失败：依次从单个设备完整读取
+    pthread_mutex_lock(&mirror->state);
+    mirror->stats.fallbacks++;
+    pthread_mutex_unlock(&mirror->state);
+
+    ret = AT24C256_ERROR_READ;
+    int only = only_fresh(mirror, address, length);
+    for (int dev = 0; dev < 2 && ret != AT24C256_OK; dev++) {
+        if (only >= 0 && dev != only) {
+            continue;
+        }
+        job_t job = { .m = mirror, .dev = dev, .address = address, .data = data,
+                      .length = length };
+        run_job(&job);
+        if (job.result == AT24C256_OK &&
+            (!mirror->verify || mirror->verify(address, data, length, mirror->ctx))) {
+            ret = AT24C256_OK;
+        }
+    }
+    pthread_rwlock_unlock(&mirror->rw);
+    return ret;
+}
+
+/**
+ * @brief 写入失败：把范围并入设备的过期范围
+ */
+static void mark_stale(member_t* member, uint32_t address, uint32_t length) {
+    if (member->stale_lo == member->stale_hi) {
+        member->stale_lo = address;
+        member->stale_hi = address + length;
+        return;
+    }
+    if (address < member->stale_lo) {
+        member->stale_lo = address;
+    }
+    if (address + length > member->stale_hi) {
+        member->stale_hi = address + length;
+    }
+}
+
+/**
+ * @brief 写入成功：完整覆盖过期范围时设备恢复
+ */
+static void clear_stale(member_t* member, uint32_t address, uint32_t length) {
+    if (address <= member->stale_lo && member->stale_hi <= address + length) {
+        member->stale_lo = member->stale_hi = 0;
+    }
+}
+
+at24c256_err_t at24c256_mirror_write(at24c256_mirror_t mirror, uint16_t address,
+                                    const uint8_t* data, uint16_t length) {
+    if (!mirror || !data || length == 0 ||
+        (uint32_t)address + length > mirror->dev[0].handle->config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    job_t jobs[2];
+    for (int i = 0; i < 2; i++) {
+        jobs[i] = (job_t){ .m = mirror, .dev = i, .write = true, .address = address,
+                           .source = data, .length = length };
+    }
+    pthread_rwlock_wrlock(&mirror->rw);
+    at24c256_err_t ret = run_pair(&jobs[0], &jobs[1]);
+    if (jobs[0].result == AT24C256_OK || jobs[1].result == AT24C256_OK) {
+        pthread_mutex_lock(&mirror->state);
+        for (int i = 0; i < 2; i++) {
+            if (jobs[i].result == AT24C256_OK) {
+                clear_stale(&mirror->dev[i], address, length);
+            } else {
+                mark_stale(&mirror->dev[i], address, length);
+                mirror->stats.diverged++;
+            }
+        }
+        pthread_mutex_unlock(&mirror->state);
+    }
+    pthread_rwlock_unlock(&mirror->rw);
+    return ret;
+}
+
+at24c256_err_t at24c256_mirror_resync(at24c256_mirror_t mirror) {
+    if (!mirror) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    uint8_t buffer[AT24C256_MAX_PAGE_SIZE];
+    uint16_t page_size = mirror->dev[0].handle->config.page_size;
+    at24c256_err_t ret = AT24C256_OK;
+
+    pthread_rwlock_wrlock(&mirror->rw);
+    for (int dev = 0; dev < 2; dev++) {
+        member_t* target = &mirror->dev[dev];
+        member_t* source = &mirror->dev[dev ^ 1];
+        if (target->stale_lo == target->stale_hi) {
+            continue;
+        }
+
+        // 按页从另一个设备复制过期范围 (两个设备的过期范围重叠时，重叠部分以第二个设备为准)
+        at24c256_err_t r = AT24C256_OK;
+        for (uint32_t pos = target->stale_lo; pos < target->stale_hi && r == AT24C256_OK;) {
+            uint32_t chunk = page_size - pos % page_size;
+            if (chunk > target->stale_hi - pos) {
+                chunk = target->stale_hi - pos;
+            }
+            r = at24c256_read(source->handle, (uint16_t)pos, buffer, (uint16_t)chunk);
+            if (r == AT24C256_OK) {
+                r = at24c256_write(target->handle, (uint16_t)pos, buffer, (uint16_t)chunk);
+            }
+            pos += chunk;
+        }
+        if (r == AT24C256_OK) {
+            pthread_mutex_lock(&mirror->state);
+            target->stale_lo = target->stale_hi = 0;
+            pthread_mutex_unlock(&mirror->state);
+        } else {
+            ret = r;
+        }
+    }
+    pthread_rwlock_unlock(&mirror->rw);
+    return ret;
+}
+
+at24c256_err_t at24c256_mirror_get_stats(at24c256_mirror_t mirror, at24c256_mirror_stats_t* stats) {
+    if (!mirror || !stats) {
+        return AT24C256_ERROR_PARAM;
+    }
+    pthread_mutex_lock(&mirror->state);
+    *stats = mirror->stats;
+    for (int i = 0; i < 2; i++) {
+        stats->stale_length[i] = mirror->dev[i].stale_hi - mirror->dev[i].stale_lo;
+    }
+    pthread_mutex_unlock(&mirror->state);
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_mirror_close(at24c256_mirror_t mirror) {
+    if (!mirror) {
+        return AT24C256_ERROR_PARAM;
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_mutex_destroy(&mirror->dev[i].lock);
+    }
+    pthread_rwlock_destroy(&mirror->rw);
+    pthread_mutex_destroy(&mirror->state);
+    free(mirror);
+    return AT24C256_OK;
+}
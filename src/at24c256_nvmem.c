@@ -0,0 +1,90 @@
+/**
+ * @file at24c256_nvmem.c
+ * @brief 内核nvmem后端
+ *
+ * 内核at24驱动已绑定芯片时，i2c-dev无法再占用该地址。此后端通过
+ * /sys/bus/nvmem/devices/<*>/nvmem 文件用pread/pwrite访问芯片，写周期查询由内核完成。
+ * 任何普通文件都可以充当nvmem节点，便于在没有硬件的环境下测试。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+/**
+ * @brief 读取
+ */
+static at24c256_err_t nvmem_read(at24c256_handle_t handle, uint16_t address,
+                                 uint8_t* data, uint16_t length) {
+    uint16_t done = 0;
+    while (done < length) {
+        ssize_t n = pread(handle->fd, data + done, length - done, (off_t)address + done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return AT24C256_ERROR_READ;
+        }
+        done += (uint16_t)n;
+    }
+    return AT24C256_OK;
+}
+
+/**
+ * @brief 编程一页 (内核等待写周期完成后才返回)
+ */
+static at24c256_err_t nvmem_program_page(at24c256_handle_t handle, uint16_t address,
+                                         const uint8_t* data, uint16_t length) {
+    uint16_t done = 0;
+    while (done < length) {
+        ssize_t n = pwrite(handle->fd, data + done, length - done, (off_t)address + done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return AT24C256_ERROR_WRITE;
+        }
+        done += (uint16_t)n;
+    }
+    return AT24C256_OK;
+}
+
+/**
+ * @brief pwrite返回时写周期已经结束，设备总是就绪
+ */
+static at24c256_err_t nvmem_poll_ready(at24c256_handle_t handle) {
+    (void)handle;
+    return AT24C256_OK;
+}
+
+/**
+ * @brief 内核nvmem后端
+ */
+static const at24c256_backend_t nvmem_backend = {
+    .name = "nvmem",
+    .read = nvmem_read,
+    .program_page = nvmem_program_page,
+    .poll_ready = nvmem_poll_ready,
+    .write_cycle = false,
+};
+
+at24c256_err_t at24c256_nvmem_open(at24c256_handle_t handle) {
+    handle->fd = open(handle->config.nvmem_path, O_RDWR | O_CLOEXEC);
+    if (handle->fd < 0) {
+        return AT24C256_ERROR_INIT;
+    }
+
+    // 节点大小可知时必须覆盖配置的容量
+    struct stat st;
+    if (fstat(handle->fd, &st) != 0 ||
+        (st.st_size > 0 && (uint64_t)st.st_size < handle->config.total_size)) {
+        close(handle->fd);
+        return AT24C256_ERROR_INIT;
+    }
+
+    handle->backend = &nvmem_backend;
+    return AT24C256_OK;
+}
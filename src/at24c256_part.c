@@ -0,0 +1,73 @@
+/**
+ * @file at24c256_part.c
+ * @brief AT24Cxx系列器件描述表
+ */
+
+#include "at24c256.h"
+#include <strings.h>
+#include <string.h>
+
+/**
+ * @brief 内置器件表
+ *
+ * 1字节字地址的器件 (AT24C04/08/16) 用设备地址的低位选择256字节块。
+ * AT24C1024需要17位地址，超出uint16_t地址范围，未列入。
+ */
+static const at24c256_part_t parts[] = {
+    /* name        page  total  addr block tWR */
+    { "AT24C02",     8,   256,   1,   0,   5 },
+    { "AT24C04",    16,   512,   1,   1,   5 },
+    { "AT24C08",    16,  1024,   1,   2,   5 },
+    { "AT24C16",    16,  2048,   1,   3,   5 },
+    { "AT24C32",    32,  4096,   2,   0,   5 },
+    { "AT24C64",    32,  8192,   2,   0,   5 },
+    { "AT24C128",   64, 16384,   2,   0,   5 },
+    { "AT24C256",   64, 32768,   2,   0,   5 },
+    { "AT24C512",  128, 65536,   2,   0,   5 },
+};
+
+/**
+ * @brief 忽略大小写比较，name可以省略"AT"前缀
+ */
+static bool name_matches(const char* part, const char* name) {
+    if (strncasecmp(name, "AT", 2) == 0) {
+        name += 2;
+    }
+    part += 2;
+    return strcasecmp(part, name) == 0;
+}
+
+const at24c256_part_t* at24c256_find_part(const char* name) {
+    if (!name) {
+        return NULL;
+    }
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        if (name_matches(parts[i].name, name)) {
+            return &parts[i];
+        }
+    }
+    return NULL;
+}
+
+const at24c256_part_t* at24c256_part_at(int index) {
+    if (index < 0 || (size_t)index >= sizeof(parts) / sizeof(parts[0])) {
+        return NULL;
+    }
+    return &parts[index];
+}
+
+at24c256_err_t at24c256_config_set_part(at24c256_config_t* config, const char* name) {
+    if (!config) {
+        return AT24C256_ERROR_PARAM;
+    }
+    const at24c256_part_t* part = at24c256_find_part(name);
+    if (!part) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    config->page_size = part->page_size;
+    config->total_size = part->total_size;
+    config->addr_bytes = part->addr_bytes;
+    config->write_delay_ms = part->write_delay_ms;
+    return AT24C256_OK;
+}
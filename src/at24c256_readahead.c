@@ -0,0 +1,140 @@
+/**
+ * @file at24c256_readahead.c
+ * @brief AT24C256 顺序读预读
+ *
+ * 与内核页缓存的预读类似：读取紧接上一次读取的结尾时视为顺序访问，按当前窗口
+ * 一次读入一段到缓冲区；缓冲区读完仍是顺序访问时窗口加倍，直到最大窗口。
+ * 非顺序的读取直接访问芯片并重置窗口，随机访问不会多读。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_ADDRESS 0xFFFFFFFFu
+
+/**
+ * @brief 预读状态
+ */
+struct at24c256_readahead_s {
+    uint8_t* buffer;
+    uint32_t capacity;           /**< 缓冲区大小 (最大窗口) */
+    uint32_t start;              /**< 缓冲区对应的芯片地址 */
+    uint32_t length;             /**< 缓冲区中的有效字节数 */
+    uint32_t next;               /**< 上一次读取的结尾，NO_ADDRESS表示没有 */
+    uint32_t window;             /**< 当前窗口，0表示不在顺序访问中 */
+};
+
+/**
+ * @brief 顺序访问时计算下一个窗口
+ */
+static uint32_t next_window(at24c256_handle_t handle, uint32_t length) {
+    struct at24c256_readahead_s* ra = handle->readahead;
+    uint32_t window = ra->window ? ra->window * 2 : length * 4;
+    if (window < handle->config.page_size) {
+        window = handle->config.page_size;
+    }
+    return window < ra->capacity ? window : ra->capacity;
+}
+
+at24c256_err_t at24c256_readahead_read(at24c256_handle_t handle, uint16_t address,
+                                      uint8_t* data, uint16_t length) {
+    struct at24c256_readahead_s* ra = handle->readahead;
+    uint32_t end = (uint32_t)address + length;
+    uint32_t done = 0;
+
+    // 缓冲区命中的开头部分
+    if (address >= ra->start && address < ra->start + ra->length) {
+        uint32_t avail = ra->start + ra->length - address;
+        done = length < avail ? length : avail;
+        memcpy(data, ra->buffer + (address - ra->start), done);
+        if (done == length) {
+            ra->next = end;
+            return AT24C256_OK;
+        }
+    }
+
+    bool sequential = done > 0 || address == ra->next;
+    ra->next = end;
+    if (!sequential) {
+        ra->window = 0;
+        return at24c256_raw_read(handle, address, data, length);
+    }
+
+    uint32_t cur = address + done;
+    uint32_t remaining = length - done;
+    ra->window = next_window(handle, length);
+    if (remaining > ra->capacity) {
+        return at24c256_raw_read(handle, (uint16_t)cur, data + done, (uint16_t)remaining);
+    }
+
+    uint32_t fetch = ra->window > remaining ? ra->window : remaining;
+    if (fetch > handle->config.total_size - cur) {
+        fetch = handle->config.total_size - cur;
+    }
+    ra->length = 0;
+    at24c256_err_t ret = at24c256_raw_read(handle, (uint16_t)cur, ra->buffer, (uint16_t)fetch);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    ra->start = cur;
+    ra->length = fetch;
+    memcpy(data + done, ra->buffer, remaining);
+    return AT24C256_OK;
+}
+
+void at24c256_readahead_store(at24c256_handle_t handle, uint16_t address,
+                              const uint8_t* data, uint16_t length) {
+    struct at24c256_readahead_s* ra = handle->readahead;
+    uint32_t lo = address > ra->start ? address : ra->start;
+    uint32_t hi = (uint32_t)address + length;
+    if (hi > ra->start + ra->length) {
+        hi = ra->start + ra->length;
+    }
+    if (lo < hi) {
+        memcpy(ra->buffer + (lo - ra->start), data + (lo - address), hi - lo);
+    }
+}
+
+at24c256_err_t at24c256_readahead_enable(at24c256_handle_t handle, uint16_t max_window) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (max_window == 0) {
+        max_window = AT24C256_READAHEAD_DEFAULT_MAX;
+    }
+    if (max_window < handle->config.page_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    struct at24c256_readahead_s* ra = (struct at24c256_readahead_s*)calloc(1, sizeof(*ra));
+    if (!ra) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    ra->buffer = (uint8_t*)malloc(max_window);
+    if (!ra->buffer) {
+        free(ra);
+        return AT24C256_ERROR_MEMORY;
+    }
+    ra->capacity = max_window;
+    ra->next = NO_ADDRESS;
+
+    if (handle->readahead) {
+        at24c256_readahead_disable(handle);
+    }
+    handle->readahead = ra;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_readahead_disable(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (handle->readahead) {
+        free(handle->readahead->buffer);
+        free(handle->readahead);
+        handle->readahead = NULL;
+    }
+    return AT24C256_OK;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file at24c256_sim.c
+ * @brief 内存模拟器后端
+ *
+ * 芯片内容保存在内存中，总线传输与写周期只推进虚拟时钟，不真正等待，用于离线回放
+ * 访问记录、比较不同驱动设置下的总线时间。时间模型：
+ *   - 每字节9位 (8位数据 + 应答)，按bus_hz折算
+ *   - 读事务：设备地址 + 字地址 + 重复起始后的设备地址 + 数据
+ *   - 页编程：设备地址 + 字地址 + 数据，之后芯片忙write_cycle_us
+ *   - 固定延时：编程后立即等待config.write_delay_ms
+ *   - 芯片仍在写周期内时的访问先做应答查询，每次查询占用一个字节的总线时间
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief 模拟器状态
+ */
+struct at24c256_sim_s {
+    at24c256_sim_params_t params;
+    uint8_t* memory;             /**< 芯片内容 */
+    uint64_t byte_ns;            /**< 传输一个字节的时间 */
+    uint64_t busy_until;         /**< 写周期结束的时刻 */
+    at24c256_sim_stats_t stats;
+};
+
+/**
+ * @brief 占用总线传输bytes个字节
+ */
+static void sim_bus(struct at24c256_sim_s* s, uint64_t bytes) {
+    uint64_t ns = bytes * s->byte_ns;
+    s->stats.now_ns += ns;
+    s->stats.bus_ns += ns;
+}
+
+/**
+ * @brief 写周期内的访问：应答查询直到芯片就绪
+ */
+static void sim_settle(struct at24c256_sim_s* s) {
+    if (s->stats.now_ns >= s->busy_until) {
+        return;
+    }
+    uint64_t polls = (s->busy_until - s->stats.now_ns + s->byte_ns - 1) / s->byte_ns;
+    s->stats.polls += (uint32_t)polls;
+    sim_bus(s, polls);
+}
+
+static at24c256_err_t sim_read(at24c256_handle_t handle, uint16_t address,
+                               uint8_t* data, uint16_t length) {
+    struct at24c256_sim_s* s = handle->sim;
+    sim_settle(s);
+    sim_bus(s, 2u + handle->config.addr_bytes + length);
+    memcpy(data, &s->memory[address], length);
+    s->stats.reads++;
+    return AT24C256_OK;
+}
+
+static at24c256_err_t sim_program_page(at24c256_handle_t handle, uint16_t address,
+                                       const uint8_t* data, uint16_t length) {
+    struct at24c256_sim_s* s = handle->sim;
+    sim_settle(s);
+    sim_bus(s, 1u + handle->config.addr_bytes + length);
+    memcpy(&s->memory[address], data, length);
+    s->stats.pages++;
+    s->busy_until = s->stats.now_ns + (uint64_t)s->params.write_cycle_us * 1000u;
+
+    if (s->params.wait == AT24C256_SIM_WAIT_DELAY) {
+        uint64_t wait = (uint64_t)handle->config.write_delay_ms * 1000000u;
+        s->stats.now_ns += wait;
+        s->stats.wait_ns += wait;
+    }
+    return AT24C256_OK;
+}
+
+/**
+ * @brief 查询就绪：持续查询直到写周期结束，因此总是返回就绪
+ */
+static at24c256_err_t sim_poll_ready(at24c256_handle_t handle) {
+    sim_settle(handle->sim);
+    return AT24C256_OK;
+}
+
+static uint64_t sim_now_ns(at24c256_handle_t handle) {
+    return handle->sim->stats.now_ns;
+}
+
+/**
+ * @brief 内存模拟器后端 (写周期在虚拟时钟中计算，驱动不需要等待)
+ */
+static const at24c256_backend_t sim_backend = {
+    .name = "sim",
+    .read = sim_read,
+    .program_page = sim_program_page,
+    .poll_ready = sim_poll_ready,
+    .write_cycle = false,
+    .now_ns = sim_now_ns,
+};
+
+at24c256_err_t at24c256_sim_open(at24c256_handle_t handle) {
+    if (handle->config.sim->bus_hz == 0) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    struct at24c256_sim_s* s = (struct at24c256_sim_s*)calloc(1, sizeof(*s));
+    if (!s) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    s->memory = (uint8_t*)malloc(handle->config.total_size);
+    if (!s->memory) {
+        free(s);
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    // 出厂状态全为0xFF
+    memset(s->memory, 0xFF, handle->config.total_size);
+    s->params = *handle->config.sim;
+    s->byte_ns = 9000000000ULL / s->params.bus_hz;
+
+    // 配置中的参数指针改为指向内部副本，调用者的结构体可以是临时变量
+    handle->config.sim = &s->params;
+    handle->fd = -1;
+    handle->sim = s;
+    handle->backend = &sim_backend;
+    return AT24C256_OK;
+}
+
+void at24c256_sim_free(at24c256_handle_t handle) {
+    free(handle->sim->memory);
+    free(handle->sim);
+    handle->sim = NULL;
+}
+
+at24c256_err_t at24c256_sim_advance(at24c256_handle_t handle, uint64_t ns) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!handle->sim) {
+        return AT24C256_ERROR_UNSUPPORTED;
+    }
+    handle->sim->stats.now_ns += ns;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_sim_get_stats(at24c256_handle_t handle, at24c256_sim_stats_t* stats) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!stats) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (!handle->sim) {
+        return AT24C256_ERROR_UNSUPPORTED;
+    }
+    *stats = handle->sim->stats;
+    return AT24C256_OK;
+}
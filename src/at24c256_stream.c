@@ -0,0 +1,235 @@
+/**
+ * @file at24c256_stream.c
+ * @brief 文件描述符与EEPROM之间的流式传输
+ *
+ * 使用两个页大小的缓冲区：辅助线程负责文件描述符一侧的读写，调用线程负责总线一侧，
+ * 一个缓冲区在总线上传输时另一个缓冲区同时与文件描述符交换数据。
+ * 每块数据按页边界切分，写入时每块正好是一次页编程。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+
+/**
+ * @brief 双缓冲流水线
+ */
+typedef struct {
+    at24c256_handle_t handle;
+    int fd;
+    uint16_t address;            /**< 起始地址 */
+    uint32_t length;             /**< 总字节数 */
+    bool to_fd;                  /**< true: EEPROM -> fd，false: fd -> EEPROM */
+    uint8_t* buffer[2];
+    uint16_t filled[2];          /**< 缓冲区中的有效字节数，0表示空 */
+    at24c256_err_t error;        /**< 任一侧出错后另一侧立即停止 */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} stream_t;
+
+/**
+ * @brief 从offset开始的一块长度 (不跨页)
+ */
+static uint16_t chunk_length(const stream_t* s, uint32_t offset) {
+    uint16_t page_size = s->handle->config.page_size;
+    uint32_t room = page_size - (s->address + offset) % page_size;
+    uint32_t left = s->length - offset;
+    return (uint16_t)(left < room ? left : room);
+}
+
+/**
+ * @brief 等待缓冲区变为满 (full为true) 或空，出错时返回false
+ */
+static bool wait_slot(stream_t* s, int slot, bool full) {
+    pthread_mutex_lock(&s->lock);
+    while (s->error == AT24C256_OK && (s->filled[slot] != 0) != full) {
+        pthread_cond_wait(&s->cond, &s->lock);
+    }
+    bool ok = s->error == AT24C256_OK;
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+/**
+ * @brief 设置缓冲区状态并唤醒另一侧
+ */
+static void set_slot(stream_t* s, int slot, uint16_t filled) {
+    pthread_mutex_lock(&s->lock);
+    s->filled[slot] = filled;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void fail(stream_t* s, at24c256_err_t error) {
+    pthread_mutex_lock(&s->lock);
+    if (s->error == AT24C256_OK) {
+        s->error = error;
+    }
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+/**
+ * @brief 完整读取length字节，文件提前结束视为错误
+ */
+static bool read_full(int fd, uint8_t* data, uint16_t length) {
+    uint16_t done = 0;
+    while (done < length) {
+        ssize_t n = read(fd, data + done, length - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += (uint16_t)n;
+    }
+    return true;
+}
+
+static bool write_full(int fd, const uint8_t* data, uint16_t length) {
+    uint16_t done = 0;
+    while (done < length) {
+        ssize_t n = write(fd, data + done, length - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += (uint16_t)n;
+    }
+    return true;
+}
+
+/**
+ * @brief 辅助线程：文件描述符一侧
+ */
+static void* fd_side(void* arg) {
+    stream_t* s = (stream_t*)arg;
+    int slot = 0;
+
+    for (uint32_t offset = 0; offset < s->length; slot ^= 1) {
+        uint16_t len = chunk_length(s, offset);
+        if (s->to_fd) {
+            if (!wait_slot(s, slot, true)) {
+                break;
+            }
+            if (!write_full(s->fd, s->buffer[slot], len)) {
+                fail(s, AT24C256_ERROR_WRITE);
+                break;
+            }
+            set_slot(s, slot, 0);
+        } else {
+            if (!wait_slot(s, slot, false)) {
+                break;
+            }
+            if (!read_full(s->fd, s->buffer[slot], len)) {
+                fail(s, AT24C256_ERROR_READ);
+                break;
+            }
+            set_slot(s, slot, len);
+        }
+        offset += len;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 调用线程：总线一侧
+ */
+static void bus_side(stream_t* s) {
+    int slot = 0;
+
+    for (uint32_t offset = 0; offset < s->length; slot ^= 1) {
+        uint16_t len = chunk_length(s, offset);
+        uint16_t address = (uint16_t)(s->address + offset);
+        at24c256_err_t ret;
+        if (s->to_fd) {
+            if (!wait_slot(s, slot, false)) {
+                return;
+            }
+            ret = at24c256_read(s->handle, address, s->buffer[slot], len);
+            if (ret == AT24C256_OK) {
+                set_slot(s, slot, len);
+            }
+        } else {
+            if (!wait_slot(s, slot, true)) {
+                return;
+            }
+            ret = at24c256_write(s->handle, address, s->buffer[slot], len);
+            if (ret == AT24C256_OK) {
+                set_slot(s, slot, 0);
+            }
+        }
+        if (ret != AT24C256_OK) {
+            fail(s, ret);
+            return;
+        }
+        offset += len;
+    }
+
+    // 等待最后一块被文件描述符一侧处理完
+    if (s->to_fd) {
+        wait_slot(s, 0, false);
+        wait_slot(s, 1, false);
+    }
+}
+
+static at24c256_err_t run_stream(at24c256_handle_t handle, uint16_t address, int fd,
+                                 uint32_t length, bool to_fd) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (fd < 0 || (uint32_t)address + length > handle->config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (length == 0) {
+        return AT24C256_OK;
+    }
+
+    stream_t s = {
+        .handle = handle,
+        .fd = fd,
+        .address = address,
+        .length = length,
+        .to_fd = to_fd,
+        .error = AT24C256_OK,
+    };
+    s.buffer[0] = (uint8_t*)malloc(handle->config.page_size);
+    s.buffer[1] = (uint8_t*)malloc(handle->config.page_size);
+    if (!s.buffer[0] || !s.buffer[1]) {
+        free(s.buffer[0]);
+        free(s.buffer[1]);
+        return AT24C256_ERROR_MEMORY;
+    }
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.cond, NULL);
+
+    pthread_t thread;
+    at24c256_err_t ret = AT24C256_ERROR_MEMORY;
+    if (pthread_create(&thread, NULL, fd_side, &s) == 0) {
+        bus_side(&s);
+        pthread_join(thread, NULL);
+        ret = s.error;
+    }
+
+    pthread_cond_destroy(&s.cond);
+    pthread_mutex_destroy(&s.lock);
+    free(s.buffer[0]);
+    free(s.buffer[1]);
+    return ret;
+}
+
+at24c256_err_t at24c256_write_from_fd(at24c256_handle_t handle, uint16_t address,
+                                     int fd, uint32_t length) {
+    return run_stream(handle, address, fd, length, false);
+}
+
+at24c256_err_t at24c256_read_to_fd(at24c256_handle_t handle, uint16_t address,
+                                  int fd, uint32_t length) {
+    return run_stream(handle, address, fd, length, true);
+}
@@ -0,0 +1,205 @@
+/**
+ * @file at24c256_trace.c
+ * @brief 访问记录
+ *
+ * 记录文件格式 (小端)：
+ *   文件头 16字节
+ *     0   magic "A2TR"
+ *     4   version      (u16)
+ *     6   record_size  每条记录的字节数 (u16)
+ *     8   page_size    (u16)
+ *     10  addr_bytes   (u8)
+ *     11  保留
+ *     12  total_size   (u32)
+ *   记录 20字节
+ *     0   op           (u8)
+ *     1   result       (i8)
+ *     2   address      (u16)
+ *     4   length       (u16)
+ *     6   保留
+ *     8   start_ns     相对于记录开始 (u64)
+ *     16  duration_ns  (u32，超出时截断)
+ * 读取时按文件头中的record_size跳过新版本追加的字段。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#define TRACE_MAGIC "A2TR"
+#define TRACE_VERSION 1
+#define HEADER_SIZE 16
+#define RECORD_SIZE 20
+#define BUFFER_RECORDS 256
+
+/**
+ * @brief 记录状态
+ */
+struct at24c256_trace_s {
+    int fd;
+    uint64_t origin_ns;          /**< 开始记录的时刻 */
+    uint32_t used;               /**< 缓冲区中的记录数 */
+    bool lost;                   /**< 有记录未能写入文件 */
+    uint8_t buffer[BUFFER_RECORDS * RECORD_SIZE];
+};
+
+static bool write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * @brief 把缓冲区中的记录写入文件
+ */
+static void trace_drain(struct at24c256_trace_s* t) {
+    if (t->used > 0 && !write_all(t->fd, t->buffer, (size_t)t->used * RECORD_SIZE)) {
+        t->lost = true;
+    }
+    t->used = 0;
+}
+
+at24c256_err_t at24c256_trace_start(at24c256_handle_t handle, const char* path) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (!path || handle->trace) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    struct at24c256_trace_s* t = (struct at24c256_trace_s*)calloc(1, sizeof(*t));
+    if (!t) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    t->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (t->fd < 0) {
+        free(t);
+        return AT24C256_ERROR_INIT;
+    }
+
+    uint8_t header[HEADER_SIZE] = { 0 };
+    memcpy(header, TRACE_MAGIC, 4);
+    at24c256_put_le(header + 4, TRACE_VERSION, 2);
+    at24c256_put_le(header + 6, RECORD_SIZE, 2);
+    at24c256_put_le(header + 8, handle->config.page_size, 2);
+    header[10] = handle->config.addr_bytes;
+    at24c256_put_le(header + 12, handle->config.total_size, 4);
+    if (!write_all(t->fd, header, sizeof(header))) {
+        close(t->fd);
+        free(t);
+        return AT24C256_ERROR_WRITE;
+    }
+
+    t->origin_ns = at24c256_now_ns(handle);
+    handle->trace = t;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_trace_stop(at24c256_handle_t handle) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    struct at24c256_trace_s* t = handle->trace;
+    if (!t) {
+        return AT24C256_OK;
+    }
+
+    trace_drain(t);
+    bool lost = t->lost || close(t->fd) != 0;
+    free(t);
+    handle->trace = NULL;
+    return lost ? AT24C256_ERROR_WRITE : AT24C256_OK;
+}
+
+void at24c256_trace_record(at24c256_handle_t handle, at24c256_trace_op_t op, uint16_t address,
+                           uint16_t length, uint64_t start_ns, at24c256_err_t result) {
+    struct at24c256_trace_s* t = handle->trace;
+    uint64_t duration = at24c256_now_ns(handle) - start_ns;
+
+    uint8_t* p = &t->buffer[t->used * RECORD_SIZE];
+    p[0] = (uint8_t)op;
+    p[1] = (uint8_t)(int8_t)result;
+    at24c256_put_le(p + 2, address, 2);
+    at24c256_put_le(p + 4, length, 2);
+    at24c256_put_le(p + 6, 0, 2);
+    at24c256_put_le(p + 8, start_ns - t->origin_ns, 8);
+    at24c256_put_le(p + 16, duration > UINT32_MAX ? UINT32_MAX : duration, 4);
+
+    if (++t->used == BUFFER_RECORDS) {
+        trace_drain(t);
+    }
+}
+
+at24c256_err_t at24c256_trace_load(const char* path, at24c256_trace_info_t* info,
+                                  at24c256_trace_record_t** records, uint32_t* count) {
+    if (!path || !info || !records || !count) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return AT24C256_ERROR_READ;
+    }
+
+    uint8_t header[HEADER_SIZE] = { 0 };
+    long size = -1;
+    if (fread(header, 1, sizeof(header), fp) == sizeof(header) &&
+        fseek(fp, 0, SEEK_END) == 0) {
+        size = ftell(fp);
+    }
+    uint16_t record_size = (uint16_t)at24c256_get_le(header + 6, 2);
+    if (size < HEADER_SIZE || memcmp(header, TRACE_MAGIC, 4) != 0 || record_size < RECORD_SIZE ||
+        fseek(fp, HEADER_SIZE, SEEK_SET) != 0) {
+        fclose(fp);
+        return AT24C256_ERROR_PARAM;
+    }
+
+    // 进程在停止记录前退出时最后一条记录可能不完整，忽略之
+    uint32_t n = (uint32_t)((size - HEADER_SIZE) / record_size);
+    at24c256_trace_record_t* out = (at24c256_trace_record_t*)calloc(n ? n : 1, sizeof(*out));
+    uint8_t* raw = (uint8_t*)malloc(record_size);
+    if (!out || !raw) {
+        free(out);
+        free(raw);
+        fclose(fp);
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (fread(raw, 1, record_size, fp) != record_size) {
+            free(out);
+            free(raw);
+            fclose(fp);
+            return AT24C256_ERROR_READ;
+        }
+        out[i].op = raw[0];
+        out[i].result = (int8_t)raw[1];
+        out[i].address = (uint16_t)at24c256_get_le(raw + 2, 2);
+        out[i].length = (uint16_t)at24c256_get_le(raw + 4, 2);
+        out[i].start_ns = at24c256_get_le(raw + 8, 8);
+        out[i].duration_ns = (uint32_t)at24c256_get_le(raw + 16, 4);
+    }
+    free(raw);
+    fclose(fp);
+
+    info->page_size = (uint16_t)at24c256_get_le(header + 8, 2);
+    info->addr_bytes = header[10];
+    info->total_size = (uint32_t)at24c256_get_le(header + 12, 4);
+    *records = out;
+    *count = n;
+    return AT24C256_OK;
+}
@@ -0,0 +1,544 @@
+/**
+ * @file at24c256_ts.c
+ * @brief EEPROM时序数据存储实现
+ *
+ * 每个数据块占一页，块头16字节 (小端)：
+ *   0   seq        块序号，0xFFFFFFFF表示空块 (u32)
+ *   4   first_ts   块内第一个时间戳 (u32)
+ *   8   last_ts    块内最后一个时间戳 (u32)
+ *   12  count      采样数 (u16)
+ *   14  head_crc   块头前14字节的CRC-8
+ *   15  page_crc   除本字节外整页的CRC-8
+ * 块头之后是按位打包的采样 (高位在前)：
+ *   第一个采样：时间戳在块头中，数值32位原样保存
+ *   时间戳二阶差分 dod：'0' 为0；'10'+7位 [-63,64]；'110'+9位 [-255,256]；
+ *                      '1110'+12位 [-2047,2048]；'1111'+32位 直接保存一阶差分
+ *   数值异或 x：'0' 为0；'10'+有效位 (沿用上一个窗口)；
+ *              '11'+5位前导零+5位(有效位数-1)+有效位
+ * 打开时只读取每块的块头 (校验head_crc)，查询时读取整块并校验page_crc。
+ */
+
+#include "at24c256_ts.h"
+#include "at24c256_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_SIZE 16
+#define MIN_BLOCK_SIZE 32
+#define EMPTY_SEQ 0xFFFFFFFFu
+#define NO_SLOT 0xFFFFFFFFu
+#define NO_WINDOW 0xFF
+
+/**
+ * @brief 内存中的块索引
+ */
+typedef struct {
+    uint32_t seq;                /**< EMPTY_SEQ表示空块 */
+    uint32_t first_ts;
+    uint32_t last_ts;
+    uint16_t count;
+} block_info_t;
+
+/**
+ * @brief 块内编码/解码状态
+ */
+typedef struct {
+    uint32_t bit;                /**< 下一位在块数据区中的位置 */
+    uint32_t prev_ts;
+    uint32_t prev_delta;
+    uint32_t prev_value;         /**< 上一个值的位模式 */
+    uint8_t leading;             /**< 上一个有效位窗口，NO_WINDOW表示还没有 */
+    uint8_t trailing;
+    uint16_t count;
+} codec_t;
+
+/**
+ * @brief 时序存储
+ */
+struct at24c256_ts_s {
+    at24c256_handle_t dev;
+    uint16_t address;            /**< 区域起始地址 */
+    uint16_t block_size;         /**< 块大小 (页大小) */
+    uint32_t capacity;           /**< 块数据区的位数 */
+    uint32_t block_count;
+    block_info_t* blocks;
+    uint32_t head;               /**< 最新块的槽位，NO_SLOT表示区域为空 */
+    bool open;                   /**< 最新块仍可追加 (内容在page中) */
+    bool dirty;                  /**< page中有未编程的采样 */
+    uint32_t next_seq;
+    codec_t enc;
+    uint8_t* page;               /**< 当前块 */
+    uint8_t* scratch;            /**< 查询时读取的块 */
+};
+
+static uint8_t page_crc(const uint8_t* page, uint16_t block_size) {
+    uint8_t crc = at24c256_crc8(0, page, 15);
+    return at24c256_crc8(crc, page + HEADER_SIZE, block_size - HEADER_SIZE);
+}
+
+static bool put_bits(uint8_t* data, uint32_t capacity, uint32_t* bit, uint32_t value, int n) {
+    if (*bit + (uint32_t)n > capacity) {
+        return false;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        uint32_t pos = (*bit)++;
+        uint8_t mask = (uint8_t)(0x80 >> (pos & 7));
+        if ((value >> i) & 1) {
+            data[pos >> 3] |= mask;
+        } else {
+            data[pos >> 3] &= (uint8_t)~mask;
+        }
+    }
+    return true;
+}
+
+static bool get_bits(const uint8_t* data, uint32_t capacity, uint32_t* bit, int n,
+                     uint32_t* value) {
+    if (*bit + (uint32_t)n > capacity) {
+        return false;
+    }
+    uint32_t v = 0;
+    for (int i = 0; i < n; i++) {
+        uint32_t pos = (*bit)++;
+        v = (v << 1) | ((data[pos >> 3] >> (7 - (pos & 7))) & 1);
+    }
+    *value = v;
+    return true;
+}
+
+static uint32_t float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief 编码数值与上一个值的异或
+ */
+static bool encode_value(codec_t* c, uint8_t* data, uint32_t capacity, uint32_t bits) {
+    uint32_t x = bits ^ c->prev_value;
+    if (x == 0) {
+        return put_bits(data, capacity, &c->bit, 0, 1);
+    }
+
+    int lead = __builtin_clz(x);
+    int trail = __builtin_ctz(x);
+    if (c->leading != NO_WINDOW && lead >= c->leading && trail >= c->trailing) {
+        return put_bits(data, capacity, &c->bit, 2, 2) &&
+               put_bits(data, capacity, &c->bit, x >> c->trailing, 32 - c->leading - c->trailing);
+    }
+
+    int len = 32 - lead - trail;
+    c->leading = (uint8_t)lead;
+    c->trailing = (uint8_t)trail;
+    return put_bits(data, capacity, &c->bit, 3, 2) &&
+           put_bits(data, capacity, &c->bit, (uint32_t)lead, 5) &&
+           put_bits(data, capacity, &c->bit, (uint32_t)(len - 1), 5) &&
+           put_bits(data, capacity, &c->bit, x >> trail, len);
+}
+
+/**
+ * @brief 编码一个采样，数据区放不下时返回false且状态不变
+ */
+static bool encode_sample(codec_t* c, uint8_t* data, uint32_t capacity, uint32_t timestamp,
+                          uint32_t bits) {
+    codec_t s = *c;
+    bool ok;
+
+    if (s.count == 0) {
+        ok = put_bits(data, capacity, &s.bit, bits, 32);
+        s.prev_delta = 0;
+    } else {
+        uint32_t delta = timestamp - s.prev_ts;
+        int64_t dod = (int64_t)delta - (int64_t)s.prev_delta;
+        if (dod == 0) {
+            ok = put_bits(data, capacity, &s.bit, 0, 1);
+        } else if (dod >= -63 && dod <= 64) {
+            ok = put_bits(data, capacity, &s.bit, 2, 2) &&
+                 put_bits(data, capacity, &s.bit, (uint32_t)(dod + 63), 7);
+        } else if (dod >= -255 && dod <= 256) {
+            ok = put_bits(data, capacity, &s.bit, 6, 3) &&
+                 put_bits(data, capacity, &s.bit, (uint32_t)(dod + 255), 9);
+        } else if (dod >= -2047 && dod <= 2048) {
+            ok = put_bits(data, capacity, &s.bit, 14, 4) &&
+                 put_bits(data, capacity, &s.bit, (uint32_t)(dod + 2047), 12);
+        } else {
+            ok = put_bits(data, capacity, &s.bit, 15, 4) &&
+                 put_bits(data, capacity, &s.bit, delta, 32);
+        }
+        ok = ok && encode_value(&s, data, capacity, bits);
+        s.prev_delta = delta;
+    }
+
+    if (!ok) {
+        return false;
+    }
+    s.prev_ts = timestamp;
+    s.prev_value = bits;
+    s.count++;
+    *c = s;
+    return true;
+}
+
+/**
+ * @brief 解码下一个采样
+ */
+static bool decode_sample(codec_t* c, const uint8_t* data, uint32_t capacity,
+                          uint32_t first_ts) {
+    uint32_t v;
+
+    if (c->count == 0) {
+        if (!get_bits(data, capacity, &c->bit, 32, &v)) {
+            return false;
+        }
+        c->prev_ts = first_ts;
+        c->prev_delta = 0;
+        c->prev_value = v;
+        c->count++;
+        return true;
+    }
+
+    // 时间戳：前缀最多4位
+    uint32_t delta;
+    int prefix = 0;
+    while (prefix < 4) {
+        if (!get_bits(data, capacity, &c->bit, 1, &v)) {
+            return false;
+        }
+        if (v == 0) {
+            break;
+        }
+        prefix++;
+    }
+    static const int widths[4] = { 7, 9, 12, 0 };
+    static const int32_t biases[4] = { 63, 255, 2047, 0 };
+    if (prefix == 0) {
+        delta = c->prev_delta;
+    } else if (prefix < 4) {
+        if (!get_bits(data, capacity, &c->bit, widths[prefix - 1], &v)) {
+            return false;
+        }
+        delta = (uint32_t)((int64_t)c->prev_delta + (int64_t)v - biases[prefix - 1]);
+    } else if (!get_bits(data, capacity, &c->bit, 32, &delta)) {
+        return false;
+    }
+
+    // 数值
+    uint32_t x = 0;
+    if (!get_bits(data, capacity, &c->bit, 1, &v)) {
+        return false;
+    }
+    if (v) {
+        if (!get_bits(data, capacity, &c->bit, 1, &v)) {
+            return false;
+        }
+        if (v) {
+            uint32_t lead, len;
+            if (!get_bits(data, capacity, &c->bit, 5, &lead) ||
+                !get_bits(data, capacity, &c->bit, 5, &len) || lead + len + 1 > 32) {
+                return false;
+            }
+            c->leading = (uint8_t)lead;
+            c->trailing = (uint8_t)(32 - lead - len - 1);
+        } else if (c->leading == NO_WINDOW) {
+            return false;
+        }
+        int len = 32 - c->leading - c->trailing;
+        if (!get_bits(data, capacity, &c->bit, len, &x)) {
+            return false;
+        }
+        x <<= c->trailing;
+    }
+
+    c->prev_ts += delta;
+    c->prev_delta = delta;
+    c->prev_value ^= x;
+    c->count++;
+    return true;
+}
+
+static void reset_codec(codec_t* c) {
+    memset(c, 0, sizeof(*c));
+    c->leading = NO_WINDOW;
+}
+
+/**
+ * @brief 解码整块，输出 [from, to] 内的采样；samples为NULL时只恢复编码状态
+ */
+static bool decode_block(at24c256_ts_t ts, const uint8_t* page, const block_info_t* info,
+                         codec_t* c, uint32_t from, uint32_t to,
+                         at24c256_ts_sample_t* samples, uint32_t max, uint32_t* count) {
+    reset_codec(c);
+    const uint8_t* data = page + HEADER_SIZE;
+    while (c->count < info->count) {
+        if (!decode_sample(c, data, ts->capacity, info->first_ts)) {
+            return false;
+        }
+        if (!samples || c->prev_ts < from) {
+            continue;
+        }
+        if (c->prev_ts > to || *count >= max) {
+            break;
+        }
+        samples[*count].timestamp = c->prev_ts;
+        samples[*count].value = bits_float(c->prev_value);
+        (*count)++;
+    }
+    return true;
+}
+
+/**
+ * @brief 填写块头并把当前块编程到芯片
+ */
+static at24c256_err_t program_block(at24c256_ts_t ts) {
+    const block_info_t* info = &ts->blocks[ts->head];
+    at24c256_put_le(ts->page, info->seq, 4);
+    at24c256_put_le(ts->page + 4, info->first_ts, 4);
+    at24c256_put_le(ts->page + 8, info->last_ts, 4);
+    at24c256_put_le(ts->page + 12, info->count, 2);
+    ts->page[14] = at24c256_crc8(0, ts->page, 14);
+    ts->page[15] = page_crc(ts->page, ts->block_size);
+
+    uint16_t address = (uint16_t)(ts->address + ts->head * ts->block_size);
+    at24c256_err_t ret = at24c256_write(ts->dev, address, ts->page, ts->block_size);
+    if (ret == AT24C256_OK) {
+        ts->dirty = false;
+    }
+    return ret;
+}
+
+/**
+ * @brief 在最新块之后开始一个新块 (区域写满时覆盖最旧的块)
+ */
+static void start_block(at24c256_ts_t ts, uint32_t timestamp) {
+    ts->head = ts->head == NO_SLOT ? 0 : (ts->head + 1) % ts->block_count;
+    block_info_t* info = &ts->blocks[ts->head];
+    info->seq = ts->next_seq++;
+    info->first_ts = timestamp;
+    info->last_ts = timestamp;
+    info->count = 0;
+
+    memset(ts->page, 0, ts->block_size);
+    reset_codec(&ts->enc);
+    ts->open = true;
+    ts->dirty = false;
+}
+
+/**
+ * @brief 读取块头建立索引，并恢复最新块的编码状态
+ */
+static at24c256_err_t load_index(at24c256_ts_t ts) {
+    uint8_t header[HEADER_SIZE];
+    uint32_t newest_seq = 0;
+
+    for (uint32_t slot = 0; slot < ts->block_count; slot++) {
+        block_info_t* info = &ts->blocks[slot];
+        info->seq = EMPTY_SEQ;
+
+        uint16_t address = (uint16_t)(ts->address + slot * ts->block_size);
+        at24c256_err_t ret = at24c256_read(ts->dev, address, header, sizeof(header));
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+        uint32_t seq = (uint32_t)at24c256_get_le(header, 4);
+        uint16_t count = (uint16_t)at24c256_get_le(header + 12, 2);
+        if (seq == EMPTY_SEQ || count == 0 || at24c256_crc8(0, header, 14) != header[14]) {
+            continue;
+        }
+
+        info->seq = seq;
+        info->first_ts = (uint32_t)at24c256_get_le(header + 4, 4);
+        info->last_ts = (uint32_t)at24c256_get_le(header + 8, 4);
+        info->count = count;
+        if (ts->head == NO_SLOT || seq > newest_seq) {
+            ts->head = slot;
+            newest_seq = seq;
+        }
+    }
+
+    if (ts->head == NO_SLOT) {
+        return AT24C256_OK;
+    }
+    ts->next_seq = newest_seq + 1;
+
+    // 最新块完好时继续追加，否则下一个采样开始新块
+    uint16_t address = (uint16_t)(ts->address + ts->head * ts->block_size);
+    at24c256_err_t ret = at24c256_read(ts->dev, address, ts->page, ts->block_size);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    uint32_t unused = 0;
+    ts->open = page_crc(ts->page, ts->block_size) == ts->page[15] &&
+               decode_block(ts, ts->page, &ts->blocks[ts->head], &ts->enc, 0, 0, NULL, 0,
+                            &unused);
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_ts_open(at24c256_handle_t handle, uint16_t address, uint32_t length,
+                               at24c256_ts_t* ts) {
+    if (!handle || !ts) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_config_t config;
+    at24c256_err_t ret = at24c256_get_info(handle, &config);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    if (config.page_size < MIN_BLOCK_SIZE) {
+        return AT24C256_ERROR_UNSUPPORTED;
+    }
+    if (address % config.page_size != 0 || length % config.page_size != 0 ||
+        length < 2u * config.page_size || (uint32_t)address + length > config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_ts_t t = (at24c256_ts_t)calloc(1, sizeof(*t));
+    if (!t) {
+        return AT24C256_ERROR_MEMORY;
+    }
+    t->dev = handle;
+    t->address = address;
+    t->block_size = config.page_size;
+    t->capacity = (uint32_t)(config.page_size - HEADER_SIZE) * 8;
+    t->block_count = length / config.page_size;
+    t->head = NO_SLOT;
+    t->blocks = (block_info_t*)calloc(t->block_count, sizeof(block_info_t));
+    t->page = (uint8_t*)malloc(t->block_size);
+    t->scratch = (uint8_t*)malloc(t->block_size);
+    ret = (!t->blocks || !t->page || !t->scratch) ? AT24C256_ERROR_MEMORY : load_index(t);
+    if (ret != AT24C256_OK) {
+        free(t->blocks);
+        free(t->page);
+        free(t->scratch);
+        free(t);
+        return ret;
+    }
+
+    *ts = t;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_ts_append(at24c256_ts_t ts, uint32_t timestamp, float value) {
+    if (!ts) {
+        return AT24C256_ERROR_PARAM;
+    }
+    if (ts->head != NO_SLOT && timestamp < ts->blocks[ts->head].last_ts) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    uint32_t bits = float_bits(value);
+    uint8_t* data = ts->page + HEADER_SIZE;
+    if (!ts->open || !encode_sample(&ts->enc, data, ts->capacity, timestamp, bits)) {
+        // 当前块已满：编程后开始新块
+        if (ts->open && ts->dirty) {
+            at24c256_err_t ret = program_block(ts);
+            if (ret != AT24C256_OK) {
+                return ret;
+            }
+        }
+        start_block(ts, timestamp);
+
+        // 空块一定放得下第一个采样
+        encode_sample(&ts->enc, data, ts->capacity, timestamp, bits);
+    }
+
+    ts->blocks[ts->head].last_ts = timestamp;
+    ts->blocks[ts->head].count = ts->enc.count;
+    ts->dirty = true;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_ts_flush(at24c256_ts_t ts) {
+    if (!ts) {
+        return AT24C256_ERROR_PARAM;
+    }
+    return ts->dirty ? program_block(ts) : AT24C256_OK;
+}
+
+at24c256_err_t at24c256_ts_query(at24c256_ts_t ts, uint32_t from, uint32_t to,
+                                at24c256_ts_sample_t* samples, uint32_t max, uint32_t* count) {
+    if (!ts || !samples || !count || from > to) {
+        return AT24C256_ERROR_PARAM;
+    }
+    *count = 0;
+    if (ts->head == NO_SLOT) {
+        return AT24C256_OK;
+    }
+
+    // 从最旧的块开始按时间顺序遍历
+    uint32_t oldest = (ts->head + 1) % ts->block_count;
+    for (uint32_t i = 0; i < ts->block_count && *count < max; i++) {
+        uint32_t slot = (oldest + i) % ts->block_count;
+        const block_info_t* info = &ts->blocks[slot];
+        if (info->seq == EMPTY_SEQ || info->last_ts < from) {
+            continue;
+        }
+        if (info->first_ts > to) {
+            break;
+        }
+
+        const uint8_t* page = ts->page;
+        if (slot != ts->head || !ts->open) {
+            uint16_t address = (uint16_t)(ts->address + slot * ts->block_size);
+            at24c256_err_t ret = at24c256_read(ts->dev, address, ts->scratch, ts->block_size);
+            if (ret != AT24C256_OK) {
+                return ret;
+            }
+            if (page_crc(ts->scratch, ts->block_size) != ts->scratch[15]) {
+                continue;   // 写入中途掉电的块
+            }
+            page = ts->scratch;
+        }
+
+        codec_t c;
+        decode_block(ts, page, info, &c, from, to, samples, max, count);
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_ts_info(at24c256_ts_t ts, at24c256_ts_info_t* info) {
+    if (!ts || !info) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->block_count = ts->block_count;
+    if (ts->head == NO_SLOT) {
+        return AT24C256_OK;
+    }
+
+    uint32_t oldest = (ts->head + 1) % ts->block_count;
+    for (uint32_t i = 0; i < ts->block_count; i++) {
+        const block_info_t* b = &ts->blocks[(oldest + i) % ts->block_count];
+        if (b->seq == EMPTY_SEQ) {
+            continue;
+        }
+        if (info->blocks_used == 0) {
+            info->first_ts = b->first_ts;
+        }
+        info->blocks_used++;
+        info->samples += b->count;
+    }
+    info->last_ts = ts->blocks[ts->head].last_ts;
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_ts_close(at24c256_ts_t ts) {
+    if (!ts) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_err_t ret = at24c256_ts_flush(ts);
+    free(ts->blocks);
+    free(ts->page);
+    free(ts->scratch);
+    free(ts);
+    return ret;
+}
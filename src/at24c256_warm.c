@@ -0,0 +1,290 @@
+/**
+ * @file at24c256_warm.c
+ * @brief 由片上代数戳校验的持久化主机侧热缓存
+ *
+ * 片上代数戳 (16字节，小端)：
+ *   0   magic "A2GS"
+ *   4   generation  每个写入会话加一
+ *   8   hash        除代数戳和哈希目录外全部内容的FNV-1a哈希，0表示写入会话未完成
+ *
+ * 主机侧镜像文件为代数戳副本加完整芯片内容。初始化时只读取片上代数戳，与镜像文件
+ * 一致时直接用镜像填充页缓存，否则整片刷新并重新生成代数戳。
+ *
+ * 会话中第一次写入前先把片上hash清零再写数据；flush后写入新的hash并保存镜像。
+ * 中途掉电时片上hash保持为0，下次启动必然整片刷新。
+ */
+
+#include "at24c256.h"
+#include "at24c256_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define STAMP_SIZE 16
+#define STAMP_MAGIC "A2GS"
+#define REFRESH_CHUNK 4096   // 整片刷新时每次读取的字节数
+
+/**
+ * @brief 热缓存状态
+ */
+struct at24c256_warm_s {
+    char path[256];              /**< 主机侧镜像文件路径 */
+    uint16_t stamp_address;      /**< 片上代数戳地址 */
+    uint32_t generation;         /**< 当前代数 */
+    bool writing;                /**< 片上代数戳已标记为修改中 */
+    bool hit;                    /**< 本次初始化是否命中镜像 */
+};
+
+static void encode_stamp(uint8_t* stamp, uint32_t generation, uint64_t hash) {
+    memcpy(stamp, STAMP_MAGIC, 4);
+    at24c256_put_le(stamp + 4, generation, 4);
+    at24c256_put_le(stamp + 8, hash, 8);
+}
+
+/**
+ * @brief 计算除代数戳和哈希目录外全部内容的哈希 (结果不为0)
+ *
+ * 哈希目录在代数戳写入后还会更新，因此不计入。
+ */
+static uint64_t image_hash(at24c256_handle_t handle, const uint8_t* image, uint16_t stamp_address) {
+    at24c256_span_t holes[2] = { { stamp_address, STAMP_SIZE }, { 0, 0 } };
+    uint16_t table_address, table_length;
+    if (at24c256_hashdir_table(handle, &table_address, &table_length)) {
+        holes[1].address = table_address;
+        holes[1].length = table_length;
+    }
+    uint64_t hash = at24c256_hash64_except(image, 0, handle->config.total_size, holes, 2,
+                                           AT24C256_HASH64_SEED);
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief 写入片上代数戳并同步到缓存
+ */
+static at24c256_err_t write_stamp(at24c256_handle_t handle, uint32_t generation, uint64_t hash) {
+    uint8_t stamp[STAMP_SIZE];
+    encode_stamp(stamp, generation, hash);
+
+    at24c256_err_t ret = at24c256_raw_write(handle, handle->warm->stamp_address, stamp, STAMP_SIZE);
+    if (ret == AT24C256_OK) {
+        at24c256_cache_store(handle, handle->warm->stamp_address, stamp, STAMP_SIZE);
+    }
+    return ret;
+}
+
+/**
+ * @brief 原子地保存主机侧镜像 (先写临时文件再重命名)
+ */
+static int save_image(at24c256_handle_t handle, const uint8_t* stamp, const uint8_t* image) {
+    char tmp[sizeof(handle->warm->path) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", handle->warm->path);
+
+    FILE* file = fopen(tmp, "wb");
+    if (!file) {
+        return -1;
+    }
+    size_t total = handle->config.total_size;
+    bool ok = fwrite(stamp, 1, STAMP_SIZE, file) == STAMP_SIZE &&
+              fwrite(image, 1, total, file) == total;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp, handle->warm->path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 读取主机侧镜像
+ */
+static int load_image(at24c256_handle_t handle, uint8_t* stamp, uint8_t* image) {
+    FILE* file = fopen(handle->warm->path, "rb");
+    if (!file) {
+        return -1;
+    }
+    size_t total = handle->config.total_size;
+    bool ok = fread(stamp, 1, STAMP_SIZE, file) == STAMP_SIZE &&
+              fread(image, 1, total, file) == total &&
+              fgetc(file) == EOF;
+    fclose(file);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief 默认镜像路径：AT24C256_WARM_CACHE_DIR/<总线或节点名>-<地址>.img
+ */
+static void default_path(at24c256_handle_t handle, char* path, size_t size) {
+    const char* source = handle->config.nvmem_path ? handle->config.nvmem_path
+                                                   : handle->config.i2c_bus;
+    char name[128];
+    size_t n = 0;
+    for (const char* p = source; *p && n < sizeof(name) - 1; p++) {
+        name[n++] = (*p == '/') ? '_' : *p;
+    }
+    name[n] = '\0';
+
+    mkdir(AT24C256_WARM_CACHE_DIR, 0755);
+    snprintf(path, size, "%s/%s-%02x.img", AT24C256_WARM_CACHE_DIR, name,
+             handle->config.device_addr);
+}
+
+/**
+ * @brief 整片刷新
+ */
+static at24c256_err_t refresh(at24c256_handle_t handle, uint8_t* image) {
+    uint32_t total = handle->config.total_size;
+    for (uint32_t addr = 0; addr < total; addr += REFRESH_CHUNK) {
+        uint32_t len = total - addr < REFRESH_CHUNK ? total - addr : REFRESH_CHUNK;
+        at24c256_err_t ret = at24c256_raw_read(handle, (uint16_t)addr, image + addr, (uint16_t)len);
+        if (ret != AT24C256_OK) {
+            return ret;
+        }
+    }
+    return AT24C256_OK;
+}
+
+at24c256_err_t at24c256_warm_cache_enable(at24c256_handle_t handle, const char* cache_path,
+                                         uint16_t stamp_address) {
+    if (!handle || !handle->initialized) {
+        return AT24C256_ERROR_INIT;
+    }
+    if (handle->warm) {
+        return AT24C256_OK;
+    }
+    if (stamp_address == AT24C256_WARM_STAMP_AT_END) {
+        stamp_address = (uint16_t)(handle->config.total_size - STAMP_SIZE);
+    }
+    if ((uint32_t)stamp_address + STAMP_SIZE > handle->config.total_size ||
+        (cache_path && strlen(cache_path) >= sizeof(handle->warm->path))) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    struct at24c256_warm_s* w = (struct at24c256_warm_s*)calloc(1, sizeof(*w));
+    uint8_t* image = (uint8_t*)malloc(handle->config.total_size);
+    if (!w || !image) {
+        free(w);
+        free(image);
+        return AT24C256_ERROR_MEMORY;
+    }
+
+    at24c256_err_t ret = AT24C256_OK;
+    if (!handle->cache) {
+        ret = at24c256_cache_enable(handle, AT24C256_CACHE_WRITE_THROUGH);
+    } else {
+        // 缓存中的脏数据必须先落到芯片，否则镜像与代数戳对不上
+        ret = at24c256_flush(handle);
+    }
+    if (ret != AT24C256_OK) {
+        free(w);
+        free(image);
+        return ret;
+    }
+
+    w->stamp_address = stamp_address;
+    if (cache_path) {
+        strcpy(w->path, cache_path);
+    }
+    handle->warm = w;
+    if (!cache_path) {
+        default_path(handle, w->path, sizeof(w->path));
+    }
+
+    // 只读取16字节代数戳
+    uint8_t chip_stamp[STAMP_SIZE];
+    uint8_t file_stamp[STAMP_SIZE];
+    ret = at24c256_raw_read(handle, stamp_address, chip_stamp, STAMP_SIZE);
+    if (ret != AT24C256_OK) {
+        goto fail;
+    }
+
+    bool chip_valid = memcmp(chip_stamp, STAMP_MAGIC, 4) == 0 &&
+                      at24c256_get_le(chip_stamp + 8, 8) != 0;
+    w->generation = memcmp(chip_stamp, STAMP_MAGIC, 4) == 0 ?
+                    (uint32_t)at24c256_get_le(chip_stamp + 4, 4) : 0;
+
+    if (chip_valid && load_image(handle, file_stamp, image) == 0 &&
+        memcmp(file_stamp, chip_stamp, STAMP_SIZE) == 0 &&
+        image_hash(handle, image, stamp_address) == at24c256_get_le(chip_stamp + 8, 8)) {
+        // 命中：所有读取直接由镜像提供
+        memcpy(image + stamp_address, chip_stamp, STAMP_SIZE);
+        at24c256_cache_fill(handle, image);
+        w->hit = true;
+        free(image);
+        return AT24C256_OK;
+    }
+
+    // 未命中：整片刷新，必要时重新生成代数戳
+    ret = refresh(handle, image);
+    if (ret != AT24C256_OK) {
+        goto fail;
+    }
+    at24c256_cache_fill(handle, image);
+
+    uint64_t hash = image_hash(handle, image, stamp_address);
+    if (!chip_valid || at24c256_get_le(chip_stamp + 8, 8) != hash) {
+        w->generation++;
+        ret = write_stamp(handle, w->generation, hash);
+        if (ret != AT24C256_OK) {
+            goto fail;
+        }
+    }
+    encode_stamp(chip_stamp, w->generation, hash);
+    save_image(handle, chip_stamp, at24c256_cache_image(handle));
+
+    free(image);
+    return AT24C256_OK;
+
+fail:
+    handle->warm = NULL;
+    free(w);
+    free(image);
+    return ret;
+}
+
+bool at24c256_warm_cache_hit(at24c256_handle_t handle) {
+    return handle && handle->warm && handle->warm->hit;
+}
+
+at24c256_err_t at24c256_warm_begin_write(at24c256_handle_t handle) {
+    struct at24c256_warm_s* w = handle->warm;
+    if (w->writing) {
+        return AT24C256_OK;
+    }
+
+    // 数据写入芯片前先声明新一代的修改会话
+    w->generation++;
+    at24c256_err_t ret = write_stamp(handle, w->generation, 0);
+    if (ret == AT24C256_OK) {
+        w->writing = true;
+    }
+    return ret;
+}
+
+at24c256_err_t at24c256_warm_commit(at24c256_handle_t handle) {
+    struct at24c256_warm_s* w = handle->warm;
+    if (!w->writing) {
+        return AT24C256_OK;
+    }
+
+    const uint8_t* image = at24c256_cache_image(handle);
+    uint64_t hash = image_hash(handle, image, w->stamp_address);
+    at24c256_err_t ret = write_stamp(handle, w->generation, hash);
+    if (ret != AT24C256_OK) {
+        return ret;
+    }
+    w->writing = false;
+
+    uint8_t stamp[STAMP_SIZE];
+    encode_stamp(stamp, w->generation, hash);
+    save_image(handle, stamp, image);
+    return AT24C256_OK;
+}
+
+void at24c256_warm_free(at24c256_handle_t handle) {
+    free(handle->warm);
+    handle->warm = NULL;
+}
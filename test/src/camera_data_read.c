@@ -10,37 +10,24 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <dirent.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include "at24c256.h"
+#include "at24c256_schema.h"
 
 #define EEPROM_START_ADDRESS 0x0000
 #define MAX_FILE_SIZE (32 * 1024)  // 最大文件大小32KB
-#define MAX_FILENAME_LENGTH 64
+#define MAX_FILENAME_LENGTH AT24C256_FILE_NAME_MAX
 #define MAX_FILES 16
 
 /**
- * @brief 文件索引结构
+ * @brief 片上索引格式 (紧凑小端，见at24c256_schema.h)
  */
-typedef struct {
-    char filename[MAX_FILENAME_LENGTH];
-    uint16_t address;
-    uint16_t size;
-    uint8_t checksum;
-} file_index_t;
-
-/**
- * @brief 文件索引头
- */
-typedef struct {
-    uint8_t magic[4];  // "CAM\0"
-    uint8_t version;
-    uint8_t file_count;
-    uint16_t total_size;
-    uint8_t reserved[8];
-} index_header_t;
+typedef at24c256_file_index_t file_index_t;
+typedef at24c256_index_header_t index_header_t;
 
 /**
  * @brief 创建目录（如果不存在）
@@ -70,92 +57,100 @@ static uint8_t calculate_checksum(const uint8_t* data, size_t size) {
 
 /**
  * @brief 从EEPROM读取文件索引
+ *
+ * 一次读取索引头与全部索引项后解码；版本1的索引项按内存布局保存，间距为70字节。
  */
 static int read_file_index(at24c256_handle_t handle, file_index_t* files, int* file_count) {
+    uint8_t index_area[AT24C256_INDEX_HEADER_SIZE + MAX_FILES * AT24C256_FILE_INDEX_V1_STRIDE];
     index_header_t header;
     
-    // 读取索引头
-    at24c256_err_t ret = at24c256_read(handle, EEPROM_START_ADDRESS, (uint8_t*)&header, sizeof(header));
+    at24c256_err_t ret = at24c256_read(handle, EEPROM_START_ADDRESS, index_area, sizeof(index_area));
     if (ret != AT24C256_OK) {
-        printf("读取索引头失败: %s\n", at24c256_strerror(ret));
+        printf("读取文件索引失败: %s\n", at24c256_strerror(ret));
         return -1;
     }
+    at24c256_index_header_decode(&header, index_area);
     
     // 验证魔术字
-    if (memcmp(header.magic, "CAM\0", 4) != 0) {
+    if (memcmp(header.magic, AT24C256_INDEX_MAGIC, 4) != 0) {
         printf("无效的索引格式 (魔术字不匹配)\n");
         return -1;
     }
     
     printf("索引版本: %d, 文件数量: %d\n", header.version, header.file_count);
     
+    if (header.version != 1 && header.version != AT24C256_INDEX_VERSION) {
+        printf("不支持的索引版本: %d\n", header.version);
+        return -1;
+    }
     if (header.file_count > MAX_FILES) {
         printf("文件数量超出限制: %d > %d\n", header.file_count, MAX_FILES);
         return -1;
     }
     
-    // 读取文件索引
-    uint16_t index_address = EEPROM_START_ADDRESS + sizeof(header);
+    // 解码文件索引
+    size_t stride = header.version == 1 ? AT24C256_FILE_INDEX_V1_STRIDE : AT24C256_FILE_INDEX_SIZE;
     for (int i = 0; i < header.file_count; i++) {
-        ret = at24c256_read(handle, index_address, (uint8_t*)&files[i], sizeof(file_index_t));
-        if (ret != AT24C256_OK) {
-            printf("读取文件索引 %d 失败: %s\n", i, at24c256_strerror(ret));
-            return -1;
-        }
-        index_address += sizeof(file_index_t);
+        at24c256_file_index_decode(&files[i], index_area + AT24C256_INDEX_HEADER_SIZE + i * stride);
+        files[i].filename[MAX_FILENAME_LENGTH - 1] = '\0';
     }
     
     *file_count = header.file_count;
     return 0;
 }
 
+/**
+ * @brief 分块计算文件的校验和
+ */
+static int calculate_file_checksum(int fd, long size, uint8_t* checksum) {
+    uint8_t chunk[256];
+    *checksum = 0;
+    for (long offset = 0; offset < size; ) {
+        size_t want = (size - offset) < (long)sizeof(chunk) ? (size_t)(size - offset) : sizeof(chunk);
+        ssize_t n = pread(fd, chunk, want, offset);
+        if (n <= 0) {
+            return -1;
+        }
+        *checksum ^= calculate_checksum(chunk, (size_t)n);
+        offset += n;
+    }
+    return 0;
+}
+
 /**
  * @brief 从EEPROM读取文件并保存
+ *
+ * 文件内容经at24c256_read_to_fd直接流式写入输出文件，校验失败时删除输出文件。
  */
 static int read_file_from_eeprom(at24c256_handle_t handle, const file_index_t* file_info,
                                 const char* output_dir) {
     char output_path[512];
     snprintf(output_path, sizeof(output_path), "%s/%s", output_dir, file_info->filename);
     
-    // 从EEPROM读取数据
-    uint8_t* buffer = (uint8_t*)malloc(file_info->size);
-    if (!buffer) {
-        printf("内存分配失败\n");
+    int fd = open(output_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("无法创建输出文件: %s\n", output_path);
         return -1;
     }
     
     printf("从EEPROM读取文件: %s (大小: %d bytes, 地址: 0x%04X)\n", 
            file_info->filename, file_info->size, file_info->address);
     
-    at24c256_err_t ret = at24c256_read(handle, file_info->address, buffer, file_info->size);
+    at24c256_err_t ret = at24c256_read_to_fd(handle, file_info->address, fd, file_info->size);
     if (ret != AT24C256_OK) {
         printf("EEPROM读取失败: %s\n", at24c256_strerror(ret));
-        free(buffer);
+        close(fd);
+        unlink(output_path);
         return -1;
     }
     
     // 验证校验和
-    uint8_t checksum = calculate_checksum(buffer, file_info->size);
-    if (checksum != file_info->checksum) {
+    uint8_t checksum = 0;
+    int result = calculate_file_checksum(fd, file_info->size, &checksum);
+    close(fd);
+    if (result != 0 || checksum != file_info->checksum) {
         printf("校验和验证失败: 期望 0x%02X, 实际 0x%02X\n", file_info->checksum, checksum);
-        free(buffer);
-        return -1;
-    }
-    
-    // 写入输出文件
-    FILE* file = fopen(output_path, "wb");
-    if (!file) {
-        printf("无法创建输出文件: %s\n", output_path);
-        free(buffer);
-        return -1;
-    }
-    
-    size_t bytes_written = fwrite(buffer, 1, file_info->size, file);
-    fclose(file);
-    free(buffer);
-    
-    if (bytes_written != (size_t)file_info->size) {
-        printf("写入输出文件失败: %s\n", output_path);
+        unlink(output_path);
         return -1;
     }
     
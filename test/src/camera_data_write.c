@@ -16,47 +16,24 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <dirent.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include "at24c256.h"
+#include "at24c256_schema.h"
 
 #define EEPROM_START_ADDRESS 0x0000
 #define MAX_FILE_SIZE (32 * 1024)  // 最大文件大小32KB
-#define MAX_FILENAME_LENGTH 64
+#define MAX_FILENAME_LENGTH AT24C256_FILE_NAME_MAX
 #define MAX_FILES 16
 
 /**
- * @brief 文件索引结构
+ * @brief 片上索引格式 (紧凑小端，见at24c256_schema.h)
  */
-typedef struct {
-    char filename[MAX_FILENAME_LENGTH];
-    uint16_t address;
-    uint16_t size;
-    uint8_t checksum;
-} file_index_t;
-
-/**
- * @brief 文件索引头
- */
-typedef struct {
-    uint8_t magic[4];  // "CAM\0"
-    uint8_t version;
-    uint8_t file_count;
-    uint16_t total_size;
-    uint8_t reserved[8];
-} index_header_t;
-
-/**
- * @brief 获取文件大小
- */
-static long get_file_size(FILE* file) {
-    fseek(file, 0, SEEK_END);
-    long size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    return size;
-}
+typedef at24c256_file_index_t file_index_t;
+typedef at24c256_index_header_t index_header_t;
 
 /**
  * @brief 计算数据的校验和
@@ -69,38 +46,47 @@ static uint8_t calculate_checksum(const uint8_t* data, size_t size) {
     return checksum;
 }
 
+/**
+ * @brief 分块计算文件的校验和
+ */
+static int calculate_file_checksum(int fd, long size, uint8_t* checksum) {
+    uint8_t chunk[256];
+    *checksum = 0;
+    for (long offset = 0; offset < size; ) {
+        size_t want = (size - offset) < (long)sizeof(chunk) ? (size_t)(size - offset) : sizeof(chunk);
+        ssize_t n = pread(fd, chunk, want, offset);
+        if (n <= 0) {
+            return -1;
+        }
+        *checksum ^= calculate_checksum(chunk, (size_t)n);
+        offset += n;
+    }
+    return 0;
+}
+
 /**
  * @brief 写入单个文件到EEPROM
+ *
+ * 文件内容经at24c256_write_from_fd流式写入，不需要整块缓冲区。
  */
 static int write_file_to_eeprom(at24c256_handle_t handle, const char* filename, 
                                uint16_t address, file_index_t* file_info) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
         printf("无法打开文件: %s\n", filename);
         return -1;
     }
     
-    long file_size = get_file_size(file);
-    if (file_size > MAX_FILE_SIZE) {
-        printf("文件 %s 太大 (%ld bytes > %d bytes)\n", filename, file_size, MAX_FILE_SIZE);
-        fclose(file);
-        return -1;
-    }
-    
-    // 读取文件内容
-    uint8_t* buffer = (uint8_t*)malloc(file_size);
-    if (!buffer) {
-        printf("内存分配失败\n");
-        fclose(file);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        printf("读取文件 %s 失败\n", filename);
+        close(fd);
         return -1;
     }
-    
-    size_t bytes_read = fread(buffer, 1, file_size, file);
-    fclose(file);
-    
-    if (bytes_read != (size_t)file_size) {
-        printf("读取文件 %s 失败\n", filename);
-        free(buffer);
+    long file_size = (long)st.st_size;
+    if (file_size > MAX_FILE_SIZE) {
+        printf("文件 %s 太大 (%ld bytes > %d bytes)\n", filename, file_size, MAX_FILE_SIZE);
+        close(fd);
         return -1;
     }
     
@@ -108,10 +94,10 @@ static int write_file_to_eeprom(at24c256_handle_t handle, const char* filename,
     printf("写入文件到EEPROM: %s (大小: %ld bytes, 地址: 0x%04X)\n", 
            filename, file_size, address);
     
-    at24c256_err_t ret = at24c256_write(handle, address, buffer, file_size);
+    at24c256_err_t ret = at24c256_write_from_fd(handle, address, fd, (uint32_t)file_size);
     if (ret != AT24C256_OK) {
         printf("EEPROM写入失败: %s\n", at24c256_strerror(ret));
-        free(buffer);
+        close(fd);
         return -1;
     }
     
@@ -124,10 +110,13 @@ static int write_file_to_eeprom(at24c256_handle_t handle, const char* filename,
     file_info->filename[MAX_FILENAME_LENGTH - 1] = '\0';
     file_info->address = address;
     file_info->size = file_size;
-    file_info->checksum = calculate_checksum(buffer, file_size);
     
-    free(buffer);
-    return 0;
+    int result = calculate_file_checksum(fd, file_size, &file_info->checksum);
+    close(fd);
+    if (result != 0) {
+        printf("读取文件 %s 失败\n", filename);
+    }
+    return result;
 }
 
 /**
@@ -142,7 +131,8 @@ static int process_camera_parameters(at24c256_handle_t handle, const char* input
     }
     
     struct dirent* entry;
-    uint16_t current_address = EEPROM_START_ADDRESS + sizeof(index_header_t) + (MAX_FILES * sizeof(file_index_t));
+    uint16_t current_address = EEPROM_START_ADDRESS + AT24C256_INDEX_HEADER_SIZE +
+                              MAX_FILES * AT24C256_FILE_INDEX_SIZE;
     *file_count = 0;
     
     printf("\n=== 开始写入相机参数文件到EEPROM ===\n");
@@ -185,42 +175,37 @@ static int process_camera_parameters(at24c256_handle_t handle, const char* input
 
 /**
  * @brief 写入文件索引到EEPROM
+ *
+ * 索引头与索引项编码为紧凑格式后一次写入。
  */
 static int write_file_index(at24c256_handle_t handle, const file_index_t* files, int file_count) {
+    uint8_t index_area[AT24C256_INDEX_HEADER_SIZE + MAX_FILES * AT24C256_FILE_INDEX_SIZE];
     index_header_t header;
     
     // 填充索引头
-    memcpy(header.magic, "CAM\0", 4);
-    header.version = 1;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, AT24C256_INDEX_MAGIC, 4);
+    header.version = AT24C256_INDEX_VERSION;
     header.file_count = file_count;
-    header.total_size = 0;
-    memset(header.reserved, 0, sizeof(header.reserved));
     
-    // 计算总大小
+    // 计算总大小并编码索引项
     for (int i = 0; i < file_count; i++) {
         header.total_size += files[i].size;
+        at24c256_file_index_encode(&files[i], index_area + AT24C256_INDEX_HEADER_SIZE + i * AT24C256_FILE_INDEX_SIZE);
     }
+    at24c256_index_header_encode(&header, index_area);
     
     printf("\n=== 写入文件索引 ===\n");
     printf("文件数量: %d, 总大小: %d bytes\n", file_count, header.total_size);
     
-    // 写入索引头
-    at24c256_err_t ret = at24c256_write(handle, EEPROM_START_ADDRESS, (uint8_t*)&header, sizeof(header));
+    uint16_t length = AT24C256_INDEX_HEADER_SIZE + file_count * AT24C256_FILE_INDEX_SIZE;
+    at24c256_err_t ret = at24c256_write(handle, EEPROM_START_ADDRESS, index_area, length);
     if (ret != AT24C256_OK) {
-        printf("写入索引头失败: %s\n", at24c256_strerror(ret));
+        printf("写入文件索引失败: %s\n", at24c256_strerror(ret));
         return -1;
     }
     
-    // 写入文件索引
-    uint16_t index_address = EEPROM_START_ADDRESS + sizeof(header);
     for (int i = 0; i < file_count; i++) {
-        ret = at24c256_write(handle, index_address, (uint8_t*)&files[i], sizeof(file_index_t));
-        if (ret != AT24C256_OK) {
-            printf("写入文件索引 %d 失败: %s\n", i, at24c256_strerror(ret));
-            return -1;
-        }
-        index_address += sizeof(file_index_t);
-        
         printf("索引 %d: %s (地址: 0x%04X, 大小: %d, 校验和: 0x%02X)\n", 
                i, files[i].filename, files[i].address, files[i].size, files[i].checksum);
     }
@@ -338,8 +323,8 @@ int main(int argc, char* argv[]) {
         printf("\n=== 写入完成 ===\n");
         printf("总共写入文件数: %d\n", file_count);
         printf("EEPROM使用地址范围: 0x%04X - 0x%04X\n",
-               EEPROM_START_ADDRESS, (uint16_t)(EEPROM_START_ADDRESS + sizeof(index_header_t) +
-               (file_count * sizeof(file_index_t)) + files[file_count - 1].size - 1));
+               EEPROM_START_ADDRESS, (uint16_t)(EEPROM_START_ADDRESS + AT24C256_INDEX_HEADER_SIZE +
+               (file_count * AT24C256_FILE_INDEX_SIZE) + files[file_count - 1].size - 1));
     }
     
     // 清理资源
@@ -0,0 +1,138 @@
+/**
+ * @file coroutine_test.cpp
+ * @brief C++20协程封装测试程序
+ *
+ * 用普通文件充当nvmem节点，在单线程上同时挂起大量协程，由poll循环驱动全部完成。
+ * 无需硬件。
+ */
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include "at24c256.hpp"
+
+#define EEPROM_SIZE 32768
+#define TASK_COUNT 200
+#define BLOCK_SIZE 64
+
+static int g_failures = 0;
+
+#define CHECK(cond, msg) do { \
+    if (cond) { \
+        printf("✓ %s\n", msg); \
+    } else { \
+        printf("✗ %s\n", msg); \
+        g_failures++; \
+    } \
+} while (0)
+
+/**
+ * @brief 写入一块后读回比较
+ */
+static at24c256::task<bool> write_then_verify(at24c256::device& dev, int index) {
+    std::array<uint8_t, BLOCK_SIZE> data;
+    std::array<uint8_t, BLOCK_SIZE> back{};
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        data[i] = static_cast<uint8_t>(index * 31 + i);
+    }
+
+    uint16_t address = static_cast<uint16_t>(index * BLOCK_SIZE);
+    if (co_await dev.write(address, data) != AT24C256_OK) {
+        co_return false;
+    }
+    if (co_await dev.read(address, back) != AT24C256_OK) {
+        co_return false;
+    }
+    co_return data == back;
+}
+
+/**
+ * @brief 等待子任务 (验证协程之间的co_await)
+ */
+static at24c256::task<void> run(at24c256::device& dev, int index, int* passed) {
+    // GCC 12在if条件中co_await临时task时生成的代码有误，先保存结果
+    bool ok = co_await write_then_verify(dev, index);
+    if (ok) {
+        (*passed)++;
+    }
+}
+
+/**
+ * @brief 读取一次并返回错误码 (参数保存在协程帧中，不引用调用者的临时对象)
+ */
+static at24c256::task<at24c256_err_t> read_once(at24c256::device& dev, uint16_t address,
+                                                std::span<uint8_t> buffer) {
+    co_return co_await dev.read(address, buffer);
+}
+
+/**
+ * @brief 主函数
+ */
+int main() {
+    printf("C++20协程封装测试程序\n");
+    printf("====================\n");
+
+    char path[] = "/tmp/at24c256_coro_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        printf("无法创建nvmem测试文件\n");
+        return EXIT_FAILURE;
+    }
+    std::vector<uint8_t> blank(EEPROM_SIZE, 0xFF);
+    bool created = write(fd, blank.data(), blank.size()) == static_cast<ssize_t>(blank.size());
+    close(fd);
+    if (!created) {
+        unlink(path);
+        printf("无法创建nvmem测试文件\n");
+        return EXIT_FAILURE;
+    }
+
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    config.nvmem_path = path;
+
+    {
+        at24c256::device dev(config);
+        CHECK(static_cast<bool>(dev), "打开设备");
+
+        at24c256::device moved = std::move(dev);
+        CHECK(!dev && static_cast<bool>(moved), "移动设备句柄");
+
+        int passed = 0;
+        std::vector<at24c256::task<void>> tasks;
+        for (int i = 0; i < TASK_COUNT; i++) {
+            tasks.push_back(run(moved, i, &passed));
+            tasks.back().start();
+        }
+        CHECK(moved.pending() == TASK_COUNT, "所有协程挂起在写入上");
+
+        struct pollfd pfd = { moved.fd(), POLLIN, 0 };
+        while (moved.pending() > 0 && poll(&pfd, 1, 1000) > 0) {
+            moved.poll();
+        }
+
+        bool all_done = true;
+        for (auto& t : tasks) {
+            all_done &= t.done();
+        }
+        CHECK(all_done && passed == TASK_COUNT, "所有协程完成且读回一致");
+
+        std::array<uint8_t, 4> empty{};
+        auto bad = read_once(moved, EEPROM_SIZE - 2, empty);
+        bad.start();
+        CHECK(bad.done() && bad.result() == AT24C256_ERROR_PARAM, "提交失败时不挂起");
+    }
+
+    unlink(path);
+
+    printf("\n=== 测试结果 ===\n");
+    if (g_failures == 0) {
+        printf("✓ 所有测试通过！\n");
+        return EXIT_SUCCESS;
+    }
+    printf("✗ %d 项测试失败！\n", g_failures);
+    return EXIT_FAILURE;
+}
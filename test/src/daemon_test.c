@@ -0,0 +1,374 @@
+/**
+ * @file daemon_test.c
+ * @brief at24c256d守护进程与客户端库测试程序
+ *
+ * 以普通文件充当nvmem节点启动at24c256d，验证客户端库的读写擦除、共享内存镜像的
+ * 顺序锁读取 (并发写入时读不到撕裂的内容)，以及一个只发送半个请求就停住的客户端
+ * 不会阻塞其他客户端、并在超时后被断开。无需硬件。
+ *
+ * 使用说明：
+ *   at24c256_daemon_test <at24c256d路径>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "at24c256.h"
+#include "at24c256_client.h"
+
+#define EEPROM_SIZE 32768
+#define WORKERS 4
+#define WORKER_ROUNDS 100
+#define TEAR_PAGE 0x7000
+#define TEAR_ROUNDS 200
+
+static int g_failures = 0;
+
+#define CHECK(cond, msg) do { \
+    if (cond) { \
+        printf("✓ %s\n", msg); \
+    } else { \
+        printf("✗ %s\n", msg); \
+        g_failures++; \
+    } \
+} while (0)
+
+static char g_socket[108];
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/**
+ * @brief 创建充当nvmem节点的文件 (内容全为0xFF)
+ */
+static int create_nvmem_file(char* path) {
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return -1;
+    }
+    uint8_t blank[EEPROM_SIZE];
+    memset(blank, 0xFF, sizeof(blank));
+    ssize_t n = write(fd, blank, sizeof(blank));
+    close(fd);
+    return n == (ssize_t)sizeof(blank) ? 0 : -1;
+}
+
+/**
+ * @brief 用原始套接字连接守护进程 (不经过客户端库)
+ */
+static int raw_connect(void) {
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, g_socket);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief 启动守护进程并等待套接字可连接
+ */
+static pid_t start_daemon(const char* daemon, const char* node, const char* shm_name) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+        }
+        execl(daemon, daemon, "-n", node, "-s", g_socket, "-m", shm_name, (char*)NULL);
+        _exit(127);
+    }
+    if (pid < 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < 500; i++) {
+        int fd = raw_connect();
+        if (fd >= 0) {
+            close(fd);
+            return pid;
+        }
+        usleep(10000);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    return -1;
+}
+
+/**
+ * @brief 套接字与共享内存镜像只对本用户开放
+ */
+static void permission_test(const char* shm_name) {
+    printf("\n=== 权限测试 ===\n");
+
+    struct stat st_sock;
+    struct stat st_shm;
+    int fd = shm_open(shm_name, O_RDONLY, 0);
+    CHECK(stat(g_socket, &st_sock) == 0 && (st_sock.st_mode & 0777) == 0600, "套接字权限为0600");
+    CHECK(fd >= 0 && fstat(fd, &st_shm) == 0 && (st_shm.st_mode & 0777) == 0600,
+          "共享内存镜像权限为0600");
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+/**
+ * @brief 基本读写擦除
+ */
+static void basic_test(const char* node) {
+    printf("\n=== 客户端读写测试 ===\n");
+
+    at24c256_client_t client;
+    uint8_t data[200];
+    uint8_t back[200];
+    const uint8_t* ptr = NULL;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 11 + 1);
+    }
+
+    CHECK(at24c256_client_connect(g_socket, &client) == AT24C256_OK, "连接守护进程");
+    CHECK(at24c256_client_write(client, 0x0130, data, sizeof(data)) == AT24C256_OK, "跨页写入");
+    CHECK(at24c256_client_read(client, 0x0130, back, sizeof(back)) == AT24C256_OK &&
+          memcmp(back, data, sizeof(data)) == 0, "从共享镜像读回");
+    CHECK(at24c256_client_read_ptr(client, 0x0130, sizeof(data), &ptr) == AT24C256_OK &&
+          memcmp(ptr, data, sizeof(data)) == 0, "零拷贝读取");
+    CHECK(at24c256_client_erase(client, 0x0140, 16) == AT24C256_OK &&
+          at24c256_client_read(client, 0x0130, back, 48) == AT24C256_OK &&
+          memcmp(back, data, 16) == 0 && back[16] == 0xFF && back[31] == 0xFF &&
+          memcmp(back + 32, data + 32, 16) == 0, "擦除");
+    CHECK(at24c256_client_read(client, 0x7FF0, back, 32) == AT24C256_ERROR_PARAM, "拒绝越界读取");
+
+    int fd = open(node, O_RDONLY);
+    CHECK(fd >= 0 && pread(fd, back, sizeof(back), 0x0130) == (ssize_t)sizeof(back) &&
+          memcmp(back, data, 16) == 0 && back[16] == 0xFF &&
+          memcmp(back + 32, data + 32, sizeof(data) - 32) == 0, "节点内容一致");
+    if (fd >= 0) {
+        close(fd);
+    }
+    at24c256_client_close(client);
+}
+
+/**
+ * @brief 并发工作线程：连接后在各自的区域写入并读回，记录最长的单次延迟 (含连接)
+ */
+typedef struct {
+    int id;
+    bool ok;
+    uint64_t max_latency_ms;
+} worker_t;
+
+static void* worker(void* arg) {
+    worker_t* w = (worker_t*)arg;
+    at24c256_client_t client;
+    uint64_t start = now_ms();
+    w->ok = at24c256_client_connect(g_socket, &client) == AT24C256_OK;
+    w->max_latency_ms = now_ms() - start;
+    if (!w->ok) {
+        return NULL;
+    }
+
+    uint16_t base = (uint16_t)(0x1000 + w->id * 0x400);
+    uint8_t data[48];
+    uint8_t back[48];
+    for (int round = 0; round < WORKER_ROUNDS && w->ok; round++) {
+        memset(data, (uint8_t)(w->id * 64 + round), sizeof(data));
+        uint16_t address = (uint16_t)(base + (round % 16) * sizeof(data));
+        start = now_ms();
+        w->ok = at24c256_client_write(client, address, data, sizeof(data)) == AT24C256_OK &&
+                at24c256_client_read(client, address, back, sizeof(back)) == AT24C256_OK &&
+                memcmp(back, data, sizeof(data)) == 0;
+        uint64_t latency = now_ms() - start;
+        if (latency > w->max_latency_ms) {
+            w->max_latency_ms = latency;
+        }
+    }
+    at24c256_client_close(client);
+    return NULL;
+}
+
+/**
+ * @brief 停住的客户端：每200ms发送请求头的一个字节
+ */
+static void* trickler(void* arg) {
+    int fd = *(int*)arg;
+    uint8_t header[16];
+    memset(header, 0, sizeof(header));
+    for (size_t i = 0; i < sizeof(header) - 1; i++) {
+        if (send(fd, &header[i], 1, MSG_NOSIGNAL) != 1) {
+            break;
+        }
+        usleep(200000);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 并发客户端与一个停住的客户端
+ */
+static void concurrency_test(void) {
+    printf("\n=== 并发客户端测试 ===\n");
+
+    int stalled = raw_connect();
+    CHECK(stalled >= 0, "停住的客户端连接");
+    pthread_t trickle;
+    bool trickling = stalled >= 0 && pthread_create(&trickle, NULL, trickler, &stalled) == 0;
+    usleep(50000);
+
+    pthread_t threads[WORKERS];
+    worker_t workers[WORKERS];
+    uint64_t start = now_ms();
+    for (int i = 0; i < WORKERS; i++) {
+        workers[i] = (worker_t){ .id = i };
+        pthread_create(&threads[i], NULL, worker, &workers[i]);
+    }
+    bool ok = true;
+    uint64_t max_latency = 0;
+    for (int i = 0; i < WORKERS; i++) {
+        pthread_join(threads[i], NULL);
+        ok = ok && workers[i].ok;
+        if (workers[i].max_latency_ms > max_latency) {
+            max_latency = workers[i].max_latency_ms;
+        }
+    }
+    uint64_t elapsed = now_ms() - start;
+    printf("  %d个客户端各%d轮，用时%llums，最长单次%llums\n", WORKERS, WORKER_ROUNDS,
+           (unsigned long long)elapsed, (unsigned long long)max_latency);
+    CHECK(ok, "各客户端读回自己写入的内容");
+    // 停住的客户端每200ms发送一个字节，共约3秒；阻塞式接收会让其他客户端等到它发完
+    CHECK(max_latency < 500 && elapsed < 1000, "不被停住的客户端阻塞");
+
+    // 不完整的请求超时后守护进程断开该连接 (先收到欢迎消息，之后是EOF)
+    if (stalled >= 0) {
+        uint8_t buf[128];
+        bool closed = false;
+        uint64_t deadline = now_ms() + 5000;
+        struct pollfd pfd = { .fd = stalled, .events = POLLIN };
+        while (!closed && now_ms() < deadline && poll(&pfd, 1, 100) >= 0) {
+            if (pfd.revents) {
+                ssize_t n = recv(stalled, buf, sizeof(buf), MSG_DONTWAIT);
+                closed = n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR);
+            }
+        }
+        CHECK(closed, "不完整的请求超时后断开");
+    }
+    if (trickling) {
+        pthread_join(trickle, NULL);
+    }
+    if (stalled >= 0) {
+        close(stalled);
+    }
+}
+
+/**
+ * @brief 顺序锁：一个客户端反复整页写入同一字节，另一个并发读取，读到的页必须一致
+ */
+static atomic_bool g_tear_stop;
+
+static void* tear_writer(void* arg) {
+    at24c256_client_t client = (at24c256_client_t)arg;
+    uint8_t page[64];
+    for (int round = 0; round < TEAR_ROUNDS; round++) {
+        memset(page, (uint8_t)round, sizeof(page));
+        at24c256_client_write(client, TEAR_PAGE, page, sizeof(page));
+    }
+    atomic_store(&g_tear_stop, true);
+    return NULL;
+}
+
+static void seqlock_test(void) {
+    printf("\n=== 共享镜像顺序锁测试 ===\n");
+
+    at24c256_client_t writer_client, reader;
+    CHECK(at24c256_client_connect(g_socket, &writer_client) == AT24C256_OK &&
+          at24c256_client_connect(g_socket, &reader) == AT24C256_OK, "连接两个客户端");
+
+    atomic_store(&g_tear_stop, false);
+    pthread_t thread;
+    pthread_create(&thread, NULL, tear_writer, writer_client);
+
+    uint8_t page[64];
+    int reads = 0;
+    int torn = 0;
+    bool ok = true;
+    while (!atomic_load(&g_tear_stop) && ok) {
+        ok = at24c256_client_read(reader, TEAR_PAGE, page, sizeof(page)) == AT24C256_OK;
+        for (size_t i = 1; ok && i < sizeof(page); i++) {
+            if (page[i] != page[0]) {
+                torn++;
+                break;
+            }
+        }
+        reads++;
+    }
+    pthread_join(thread, NULL);
+    printf("  并发写入期间读取%d次\n", reads);
+    CHECK(ok && reads > 0 && torn == 0, "读取不到撕裂的页");
+
+    at24c256_client_close(writer_client);
+    at24c256_client_close(reader);
+}
+
+/**
+ * @brief 主函数
+ */
+int main(int argc, char* argv[]) {
+    printf("at24c256d测试程序\n");
+    printf("=================\n");
+
+    if (argc != 2) {
+        printf("用法: %s <at24c256d路径>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char node[] = "/tmp/at24c256d_node_XXXXXX";
+    if (create_nvmem_file(node) != 0) {
+        printf("无法创建nvmem测试文件\n");
+        return EXIT_FAILURE;
+    }
+    char shm_name[64];
+    snprintf(g_socket, sizeof(g_socket), "/tmp/at24c256d_test_%d.sock", (int)getpid());
+    snprintf(shm_name, sizeof(shm_name), "/at24c256d_test_%d", (int)getpid());
+
+    pid_t pid = start_daemon(argv[1], node, shm_name);
+    CHECK(pid > 0, "启动守护进程");
+    if (pid > 0) {
+        basic_test(node);
+        permission_test(shm_name);
+        concurrency_test();
+        seqlock_test();
+
+        int status = 0;
+        kill(pid, SIGTERM);
+        CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+              WEXITSTATUS(status) == 0, "守护进程正常退出");
+    }
+    unlink(node);
+
+    printf("\n=== 测试结果 ===\n");
+    if (g_failures == 0) {
+        printf("✓ 所有测试通过！\n");
+        return EXIT_SUCCESS;
+    }
+    printf("✗ %d 项测试失败！\n", g_failures);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,319 @@
+/**
+ * @file microbench.c
+ * @brief 纯软件热路径的CPU微基准
+ *
+ * 在内存模拟器上测量库自身的CPU开销，与I2C总线时间分开跟踪：
+ *   - at24c256_write / at24c256_program_page 的分页规划与后端分派
+ *   - 回写缓存的脏区间记录与写回
+ *   - 64位FNV-1a哈希 (热缓存、哈希目录的校验)
+ *   - 文件容器索引解析 (挂载) 与按名查找
+ * 每项在热缓存 (循环执行) 与冷缓存 (每次执行前驱逐CPU缓存) 两种状态下，
+ * 以不同长度与对齐运行，报告ns/op与bytes/cycle。周期数来自perf_event，
+ * 不可用时可用 -m 指定CPU频率 (MHz) 换算。结果与主机有关，不注册为CTest。
+ *
+ * 使用说明：
+ *   at24c256_microbench [-q] [-m CPU频率MHz] [过滤子串]
+ *     -q  缩短每项的运行时间 (冒烟检查)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "at24c256.h"
+#include "at24c256_container.h"
+#include "at24c256_schema.h"
+#include "at24c256_internal.h"
+
+#define EVICT_SIZE (16 * 1024 * 1024)   // 大于常见末级缓存
+#define COLD_RUNS 64
+
+/**
+ * @brief 一项基准的参数
+ */
+typedef struct {
+    at24c256_handle_t handle;
+    at24c256_container_t container;
+    const uint8_t* data;
+    uint16_t address;
+    uint16_t length;
+} bench_ctx_t;
+
+typedef void (*bench_fn_t)(bench_ctx_t* ctx);
+
+static uint8_t* g_data;
+static uint8_t* g_evict;
+static int g_cycles_fd = -1;
+static double g_mhz = 0.0;
+static double g_target_ns = 200e6;
+static const char* g_filter;
+static volatile uint64_t g_sink;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 打开当前线程的CPU周期计数器
+ */
+static void open_cycle_counter(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    g_cycles_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t read_cycles(void) {
+    uint64_t value = 0;
+    if (g_cycles_fd >= 0 && read(g_cycles_fd, &value, sizeof(value)) != sizeof(value)) {
+        value = 0;
+    }
+    return value;
+}
+
+/**
+ * @brief 逐行写入一块大缓冲区，把测试数据挤出CPU缓存
+ */
+static void evict_caches(void) {
+    for (size_t i = 0; i < EVICT_SIZE; i += 64) {
+        g_evict[i]++;
+    }
+}
+
+/**
+ * @brief 运行一项基准并打印一行结果
+ */
+static void run(const char* name, bench_fn_t fn, bench_ctx_t* ctx, bool cold) {
+    if (g_filter && !strstr(name, g_filter)) {
+        return;
+    }
+
+    uint64_t iterations = 0;
+    uint64_t elapsed = 0;
+    uint64_t cycles = 0;
+
+    if (cold) {
+        for (int i = 0; i < COLD_RUNS; i++) {
+            evict_caches();
+            uint64_t c0 = read_cycles();
+            uint64_t t0 = now_ns();
+            fn(ctx);
+            elapsed += now_ns() - t0;
+            cycles += read_cycles() - c0;
+        }
+        iterations = COLD_RUNS;
+    } else {
+        // 每轮加倍迭代次数，直到单轮运行时间达到目标
+        fn(ctx);
+        for (uint64_t n = 1;; n *= 2) {
+            uint64_t c0 = read_cycles();
+            uint64_t t0 = now_ns();
+            for (uint64_t i = 0; i < n; i++) {
+                fn(ctx);
+            }
+            elapsed = now_ns() - t0;
+            cycles = read_cycles() - c0;
+            iterations = n;
+            if (elapsed >= g_target_ns || n >= (1ULL << 30)) {
+                break;
+            }
+        }
+    }
+
+    double ns_per_op = (double)elapsed / (double)iterations;
+    double cycles_per_op = g_cycles_fd >= 0 ? (double)cycles / (double)iterations
+                                             : ns_per_op * g_mhz / 1000.0;
+    printf("%-30s %6u %3u %-4s %12.1f", name, ctx->length, ctx->address % 64u,
+           cold ? "cold" : "warm", ns_per_op);
+    if (cycles_per_op > 0.0) {
+        printf(" %12.3f\n", ctx->length / cycles_per_op);
+    } else {
+        printf(" %12s\n", "n/a");
+    }
+}
+
+static void bench_write(bench_ctx_t* ctx) {
+    at24c256_write(ctx->handle, ctx->address, ctx->data, ctx->length);
+}
+
+static void bench_program_page(bench_ctx_t* ctx) {
+    at24c256_program_page(ctx->handle, ctx->address, ctx->data, ctx->length);
+}
+
+static void bench_cache_write_flush(bench_ctx_t* ctx) {
+    at24c256_write(ctx->handle, ctx->address, ctx->data, ctx->length);
+    at24c256_flush(ctx->handle);
+}
+
+static void bench_cache_read(bench_ctx_t* ctx) {
+    at24c256_read(ctx->handle, ctx->address, g_data, ctx->length);
+}
+
+static void bench_hash64(bench_ctx_t* ctx) {
+    g_sink += at24c256_hash64(ctx->data + ctx->address % 64u, ctx->length, AT24C256_HASH64_SEED);
+}
+
+static void bench_hash64_except(bench_ctx_t* ctx) {
+    static const at24c256_span_t holes[2] = { { 0x0100, 16 }, { 0x7EF0, 16 } };
+    g_sink += at24c256_hash64_except(ctx->data + ctx->address % 64u, 0, ctx->length, holes, 2,
+                                     AT24C256_HASH64_SEED);
+}
+
+static void bench_container_mount(bench_ctx_t* ctx) {
+    at24c256_container_t container;
+    if (at24c256_container_mount(ctx->handle, &container) == AT24C256_OK) {
+        at24c256_container_unmount(container);
+    }
+}
+
+static void bench_container_find(bench_ctx_t* ctx) {
+    g_sink += (uint64_t)at24c256_container_find(ctx->container, "file15.dat");
+}
+
+/**
+ * @brief 打开一个写周期不计等待的模拟器设备
+ */
+static at24c256_handle_t open_sim(void) {
+    static at24c256_sim_params_t sim = AT24C256_SIM_DEFAULT_PARAMS;
+    sim.wait = AT24C256_SIM_WAIT_POLL;
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    config.sim = &sim;
+
+    at24c256_handle_t handle;
+    if (at24c256_init(&config, &handle) != AT24C256_OK) {
+        fprintf(stderr, "模拟器初始化失败\n");
+        exit(EXIT_FAILURE);
+    }
+    return handle;
+}
+
+static void write_benches(void) {
+    static const uint16_t sizes[] = { 8, 64, 256, 4096 };
+    static const uint16_t offsets[] = { 0, 1, 37 };
+    bench_ctx_t ctx = { .handle = open_sim(), .data = g_data };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (size_t j = 0; j < sizeof(offsets) / sizeof(offsets[0]); j++) {
+            ctx.address = (uint16_t)(0x1000 + offsets[j]);
+            ctx.length = sizes[i];
+            run("write (page split)", bench_write, &ctx, false);
+            run("write (page split)", bench_write, &ctx, true);
+        }
+    }
+
+    ctx.address = 0x1000;
+    ctx.length = 64;
+    run("program_page", bench_program_page, &ctx, false);
+    run("program_page", bench_program_page, &ctx, true);
+
+    at24c256_cache_enable(ctx.handle, AT24C256_CACHE_WRITE_BACK);
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        ctx.address = (uint16_t)(0x1000 + 37);
+        ctx.length = sizes[i];
+        run("write_back write+flush", bench_cache_write_flush, &ctx, false);
+        run("write_back write+flush", bench_cache_write_flush, &ctx, true);
+        run("cache read (hit)", bench_cache_read, &ctx, false);
+        run("cache read (hit)", bench_cache_read, &ctx, true);
+    }
+    at24c256_deinit(ctx.handle);
+}
+
+static void hash_benches(void) {
+    static const uint16_t sizes[] = { 16, 64, 1024, 32768 - 64 };
+    static const uint16_t offsets[] = { 0, 1, 3 };
+    bench_ctx_t ctx = { .data = g_data };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (size_t j = 0; j < sizeof(offsets) / sizeof(offsets[0]); j++) {
+            ctx.address = offsets[j];
+            ctx.length = sizes[i];
+            run("hash64", bench_hash64, &ctx, false);
+            run("hash64", bench_hash64, &ctx, true);
+        }
+        ctx.address = 0;
+        run("hash64_except (2 holes)", bench_hash64_except, &ctx, false);
+        run("hash64_except (2 holes)", bench_hash64_except, &ctx, true);
+    }
+}
+
+static void container_benches(void) {
+    bench_ctx_t ctx = { .handle = open_sim(), .data = g_data };
+    char name[16];
+    int index;
+
+    // 16个文件的索引，挂载时经页缓存解析
+    at24c256_container_mount(ctx.handle, &ctx.container);
+    for (int i = 0; i < AT24C256_CONTAINER_MAX_FILES; i++) {
+        snprintf(name, sizeof(name), "file%d.dat", i);
+        at24c256_container_create(ctx.container, name, &index);
+        at24c256_container_write(ctx.container, index, 0, g_data, 64);
+    }
+    at24c256_container_sync(ctx.container);
+
+    ctx.length = AT24C256_CONTAINER_MAX_FILES;
+    run("container_find", bench_container_find, &ctx, false);
+    run("container_find", bench_container_find, &ctx, true);
+    at24c256_container_unmount(ctx.container);
+
+    ctx.length = AT24C256_INDEX_HEADER_SIZE + AT24C256_CONTAINER_MAX_FILES * AT24C256_FILE_INDEX_SIZE;
+    run("container_mount (cached)", bench_container_mount, &ctx, false);
+    run("container_mount (cached)", bench_container_mount, &ctx, true);
+    at24c256_deinit(ctx.handle);
+}
+
+/**
+ * @brief 主函数
+ */
+int main(int argc, char* argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "qm:h")) != -1) {
+        switch (opt) {
+        case 'q': g_target_ns = 5e6; break;
+        case 'm': g_mhz = strtod(optarg, NULL); break;
+        default:
+            printf("用法: %s [-q] [-m CPU频率MHz] [过滤子串]\n", argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (optind < argc) {
+        g_filter = argv[optind];
+    }
+
+    g_data = (uint8_t*)malloc(32768 + 64);
+    g_evict = (uint8_t*)calloc(EVICT_SIZE, 1);
+    if (!g_data || !g_evict) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < 32768 + 64; i++) {
+        g_data[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    open_cycle_counter();
+    if (g_cycles_fd < 0 && g_mhz <= 0.0) {
+        printf("注意: perf_event周期计数不可用，bytes/cycle需用 -m 指定CPU频率\n");
+    }
+
+    printf("%-30s %6s %3s %-4s %12s %12s\n", "benchmark", "bytes", "off", "lvl", "ns/op",
+           "bytes/cycle");
+    write_benches();
+    hash_benches();
+    container_benches();
+
+    if (g_cycles_fd >= 0) {
+        close(g_cycles_fd);
+    }
+    free(g_evict);
+    free(g_data);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,532 @@
+/**
+ * @file nvmem_backend_test.c
+ * @brief nvmem后端测试程序
+ *
+ * 用普通文件充当 /sys/bus/nvmem/devices/<*>/nvmem 节点，验证同一套at24c256_* API
+ * (读写、跨页、擦除、固定几何特化、流式传输、异步请求、页缓存、热缓存、哈希目录、文件容器、器件表、
+ * 内存映射的加载失败处理)
+ * 在nvmem后端上的行为。无需硬件。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include "at24c256.h"
+#include "at24c256_container.h"
+#include "at24c256_schema.h"
+#include "at24c256_fixed.h"
+
+#define EEPROM_SIZE 32768
+
+static int g_failures = 0;
+
+AT24C256_DEFINE_GEOMETRY(fixed, 64, EEPROM_SIZE, 2)
+
+#define CHECK(cond, msg) do { \
+    if (cond) { \
+        printf("✓ %s\n", msg); \
+    } else { \
+        printf("✗ %s\n", msg); \
+        g_failures++; \
+    } \
+} while (0)
+
+/**
+ * @brief 创建充当nvmem节点的文件 (内容全为0xFF)
+ */
+static int create_nvmem_file(char* path) {
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return -1;
+    }
+    uint8_t blank[EEPROM_SIZE];
+    memset(blank, 0xFF, sizeof(blank));
+    ssize_t n = write(fd, blank, sizeof(blank));
+    close(fd);
+    return n == (ssize_t)sizeof(blank) ? 0 : -1;
+}
+
+/**
+ * @brief 绕过驱动直接读取节点内容
+ */
+static int read_node(const char* path, uint16_t address, uint8_t* data, uint16_t length) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = pread(fd, data, length, address);
+    close(fd);
+    return n == length ? 0 : -1;
+}
+
+/**
+ * @brief 基础读写、跨页与擦除
+ */
+static void basic_test(at24c256_handle_t handle, const char* path) {
+    printf("\n=== 基础读写测试 ===\n");
+
+    uint8_t data[200];
+    uint8_t back[200];
+    for (int i = 0; i < (int)sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    // 跨越多个页边界
+    CHECK(at24c256_write(handle, 0x1FF0, data, sizeof(data)) == AT24C256_OK, "跨页写入");
+    CHECK(at24c256_read(handle, 0x1FF0, back, sizeof(back)) == AT24C256_OK &&
+          memcmp(data, back, sizeof(data)) == 0, "读回一致");
+    CHECK(read_node(path, 0x1FF0, back, sizeof(back)) == 0 &&
+          memcmp(data, back, sizeof(data)) == 0, "节点文件内容一致");
+
+    CHECK(at24c256_erase(handle, 0x2000, 32) == AT24C256_OK, "擦除");
+    CHECK(at24c256_read(handle, 0x2000, back, 32) == AT24C256_OK, "读取擦除区域");
+    int all_ff = 1;
+    for (int i = 0; i < 32; i++) {
+        all_ff &= back[i] == 0xFF;
+    }
+    CHECK(all_ff, "擦除区域全为0xFF");
+
+    CHECK(at24c256_wait_ready(handle, 10) == AT24C256_OK, "设备就绪");
+    CHECK(at24c256_read(handle, EEPROM_SIZE - 1, back, 2) == AT24C256_ERROR_PARAM, "越界检查");
+}
+
+/**
+ * @brief 编译期固定几何的特化读写
+ */
+static void fixed_geometry_test(at24c256_handle_t handle, const char* path) {
+    printf("\n=== 固定几何特化测试 ===\n");
+
+    uint8_t data[150];
+    uint8_t back[150];
+    for (int i = 0; i < (int)sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 3 + 11);
+    }
+
+    at24c256_config_t config = fixed_config("/dev/i2c-5", 0x50);
+    CHECK(config.page_size == 64 && config.total_size == EEPROM_SIZE, "生成配置");
+    CHECK(fixed_write(handle, 0x0E30, data, sizeof(data)) == AT24C256_OK, "跨页写入");
+    CHECK(read_node(path, 0x0E30, back, sizeof(back)) == 0 &&
+          memcmp(data, back, sizeof(data)) == 0, "节点文件内容一致");
+    CHECK(fixed_read(handle, 0x0E30, back, sizeof(back)) == AT24C256_OK &&
+          memcmp(data, back, sizeof(data)) == 0, "读回一致");
+    CHECK(fixed_write(handle, EEPROM_SIZE - 1, data, 2) == AT24C256_ERROR_PARAM, "越界检查");
+    CHECK(fixed_write_page(handle, 0x0F00, data, 65) == AT24C256_ERROR_PARAM, "单页长度检查");
+}
+
+/**
+ * @brief 文件描述符流式写入与读出
+ */
+static void stream_test(at24c256_handle_t handle, const char* path) {
+    printf("\n=== 流式传输测试 ===\n");
+
+    uint8_t data[1000];
+    uint8_t back[1000];
+    for (int i = 0; i < (int)sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 13 + 1);
+    }
+
+    char file_path[] = "/tmp/at24c256_stream_XXXXXX";
+    int fd = mkstemp(file_path);
+    if (fd < 0) {
+        CHECK(0, "创建临时文件");
+        return;
+    }
+    unlink(file_path);
+
+    CHECK(write(fd, data, sizeof(data)) == (ssize_t)sizeof(data), "准备源文件");
+    lseek(fd, 0, SEEK_SET);
+    CHECK(at24c256_write_from_fd(handle, 0x0A10, fd, sizeof(data)) == AT24C256_OK, "从fd写入");
+    CHECK(read_node(path, 0x0A10, back, sizeof(back)) == 0 &&
+          memcmp(data, back, sizeof(data)) == 0, "节点文件内容一致");
+    CHECK(at24c256_write_from_fd(handle, 0x0A10, fd, 16) == AT24C256_ERROR_READ, "fd提前结束");
+
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    CHECK(at24c256_read_to_fd(handle, 0x0A10, fd, sizeof(data)) == AT24C256_OK, "读出到fd");
+    CHECK(pread(fd, back, sizeof(back), 0) == (ssize_t)sizeof(back) &&
+          memcmp(data, back, sizeof(data)) == 0, "fd内容一致");
+    close(fd);
+}
+
+/**
+ * @brief 异步请求：由poll循环驱动直到全部完成
+ */
+static void async_test(at24c256_handle_t handle) {
+    printf("\n=== 异步请求测试 ===\n");
+
+    uint8_t data[600];
+    uint8_t back[600];
+    for (int i = 0; i < (int)sizeof(data); i++) {
+        data[i] = (uint8_t)(i ^ 0x5C);
+    }
+
+    int fd = at24c256_async_fd(handle);
+    CHECK(fd >= 0, "获取异步描述符");
+
+    uint32_t write_id = 0;
+    uint32_t read_id = 0;
+    CHECK(at24c256_async_write(handle, 0x5010, data, sizeof(data), data, &write_id) == AT24C256_OK,
+          "提交写入");
+    CHECK(at24c256_async_read(handle, 0x5010, back, sizeof(back), back, &read_id) == AT24C256_OK,
+          "提交读取");
+
+    int completed = 0;
+    int in_order = 1;
+    at24c256_err_t results = AT24C256_OK;
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    while (at24c256_async_pending(handle) > 0 && poll(&pfd, 1, 1000) > 0) {
+        at24c256_completion_t done[4];
+        int n = at24c256_poll_completions(handle, done, 4);
+        for (int i = 0; i < n; i++) {
+            in_order &= done[i].id == (completed == 0 ? write_id : read_id);
+            if (done[i].result != AT24C256_OK) {
+                results = done[i].result;
+            }
+            completed++;
+        }
+    }
+    CHECK(completed == 2 && in_order && results == AT24C256_OK, "按提交顺序完成");
+    CHECK(memcmp(data, back, sizeof(data)) == 0, "读回一致");
+}
+
+/**
+ * @brief 回写缓存：flush之前不写节点
+ */
+static void cache_test(at24c256_handle_t handle, const char* path) {
+    printf("\n=== 页缓存测试 ===\n");
+
+    const char* text = "write-back cache";
+    uint8_t back[32];
+
+    CHECK(at24c256_cache_enable(handle, AT24C256_CACHE_WRITE_BACK) == AT24C256_OK, "启用回写缓存");
+    CHECK(at24c256_write(handle, 0x3000, (const uint8_t*)text, strlen(text)) == AT24C256_OK, "写入缓存");
+    CHECK(at24c256_read(handle, 0x3000, back, strlen(text)) == AT24C256_OK &&
+          memcmp(back, text, strlen(text)) == 0, "从缓存读回");
+    CHECK(read_node(path, 0x3000, back, strlen(text)) == 0 &&
+          memcmp(back, text, strlen(text)) != 0, "flush前节点未修改");
+    CHECK(at24c256_flush(handle) == AT24C256_OK, "flush");
+    CHECK(read_node(path, 0x3000, back, strlen(text)) == 0 &&
+          memcmp(back, text, strlen(text)) == 0, "flush后节点已更新");
+    CHECK(at24c256_cache_disable(handle) == AT24C256_OK, "关闭缓存");
+
+    // 未加载页上两次不相连的写入：写回时不能把中间的未知字节编程到芯片
+    uint8_t page[64];
+    uint8_t one = 0x01;
+    memset(page, 0x41, sizeof(page));
+    CHECK(at24c256_write(handle, 0x3040, page, sizeof(page)) == AT24C256_OK &&
+          at24c256_cache_enable(handle, AT24C256_CACHE_WRITE_BACK) == AT24C256_OK &&
+          at24c256_write(handle, 0x3040, &one, 1) == AT24C256_OK &&
+          at24c256_write(handle, 0x3050, &one, 1) == AT24C256_OK &&
+          at24c256_flush(handle) == AT24C256_OK, "未加载页上不相连的写入");
+    CHECK(read_node(path, 0x3040, page, sizeof(page)) == 0 && page[0] == 0x01 &&
+          page[1] == 0x41 && page[15] == 0x41 && page[16] == 0x01 && page[17] == 0x41,
+          "中间的字节保持芯片原有内容");
+    CHECK(at24c256_cache_disable(handle) == AT24C256_OK, "关闭缓存");
+}
+
+/**
+ * @brief 绕过驱动直接修改节点内容
+ */
+static int write_node(const char* path, uint16_t address, const uint8_t* data, uint16_t length) {
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = pwrite(fd, data, length, address);
+    close(fd);
+    return n == length ? 0 : -1;
+}
+
+/**
+ * @brief 热缓存：代数戳一致时读取由主机侧镜像提供，不一致时整片刷新
+ */
+static void warm_cache_test(const at24c256_config_t* config, const char* path) {
+    printf("\n=== 热缓存测试 ===\n");
+
+    char image_path[] = "/tmp/at24c256_warm_XXXXXX";
+    int fd = mkstemp(image_path);
+    if (fd < 0) {
+        CHECK(0, "创建镜像文件");
+        return;
+    }
+    close(fd);
+    unlink(image_path);
+
+    const uint8_t value = 0x5A;
+    const uint8_t behind = 0xA5;
+    uint8_t back = 0;
+    at24c256_handle_t handle;
+
+    // 第一次启用：没有镜像，整片刷新并生成代数戳
+    CHECK(at24c256_init(config, &handle) == AT24C256_OK, "初始化");
+    CHECK(at24c256_warm_cache_enable(handle, image_path, AT24C256_WARM_STAMP_AT_END) == AT24C256_OK,
+          "首次启用热缓存");
+    CHECK(!at24c256_warm_cache_hit(handle), "首次启用未命中");
+    CHECK(at24c256_write(handle, 0x4000, &value, 1) == AT24C256_OK, "写入");
+    at24c256_deinit(handle);
+
+    // 绕过驱动修改芯片但不更新代数戳：命中时读到的是镜像内容
+    write_node(path, 0x4000, &behind, 1);
+    CHECK(at24c256_init(config, &handle) == AT24C256_OK, "重新初始化");
+    CHECK(at24c256_warm_cache_enable(handle, image_path, AT24C256_WARM_STAMP_AT_END) == AT24C256_OK,
+          "再次启用热缓存");
+    CHECK(at24c256_warm_cache_hit(handle), "代数戳一致时命中");
+    CHECK(at24c256_read(handle, 0x4000, &back, 1) == AT24C256_OK && back == value,
+          "读取由镜像提供");
+    at24c256_deinit(handle);
+
+    // 破坏片上代数戳：必须整片刷新
+    const uint8_t broken[4] = { 0, 0, 0, 0 };
+    write_node(path, EEPROM_SIZE - 16, broken, sizeof(broken));
+    CHECK(at24c256_init(config, &handle) == AT24C256_OK, "第三次初始化");
+    CHECK(at24c256_warm_cache_enable(handle, image_path, AT24C256_WARM_STAMP_AT_END) == AT24C256_OK,
+          "第三次启用热缓存");
+    CHECK(!at24c256_warm_cache_hit(handle), "代数戳不一致时未命中");
+    CHECK(at24c256_read(handle, 0x4000, &back, 1) == AT24C256_OK && back == behind,
+          "刷新后读到芯片内容");
+    at24c256_deinit(handle);
+
+    unlink(image_path);
+}
+
+/**
+ * @brief 哈希目录：只比较哈希找出不同区域，只重新编程这些区域
+ */
+static void hashdir_test(const at24c256_config_t* config, const char* path) {
+    printf("\n=== 哈希目录测试 ===\n");
+
+    static uint8_t image[EEPROM_SIZE];
+    const uint8_t value = 0x77;
+    uint64_t mask = 0;
+    at24c256_handle_t handle;
+
+    CHECK(at24c256_init(config, &handle) == AT24C256_OK, "初始化");
+    CHECK(at24c256_hashdir_enable(handle, AT24C256_HASHDIR_AT_END) == AT24C256_OK, "建立哈希目录");
+    CHECK(read_node(path, 0, image, 0x4000) == 0 && read_node(path, 0x4000, image + 0x4000, 0x4000) == 0,
+          "读取当前芯片内容");
+    CHECK(at24c256_hashdir_diff(handle, image, &mask) == AT24C256_OK && mask == 0, "内容一致");
+
+    image[0x0010] ^= 0xFF;
+    image[0x2C00] ^= 0xFF;
+    CHECK(at24c256_hashdir_diff(handle, image, &mask) == AT24C256_OK &&
+          mask == ((1ULL << 0) | (1ULL << 11)), "找出不同的区域");
+    CHECK(at24c256_hashdir_sync(handle, image, &mask) == AT24C256_OK &&
+          mask == ((1ULL << 0) | (1ULL << 11)), "只写入不同的区域");
+    CHECK(at24c256_hashdir_diff(handle, image, &mask) == AT24C256_OK && mask == 0, "同步后一致");
+
+    // 普通写入先清零片上哈希，flush (或diff) 时增量更新目录
+    uint16_t entry = (uint16_t)((EEPROM_SIZE - 16 - 264) / 64 * 64 + 8 + 5 * 8);
+    uint8_t stored[8];
+    CHECK(at24c256_write(handle, 0x1400, &value, 1) == AT24C256_OK, "写入");
+    CHECK(read_node(path, entry, stored, 8) == 0 && memcmp(stored, "\0\0\0\0\0\0\0\0", 8) == 0,
+          "写入区域的片上哈希已清零");
+    CHECK(at24c256_flush(handle) == AT24C256_OK && read_node(path, entry, stored, 8) == 0 &&
+          memcmp(stored, "\0\0\0\0\0\0\0\0", 8) != 0, "flush时写入新哈希");
+    CHECK(at24c256_hashdir_diff(handle, image, &mask) == AT24C256_OK && mask == (1ULL << 5),
+          "写入后目录已更新");
+    image[0x1400] = value;
+    at24c256_deinit(handle);
+
+    // 重新打开时直接使用片上目录
+    CHECK(at24c256_init(config, &handle) == AT24C256_OK, "重新初始化");
+    CHECK(at24c256_hashdir_enable(handle, AT24C256_HASHDIR_AT_END) == AT24C256_OK, "加载哈希目录");
+    CHECK(at24c256_hashdir_diff(handle, image, &mask) == AT24C256_OK && mask == 0, "片上目录有效");
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 文件容器：创建、写入、重新挂载读回
+ */
+static void container_test(at24c256_handle_t handle) {
+    printf("\n=== 文件容器测试 ===\n");
+
+    const char* content = "fx=1234.5 fy=1234.5 cx=640 cy=360\n";
+    at24c256_container_t container;
+    int index = -1;
+
+    CHECK(at24c256_container_mount(handle, &container) == AT24C256_OK, "挂载空容器");
+    CHECK(at24c256_container_count(container) == 0, "空容器无文件");
+    CHECK(at24c256_container_create(container, "camera0.dat", &index) == AT24C256_OK, "创建文件");
+    CHECK(at24c256_container_write(container, index, 0, (const uint8_t*)content,
+                                   strlen(content)) == AT24C256_OK, "写入文件");
+    CHECK(at24c256_container_unmount(container) == AT24C256_OK, "卸载并写回");
+
+    uint8_t back[64];
+    uint32_t done = 0;
+    at24c256_file_info_t info;
+    CHECK(at24c256_container_mount(handle, &container) == AT24C256_OK, "重新挂载");
+    index = at24c256_container_find(container, "camera0.dat");
+    CHECK(index == 0, "按文件名查找");
+    CHECK(at24c256_container_stat(container, index, &info) == AT24C256_OK &&
+          info.size == strlen(content), "文件大小");
+    CHECK(at24c256_container_read(container, index, 0, back, sizeof(back), &done) == AT24C256_OK &&
+          done == strlen(content) && memcmp(back, content, done) == 0, "读回文件内容");
+    at24c256_container_unmount(container);
+
+    // 片上索引为紧凑的小端格式：索引项紧跟索引头，无填充
+    uint8_t raw[AT24C256_INDEX_HEADER_SIZE + 2 * AT24C256_FILE_INDEX_V1_STRIDE];
+    at24c256_index_header_t header;
+    at24c256_file_index_t entry;
+    CHECK(at24c256_read(handle, 0, raw, AT24C256_INDEX_HEADER_SIZE + AT24C256_FILE_INDEX_SIZE) ==
+          AT24C256_OK, "读取片上索引");
+    at24c256_index_header_decode(&header, raw);
+    at24c256_file_index_decode(&entry, raw + AT24C256_INDEX_HEADER_SIZE);
+    CHECK(header.version == AT24C256_INDEX_VERSION && header.file_count == 1 &&
+          strcmp(entry.filename, "camera0.dat") == 0 && entry.size == strlen(content) &&
+          raw[AT24C256_INDEX_HEADER_SIZE + 64] == (uint8_t)entry.address &&
+          raw[AT24C256_INDEX_HEADER_SIZE + 65] == (uint8_t)(entry.address >> 8),
+          "索引按紧凑格式保存");
+
+    // 版本1索引 (每项70字节) 仍可挂载，写回后升级为版本2
+    memset(raw, 0, sizeof(raw));
+    header.version = 1;
+    header.file_count = 2;
+    at24c256_index_header_encode(&header, raw);
+    at24c256_file_index_encode(&entry, raw + AT24C256_INDEX_HEADER_SIZE);
+    strcpy(entry.filename, "legacy.dat");
+    at24c256_file_index_encode(&entry, raw + AT24C256_INDEX_HEADER_SIZE +
+                               AT24C256_FILE_INDEX_V1_STRIDE);
+    CHECK(at24c256_write(handle, 0, raw, sizeof(raw)) == AT24C256_OK, "写入版本1索引");
+    CHECK(at24c256_container_mount(handle, &container) == AT24C256_OK &&
+          at24c256_container_find(container, "legacy.dat") == 1 &&
+          at24c256_container_stat(container, 1, &info) == AT24C256_OK &&
+          info.address == entry.address && info.size == entry.size, "挂载版本1索引");
+    at24c256_container_unmount(container);
+    CHECK(at24c256_read(handle, 0, raw, AT24C256_INDEX_HEADER_SIZE) == AT24C256_OK &&
+          raw[4] == AT24C256_INDEX_VERSION, "版本1索引升级为版本2");
+}
+
+/**
+ * @brief 器件表：查找型号并按大页器件的几何写入
+ */
+static void part_test(const char* path) {
+    printf("\n=== 器件表测试 ===\n");
+
+    const at24c256_part_t* part = at24c256_find_part("24c512");
+    CHECK(part && part->page_size == 128 && part->total_size == 65536, "省略前缀查找AT24C512");
+    part = at24c256_find_part("at24c16");
+    CHECK(part && part->addr_bytes == 1 && part->block_bits == 3, "AT24C16使用块选择");
+    CHECK(at24c256_find_part("AT24C999") == NULL, "未知型号");
+
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    CHECK(at24c256_config_set_part(&config, "AT24C128") == AT24C256_OK &&
+          config.page_size == 64 && config.total_size == 16384, "按型号填写配置");
+
+    // 1字节字地址最多寻址2KB
+    config.addr_bytes = 1;
+    config.nvmem_path = path;
+    at24c256_handle_t handle;
+    CHECK(at24c256_init(&config, &handle) == AT24C256_ERROR_PARAM, "拒绝超出寻址范围的配置");
+
+    // 块选择位在打开总线之前检查：AT24C16的设备地址低3位必须为0
+    at24c256_config_t blocks = AT24C256_DEFAULT_CONFIG;
+    CHECK(at24c256_config_set_part(&blocks, "AT24C16") == AT24C256_OK, "选择AT24C16");
+    blocks.i2c_bus = "/nonexistent/i2c";
+    blocks.device_addr = 0x51;
+    CHECK(at24c256_init(&blocks, &handle) == AT24C256_ERROR_PARAM, "拒绝占用块选择位的设备地址");
+    blocks.device_addr = 0x50 + (1 << part->block_bits);
+    CHECK(at24c256_init(&blocks, &handle) == AT24C256_ERROR_INIT, "对齐的设备地址继续打开总线");
+
+    // 128字节页：跨页写入在nvmem文件上应完整落盘
+    uint8_t data[200];
+    uint8_t back[200];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7 + 3);
+    }
+    CHECK(at24c256_config_set_part(&config, "AT24C512") == AT24C256_OK, "选择AT24C512");
+    config.total_size = EEPROM_SIZE;   // 测试文件只有32KB
+    CHECK(at24c256_init(&config, &handle) == AT24C256_OK, "按AT24C512初始化");
+    CHECK(at24c256_write(handle, 0x0070, data, sizeof(data)) == AT24C256_OK, "按128字节页写入");
+    CHECK(read_node(path, 0x0070, back, sizeof(back)) == 0 && memcmp(back, data, sizeof(data)) == 0,
+          "写入内容正确");
+    at24c256_deinit(handle);
+}
+/**
+ * @brief 内存映射：加载失败的主机页不写回，msync报告读取错误
+ */
+static void map_error_test(void) {
+    printf("\n=== 内存映射加载失败测试 ===\n");
+
+    char path[] = "/tmp/at24c256_map_XXXXXX";
+    if (create_nvmem_file(path) != 0) {
+        CHECK(0, "创建nvmem测试文件");
+        return;
+    }
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    config.nvmem_path = path;
+
+    at24c256_handle_t handle;
+    void* base = NULL;
+    uint8_t back = 0;
+    struct stat st;
+
+    // 初始化后截短节点文件，4KB之后的读取失败
+    CHECK(at24c256_init(&config, &handle) == AT24C256_OK && truncate(path, 4096) == 0, "初始化");
+    at24c256_err_t ret = at24c256_map(handle, &base);
+    if (ret == AT24C256_ERROR_UNSUPPORTED) {
+        printf("  内核不支持userfaultfd写保护，跳过\n");
+    } else {
+        CHECK(ret == AT24C256_OK, "建立映射");
+    }
+    if (ret == AT24C256_OK) {
+        volatile uint8_t* mem = (volatile uint8_t*)base;
+        mem[0x0010] = 0x12;
+        CHECK(mem[0x2000] == 0xFF, "加载失败的页显示为0xFF");
+        mem[0x2000] = 0x34;
+        CHECK(at24c256_msync(handle) == AT24C256_ERROR_READ, "写回报告读取错误");
+        CHECK(read_node(path, 0x0010, &back, 1) == 0 && back == 0x12, "正常页已写回");
+        CHECK(stat(path, &st) == 0 && st.st_size == 4096, "加载失败的页未写回");
+        CHECK(at24c256_msync(handle) == AT24C256_ERROR_READ, "错误保持到解除映射");
+        CHECK(at24c256_unmap(handle) == AT24C256_OK, "解除映射");
+    }
+    at24c256_deinit(handle);
+    unlink(path);
+}
+
+/**
+ * @brief 主函数
+ */
+int main(void) {
+    printf("nvmem后端测试程序\n");
+    printf("================\n");
+
+    char path[] = "/tmp/at24c256_nvmem_XXXXXX";
+    if (create_nvmem_file(path) != 0) {
+        printf("无法创建nvmem测试文件\n");
+        return EXIT_FAILURE;
+    }
+
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    config.nvmem_path = path;
+
+    at24c256_handle_t handle;
+    at24c256_err_t ret = at24c256_init(&config, &handle);
+    CHECK(ret == AT24C256_OK, "nvmem后端初始化");
+    if (ret == AT24C256_OK) {
+        basic_test(handle, path);
+        fixed_geometry_test(handle, path);
+        stream_test(handle, path);
+        async_test(handle);
+        cache_test(handle, path);
+        container_test(handle);
+        at24c256_deinit(handle);
+        warm_cache_test(&config, path);
+        hashdir_test(&config, path);
+        part_test(path);
+        map_error_test();
+    }
+
+    unlink(path);
+
+    printf("\n=== 测试结果 ===\n");
+    if (g_failures == 0) {
+        printf("✓ 所有测试通过！\n");
+        return EXIT_SUCCESS;
+    }
+    printf("✗ %d 项测试失败！\n", g_failures);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,341 @@
+/**
+ * @file perf_gate_test.c
+ * @brief 性能回归门禁
+ *
+ * 在内存模拟器上运行确定性的虚拟时钟基准 (读取、顺序预读、写入、擦除、文件容器挂载)，
+ * 把总线时间、总耗时、读事务数与页编程次数与仓库中的基线比较，
+ * 任一指标超出基线的阈值即失败；基准中任一调用返回错误同样失败 (也不会写入基线)。
+ * 虚拟时钟不受主机负载影响，结果逐次相同。
+ *
+ * 使用说明：
+ *   at24c256_perf_test 基线文件 [-t 阈值百分比] [-u]
+ *     -u  用本次结果重写基线文件 (有意改变性能特征后使用)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "at24c256.h"
+#include "at24c256_container.h"
+
+#define MAX_BENCHES 16
+
+/**
+ * @brief 一项基准的结果
+ */
+typedef struct {
+    const char* name;
+    uint64_t bus_ns;             /**< 总线时间 */
+    uint64_t total_ns;           /**< 虚拟时钟经过的时间 */
+    uint64_t reads;              /**< 读事务数 */
+    uint64_t pages;              /**< 页编程次数 */
+} bench_result_t;
+
+static bench_result_t g_results[MAX_BENCHES];
+static int g_count = 0;
+static int g_errors = 0;
+static uint8_t g_buffer[32768];
+
+/**
+ * @brief 基准中的调用必须成功，否则测得的是出错路径
+ */
+#define EXPECT_OK(call) do { \
+    at24c256_err_t err_ = (call); \
+    if (err_ != AT24C256_OK) { \
+        printf("✗ %s:%d %s 返回 %s\n", __func__, __LINE__, #call, at24c256_strerror(err_)); \
+        g_errors++; \
+    } \
+} while (0)
+
+/**
+ * @brief 打开一个全新的模拟器设备
+ */
+static at24c256_handle_t open_sim(void) {
+    static at24c256_sim_params_t sim = AT24C256_SIM_DEFAULT_PARAMS;
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    config.sim = &sim;
+
+    at24c256_handle_t handle;
+    if (at24c256_init(&config, &handle) != AT24C256_OK) {
+        fprintf(stderr, "模拟器初始化失败\n");
+        exit(EXIT_FAILURE);
+    }
+    return handle;
+}
+
+/**
+ * @brief 记录两次统计之间的差值
+ */
+static void record(const char* name, const at24c256_sim_stats_t* before,
+                   const at24c256_sim_stats_t* after) {
+    bench_result_t* r = &g_results[g_count++];
+    r->name = name;
+    r->bus_ns = after->bus_ns - before->bus_ns;
+    r->total_ns = after->now_ns - before->now_ns;
+    r->reads = after->reads - before->reads;
+    r->pages = after->pages - before->pages;
+}
+
+/**
+ * @brief 线性同余伪随机数 (固定种子，结果可重复)
+ */
+static uint32_t next_random(uint32_t* state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+static void bench_read(void) {
+    at24c256_handle_t handle = open_sim();
+    at24c256_sim_stats_t before, after;
+
+    at24c256_sim_get_stats(handle, &before);
+    EXPECT_OK(at24c256_read(handle, 0, g_buffer, sizeof(g_buffer)));
+    at24c256_sim_get_stats(handle, &after);
+    record("read_full", &before, &after);
+
+    uint32_t seed = 1;
+    before = after;
+    for (int i = 0; i < 256; i++) {
+        EXPECT_OK(at24c256_read(handle, (uint16_t)(next_random(&seed) % (32768 - 16)), g_buffer, 16));
+    }
+    at24c256_sim_get_stats(handle, &after);
+    record("read_random_16", &before, &after);
+
+    // 16字节步长顺序扫描，预读合并为少量大事务
+    EXPECT_OK(at24c256_readahead_enable(handle, 0));
+    at24c256_sim_get_stats(handle, &before);
+    for (uint16_t off = 0; off < 4096; off += 16) {
+        EXPECT_OK(at24c256_read(handle, (uint16_t)(0x1000 + off), g_buffer, 16));
+    }
+    at24c256_sim_get_stats(handle, &after);
+    record("read_seq_16_readahead", &before, &after);
+
+    EXPECT_OK(at24c256_deinit(handle));
+}
+
+static void bench_write(void) {
+    at24c256_handle_t handle = open_sim();
+    at24c256_sim_stats_t before, after;
+    memset(g_buffer, 0x5A, sizeof(g_buffer));
+
+    at24c256_sim_get_stats(handle, &before);
+    EXPECT_OK(at24c256_write(handle, 0x0030, g_buffer, 1000));
+    at24c256_sim_get_stats(handle, &after);
+    record("write_unaligned_1000", &before, &after);
+
+    before = after;
+    for (int i = 0; i < 64; i++) {
+        EXPECT_OK(at24c256_write(handle, (uint16_t)(0x2000 + i * 8), g_buffer, 8));
+    }
+    at24c256_sim_get_stats(handle, &after);
+    record("write_small_seq", &before, &after);
+
+    // 回写缓存把同一页的小写入合并为一次页编程
+    EXPECT_OK(at24c256_cache_enable(handle, AT24C256_CACHE_WRITE_BACK));
+    at24c256_sim_get_stats(handle, &before);
+    for (int i = 0; i < 64; i++) {
+        EXPECT_OK(at24c256_write(handle, (uint16_t)(0x3000 + i * 8), g_buffer, 8));
+    }
+    EXPECT_OK(at24c256_flush(handle));
+    at24c256_sim_get_stats(handle, &after);
+    record("write_back_small_seq", &before, &after);
+
+    EXPECT_OK(at24c256_deinit(handle));
+}
+
+static void bench_erase(void) {
+    at24c256_handle_t handle = open_sim();
+    at24c256_sim_stats_t before, after;
+
+    at24c256_sim_get_stats(handle, &before);
+    EXPECT_OK(at24c256_erase(handle, 0x1000, 4096));
+    at24c256_sim_get_stats(handle, &after);
+    record("erase_4k", &before, &after);
+
+    EXPECT_OK(at24c256_deinit(handle));
+}
+
+static void bench_container(void) {
+    at24c256_handle_t handle = open_sim();
+    at24c256_sim_stats_t before, after;
+    at24c256_container_t container;
+    char name[16];
+    int index;
+    memset(g_buffer, 0x3C, sizeof(g_buffer));
+
+    // 准备：四个文件
+    EXPECT_OK(at24c256_container_mount(handle, &container));
+    for (int i = 0; i < 4; i++) {
+        snprintf(name, sizeof(name), "file%d.dat", i);
+        EXPECT_OK(at24c256_container_create(container, name, &index));
+        EXPECT_OK(at24c256_container_write(container, index, 0, g_buffer, 512));
+    }
+    at24c256_sim_get_stats(handle, &before);
+    EXPECT_OK(at24c256_container_unmount(container));
+    at24c256_sim_get_stats(handle, &after);
+    record("container_sync_4x512", &before, &after);
+
+    // 重新打开设备后挂载：只应读取一次索引区
+    EXPECT_OK(at24c256_deinit(handle));
+    handle = open_sim();
+    EXPECT_OK(at24c256_container_mount(handle, &container));
+    EXPECT_OK(at24c256_container_unmount(container));
+    at24c256_sim_get_stats(handle, &before);
+    EXPECT_OK(at24c256_container_mount(handle, &container));
+    at24c256_sim_get_stats(handle, &after);
+    EXPECT_OK(at24c256_container_unmount(container));
+    record("container_mount", &before, &after);
+
+    EXPECT_OK(at24c256_deinit(handle));
+}
+
+/**
+ * @brief 读取基线文件，每行：名称 bus_ns total_ns reads pages
+ */
+static int load_baseline(const char* path, bench_result_t* base, char names[][64], int max) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+
+    char line[256];
+    int n = 0;
+    while (n < max && fgets(line, sizeof(line), fp)) {
+        unsigned long long bus, total, reads, pages;
+        if (line[0] == '#' ||
+            sscanf(line, "%63s %llu %llu %llu %llu", names[n], &bus, &total, &reads, &pages) != 5) {
+            continue;
+        }
+        base[n].name = names[n];
+        base[n].bus_ns = bus;
+        base[n].total_ns = total;
+        base[n].reads = reads;
+        base[n].pages = pages;
+        n++;
+    }
+    fclose(fp);
+    return n;
+}
+
+static int save_baseline(const char* path) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        return -1;
+    }
+    fprintf(fp, "# 模拟器性能基线 (400kHz，实际写周期3.5ms，固定延时5ms)\n");
+    fprintf(fp, "# 名称 bus_ns total_ns reads pages\n");
+    for (int i = 0; i < g_count; i++) {
+        fprintf(fp, "%s %llu %llu %llu %llu\n", g_results[i].name,
+                (unsigned long long)g_results[i].bus_ns, (unsigned long long)g_results[i].total_ns,
+                (unsigned long long)g_results[i].reads, (unsigned long long)g_results[i].pages);
+    }
+    return fclose(fp);
+}
+
+/**
+ * @brief 比较一项指标，超出阈值返回1
+ */
+static int compare_metric(const char* bench, const char* metric, uint64_t value, uint64_t base,
+                          double threshold) {
+    double limit = (double)base * (1.0 + threshold);
+    if ((double)value > limit) {
+        printf("✗ %s %s: %llu 超出基线 %llu (+%.1f%%)\n", bench, metric,
+               (unsigned long long)value, (unsigned long long)base,
+               base ? ((double)value / base - 1.0) * 100.0 : 100.0);
+        return 1;
+    }
+    if (value < base) {
+        printf("  %s %s: %llu 低于基线 %llu，可用 -u 更新基线\n", bench, metric,
+               (unsigned long long)value, (unsigned long long)base);
+    }
+    return 0;
+}
+
+/**
+ * @brief 主函数
+ */
+int main(int argc, char* argv[]) {
+    double threshold = 0.05;
+    bool update = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:u")) != -1) {
+        switch (opt) {
+        case 't': threshold = strtod(optarg, NULL) / 100.0; break;
+        case 'u': update = true; break;
+        default:
+            printf("用法: %s 基线文件 [-t 阈值百分比] [-u]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        printf("用法: %s 基线文件 [-t 阈值百分比] [-u]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* path = argv[optind];
+
+    printf("模拟器性能回归门禁\n");
+    printf("==================\n");
+
+    bench_read();
+    bench_write();
+    bench_erase();
+    bench_container();
+    if (g_errors > 0) {
+        printf("✗ 基准中有 %d 次调用失败，结果无效\n", g_errors);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < g_count; i++) {
+        printf("%-24s bus=%9.3fms total=%9.3fms reads=%4llu pages=%4llu\n", g_results[i].name,
+               g_results[i].bus_ns / 1e6, g_results[i].total_ns / 1e6,
+               (unsigned long long)g_results[i].reads, (unsigned long long)g_results[i].pages);
+    }
+
+    if (update) {
+        if (save_baseline(path) != 0) {
+            printf("无法写入基线文件 %s\n", path);
+            return EXIT_FAILURE;
+        }
+        printf("\n基线已更新: %s\n", path);
+        return EXIT_SUCCESS;
+    }
+
+    static bench_result_t base[MAX_BENCHES];
+    static char names[MAX_BENCHES][64];
+    int base_count = load_baseline(path, base, names, MAX_BENCHES);
+    if (base_count < 0) {
+        printf("无法读取基线文件 %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    printf("\n=== 与基线比较 (阈值 %.1f%%) ===\n", threshold * 100.0);
+    int failures = 0;
+    for (int i = 0; i < g_count; i++) {
+        const bench_result_t* r = &g_results[i];
+        const bench_result_t* b = NULL;
+        for (int j = 0; j < base_count; j++) {
+            if (strcmp(base[j].name, r->name) == 0) {
+                b = &base[j];
+                break;
+            }
+        }
+        if (!b) {
+            printf("✗ %s: 基线中没有该项，请用 -u 更新基线\n", r->name);
+            failures++;
+            continue;
+        }
+        failures += compare_metric(r->name, "bus_ns", r->bus_ns, b->bus_ns, threshold);
+        failures += compare_metric(r->name, "total_ns", r->total_ns, b->total_ns, threshold);
+        failures += compare_metric(r->name, "reads", r->reads, b->reads, threshold);
+        failures += compare_metric(r->name, "pages", r->pages, b->pages, threshold);
+    }
+
+    if (failures == 0) {
+        printf("✓ 所有指标均在基线范围内\n");
+        return EXIT_SUCCESS;
+    }
+    printf("✗ %d 项指标退化\n", failures);
+    return EXIT_FAILURE;
+}
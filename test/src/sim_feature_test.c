@@ -0,0 +1,1175 @@
+/**
+ * @file sim_feature_test.c
+ * @brief 基于内存模拟器的功能测试程序
+ *
+ * 在内存模拟器 (虚拟时钟) 上验证访问记录 (含异步写入)、哈希目录的写入代价、时序存储、
+ * 键值存储、顺序读预读、组提交 (含与其他写入API混用)、布局建议、镜像设备对 (含单侧写入失败)、
+ * 批量读取、设备发现的参数处理、芯片内复制、截止时间与内存映射。
+ * 用模拟器的统计检查读取与编程次数、等待时间。无需硬件。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include "at24c256.h"
+#include "at24c256_ts.h"
+#include "at24c256_kv.h"
+#include "at24c256_layout.h"
+#include "at24c256_mirror.h"
+
+#define EEPROM_SIZE 32768
+
+static int g_failures = 0;
+
+#define CHECK(cond, msg) do { \
+    if (cond) { \
+        printf("✓ %s\n", msg); \
+    } else { \
+        printf("✗ %s\n", msg); \
+        g_failures++; \
+    } \
+} while (0)
+
+/**
+ * @brief 打开一个模拟器设备
+ *
+ * @param params 模拟参数，NULL表示默认参数 (初始化时复制，调用后可释放)
+ * @param handle 返回的设备句柄
+ * @return at24c256_err_t 错误码
+ */
+static at24c256_err_t open_sim(const at24c256_sim_params_t* params, at24c256_handle_t* handle) {
+    at24c256_sim_params_t sim = AT24C256_SIM_DEFAULT_PARAMS;
+    if (params) {
+        sim = *params;
+    }
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    config.sim = &sim;
+    return at24c256_init(&config, handle);
+}
+
+
+/**
+ * @brief 内存模拟器的虚拟时钟与访问记录
+ */
+static void sim_trace_test(void) {
+    printf("\n=== 模拟器与访问记录测试 ===\n");
+
+    char trace_path[] = "/tmp/at24c256_trace_XXXXXX";
+    int fd = mkstemp(trace_path);
+    if (fd < 0) {
+        CHECK(0, "创建记录文件");
+        return;
+    }
+    close(fd);
+
+    uint8_t data[100];
+    uint8_t back[100];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i ^ 0x5A);
+    }
+
+    at24c256_handle_t handle;
+    at24c256_sim_stats_t stats;
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK, "模拟器初始化");
+    CHECK(at24c256_trace_start(handle, trace_path) == AT24C256_OK, "开始记录");
+
+    // 0x0030起100字节跨3页，固定延时模式每页等待5ms
+    CHECK(at24c256_write(handle, 0x0030, data, sizeof(data)) == AT24C256_OK, "跨页写入");
+    CHECK(at24c256_read(handle, 0x0030, back, sizeof(back)) == AT24C256_OK &&
+          memcmp(back, data, sizeof(data)) == 0, "读回数据");
+    CHECK(at24c256_sim_get_stats(handle, &stats) == AT24C256_OK && stats.pages == 3 &&
+          stats.reads == 1 && stats.wait_ns == 3 * 5000000ULL, "虚拟时钟计入写周期");
+    CHECK(at24c256_sim_advance(handle, 1000000) == AT24C256_OK, "推进空闲时间");
+    CHECK(at24c256_erase(handle, 0x1000, 64) == AT24C256_OK, "擦除");
+    CHECK(at24c256_trace_stop(handle) == AT24C256_OK, "停止记录");
+    at24c256_deinit(handle);
+
+    at24c256_trace_info_t info;
+    at24c256_trace_record_t* records = NULL;
+    uint32_t count = 0;
+    CHECK(at24c256_trace_load(trace_path, &info, &records, &count) == AT24C256_OK &&
+          info.page_size == 64 && info.total_size == EEPROM_SIZE, "读取记录文件");
+    CHECK(count == 3 && records[0].op == AT24C256_TRACE_WRITE &&
+          records[1].op == AT24C256_TRACE_READ && records[2].op == AT24C256_TRACE_ERASE,
+          "记录顶层操作 (擦除不重复记录为写入)");
+    CHECK(count == 3 && records[0].address == 0x0030 && records[0].length == 100 &&
+          records[0].start_ns == 0 && records[0].duration_ns > 3 * 5000000U, "记录地址与耗时");
+    CHECK(count == 3 && records[2].start_ns >= records[1].start_ns + records[1].duration_ns +
+          1000000, "记录空闲间隔");
+    free(records);
+    unlink(trace_path);
+
+    // 应答查询：空闲期间结束的写周期不再等待
+    at24c256_sim_params_t sim = AT24C256_SIM_DEFAULT_PARAMS;
+    sim.wait = AT24C256_SIM_WAIT_POLL;
+    CHECK(open_sim(&sim, &handle) == AT24C256_OK, "应答查询模式初始化");
+    CHECK(at24c256_write(handle, 0x0030, data, sizeof(data)) == AT24C256_OK, "跨页写入");
+    CHECK(at24c256_sim_get_stats(handle, &stats) == AT24C256_OK && stats.wait_ns == 0 &&
+          stats.polls > 0 && stats.now_ns < 3 * 5000000ULL, "页间应答查询");
+    at24c256_sim_advance(handle, 10000000);
+    uint32_t polls = stats.polls;
+    CHECK(at24c256_read(handle, 0, back, 1) == AT24C256_OK &&
+          at24c256_sim_get_stats(handle, &stats) == AT24C256_OK && stats.polls == polls,
+          "空闲后访问无需查询");
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 异步写入同样计入访问记录与布局统计
+ */
+static void async_hooks_test(void) {
+    printf("\n=== 异步写入钩子测试 ===\n");
+
+    char trace_path[] = "/tmp/at24c256_trace_XXXXXX";
+    int fd = mkstemp(trace_path);
+    if (fd < 0) {
+        CHECK(0, "创建记录文件");
+        return;
+    }
+    close(fd);
+
+    at24c256_handle_t handle;
+    at24c256_field_t field = { .address = 0x0040, .length = 8 };
+    at24c256_field_stats_t stats;
+    uint8_t data[100];
+    memset(data, 0x3C, sizeof(data));
+
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK &&
+          at24c256_trace_start(handle, trace_path) == AT24C256_OK &&
+          at24c256_layout_track(handle, &field, 1) == AT24C256_OK, "初始化");
+
+    // 0x0030起100字节跨3页，无缓存时由异步引擎逐页编程
+    int afd = at24c256_async_fd(handle);
+    at24c256_err_t result = AT24C256_ERROR_TIMEOUT;
+    CHECK(afd >= 0 && at24c256_async_write(handle, 0x0030, data, sizeof(data), NULL, NULL) ==
+          AT24C256_OK, "提交写入");
+    struct pollfd pfd = { .fd = afd, .events = POLLIN };
+    while (at24c256_async_pending(handle) > 0 && poll(&pfd, 1, 1000) > 0) {
+        at24c256_completion_t done;
+        if (at24c256_poll_completions(handle, &done, 1) == 1) {
+            result = done.result;
+        }
+    }
+    CHECK(result == AT24C256_OK, "异步写入完成");
+    CHECK(at24c256_layout_field_stats(handle, 0, &stats) == AT24C256_OK && stats.writes == 1,
+          "计入布局统计");
+    CHECK(at24c256_trace_stop(handle) == AT24C256_OK, "停止记录");
+    at24c256_deinit(handle);
+
+    at24c256_trace_info_t info;
+    at24c256_trace_record_t* records = NULL;
+    uint32_t count = 0;
+    CHECK(at24c256_trace_load(trace_path, &info, &records, &count) == AT24C256_OK && count == 3 &&
+          records[0].op == AT24C256_TRACE_PROGRAM_PAGE && records[0].address == 0x0030 &&
+          records[0].length == 16 && records[1].length == 64 && records[2].address == 0x0080 &&
+          records[2].length == 20, "每页编程计入访问记录");
+    free(records);
+    unlink(trace_path);
+}
+
+/**
+ * @brief 哈希目录的写入代价：每个会话每个区域清零一次，flush时统一更新
+ */
+static void hashdir_cost_test(void) {
+    printf("\n=== 哈希目录写入代价测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_sim_stats_t before, after;
+    bool ok = true;
+
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK &&
+          at24c256_hashdir_enable(handle, AT24C256_HASHDIR_AT_END) == AT24C256_OK, "建立哈希目录");
+
+    // 同一区域内的10次1字节写入：第一次前清零哈希 (一页)，之后每次只编程数据
+    at24c256_sim_get_stats(handle, &before);
+    for (int i = 0; i < 10; i++) {
+        uint8_t value = (uint8_t)i;
+        ok = ok && at24c256_write(handle, (uint16_t)(0x1400 + i * 64), &value, 1) == AT24C256_OK;
+    }
+    at24c256_sim_get_stats(handle, &after);
+    printf("  10次写入：%u次页编程\n", after.pages - before.pages);
+    CHECK(ok && after.pages - before.pages == 11, "会话内只清零一次哈希");
+
+    at24c256_sim_get_stats(handle, &before);
+    CHECK(at24c256_flush(handle) == AT24C256_OK, "flush");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.pages - before.pages == 1, "flush时一次写入新哈希");
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 时序存储：压缩率、按时间窗口只读取相关块、重新打开与循环覆盖
+ */
+static void ts_test(void) {
+    printf("\n=== 时序存储测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_ts_t ts;
+    at24c256_ts_info_t info;
+    at24c256_sim_stats_t before, after;
+    static at24c256_ts_sample_t out[256];
+    uint32_t count = 0;
+    bool ok = true;
+
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK, "模拟器初始化");
+    CHECK(at24c256_ts_open(handle, 0x4000, 0x4000, &ts) == AT24C256_OK, "打开空区域");
+
+    // 每10秒一个采样，温度每50个采样变化0.5度
+    for (uint32_t i = 0; i < 2000 && ok; i++) {
+        ok = at24c256_ts_append(ts, 1000 + i * 10, 20.0f + (float)(i / 50) * 0.5f) == AT24C256_OK;
+    }
+    CHECK(ok, "追加2000个采样");
+    CHECK(at24c256_ts_append(ts, 999, 0.0f) == AT24C256_ERROR_PARAM, "拒绝倒退的时间戳");
+    CHECK(at24c256_ts_flush(ts) == AT24C256_OK && at24c256_ts_info(ts, &info) == AT24C256_OK &&
+          info.samples == 2000 && info.first_ts == 1000 && info.last_ts == 1000 + 1999 * 10,
+          "存储状态");
+    printf("  %u个采样占用%u块 (原始%u字节，压缩后%u字节)\n", info.samples, info.blocks_used,
+           info.samples * 8, info.blocks_used * 64);
+    CHECK(info.samples * 8 >= info.blocks_used * 64 * 5, "压缩率不低于5倍");
+
+    at24c256_sim_get_stats(handle, &before);
+    CHECK(at24c256_ts_query(ts, 1000 + 500 * 10, 1000 + 599 * 10, out, 256, &count) == AT24C256_OK &&
+          count == 100 && out[0].timestamp == 6000 && out[99].timestamp == 6990 &&
+          out[0].value == 25.0f && out[99].value == 25.5f, "时间窗口查询");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.reads - before.reads <= 3, "只读取窗口内的块");
+    CHECK(at24c256_ts_close(ts) == AT24C256_OK, "关闭");
+
+    // 重新打开：只读块头恢复索引，并在最新块后继续追加
+    CHECK(at24c256_ts_open(handle, 0x4000, 0x4000, &ts) == AT24C256_OK &&
+          at24c256_ts_info(ts, &info) == AT24C256_OK && info.samples == 2000, "重新打开");
+    CHECK(at24c256_ts_append(ts, 1000 + 2000 * 10, 50.0f) == AT24C256_OK &&
+          at24c256_ts_query(ts, 20990, 21000, out, 256, &count) == AT24C256_OK && count == 2 &&
+          out[0].value == 39.5f && out[1].value == 50.0f, "继续追加");
+    CHECK(at24c256_ts_close(ts) == AT24C256_OK, "关闭");
+
+    // 区域写满后覆盖最旧的块
+    CHECK(at24c256_ts_open(handle, 0x0000, 4 * 64, &ts) == AT24C256_OK, "打开4块的区域");
+    ok = true;
+    for (uint32_t i = 0; i < 5000 && ok; i++) {
+        ok = at24c256_ts_append(ts, i, (float)(i % 7)) == AT24C256_OK;
+    }
+    CHECK(ok && at24c256_ts_info(ts, &info) == AT24C256_OK && info.blocks_used == 4 &&
+          info.first_ts > 0 && info.last_ts == 4999, "循环覆盖最旧的块");
+    CHECK(at24c256_ts_query(ts, 4990, 4999, out, 256, &count) == AT24C256_OK && count == 10 &&
+          out[9].value == (float)(4999 % 7), "查询最新数据");
+    at24c256_ts_close(ts);
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 键值存储：读取的访问次数、更新只编程相关页、掉电恢复与空间不足
+ */
+static void kv_test(void) {
+    printf("\n=== 键值存储测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_kv_t kv;
+    at24c256_sim_stats_t before, after;
+    char key[16];
+    char value[32];
+    uint8_t raw[32];
+    uint16_t length = 0;
+    bool ok = true;
+
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK, "模拟器初始化");
+    CHECK(at24c256_kv_mount(handle, 0x6000, 0x800, 32, &kv) == AT24C256_OK &&
+          at24c256_kv_count(kv) == 0, "挂载空区域");
+    CHECK(at24c256_kv_mount(handle, 0x6000, 0x800, 24, &kv) == AT24C256_ERROR_PARAM,
+          "拒绝不是2的幂的槽大小");
+    for (int i = 0; i < 40 && ok; i++) {
+        snprintf(key, sizeof(key), "key%02d", i);
+        snprintf(value, sizeof(value), "value-%d", i);
+        ok = at24c256_kv_put(kv, key, value, (uint16_t)strlen(value)) == AT24C256_OK;
+    }
+    CHECK(ok && at24c256_kv_count(kv) == 40, "写入40个键");
+    CHECK(at24c256_kv_put(kv, "a-key-that-is-far-too-long", "xyz", 3) == AT24C256_ERROR_PARAM,
+          "拒绝放不进一个槽的记录");
+    at24c256_kv_unmount(kv);
+
+    // 重新挂载：一次读取整个区域
+    at24c256_sim_get_stats(handle, &before);
+    CHECK(at24c256_kv_mount(handle, 0x6000, 0x800, 32, &kv) == AT24C256_OK &&
+          at24c256_kv_count(kv) == 40, "重新挂载");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.reads - before.reads == 1, "挂载只读取一次");
+
+    before = after;
+    memset(value, 0, sizeof(value));
+    CHECK(at24c256_kv_get(kv, "key17", value, sizeof(value), &length) == AT24C256_OK &&
+          length == 8 && memcmp(value, "value-17", 8) == 0, "读取存在的键");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.reads - before.reads == 1, "读取存在的键只读一个槽");
+
+    before = after;
+    ok = true;
+    for (int i = 0; i < 100 && ok; i++) {
+        snprintf(key, sizeof(key), "missing%d", i);
+        ok = at24c256_kv_get(kv, key, value, sizeof(value), &length) == AT24C256_ERROR_NOT_FOUND;
+    }
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(ok && after.reads == before.reads, "不存在的键不访问芯片");
+
+    before = after;
+    CHECK(at24c256_kv_put(kv, "key05", "updated", 7) == AT24C256_OK &&
+          at24c256_kv_get(kv, "key05", value, sizeof(value), &length) == AT24C256_OK &&
+          length == 7 && memcmp(value, "updated", 7) == 0, "更新键");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.pages - before.pages <= 2, "更新只编程新记录与旧记录所在的页");
+
+    before = after;
+    CHECK(at24c256_kv_put(kv, "key05", "updated", 7) == AT24C256_OK, "写入相同的值");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.pages == before.pages, "值未变时不编程");
+
+    CHECK(at24c256_kv_delete(kv, "key07") == AT24C256_OK &&
+          at24c256_kv_get(kv, "key07", value, sizeof(value), &length) == AT24C256_ERROR_NOT_FOUND &&
+          at24c256_kv_delete(kv, "key07") == AT24C256_ERROR_NOT_FOUND &&
+          at24c256_kv_count(kv) == 39, "删除键");
+    at24c256_kv_unmount(kv);
+    CHECK(at24c256_kv_mount(handle, 0x6000, 0x800, 32, &kv) == AT24C256_OK &&
+          at24c256_kv_count(kv) == 39 &&
+          at24c256_kv_get(kv, "key05", value, sizeof(value), &length) == AT24C256_OK &&
+          memcmp(value, "updated", 7) == 0, "删除与更新在重新挂载后保留");
+    at24c256_kv_unmount(kv);
+
+    // 模拟更新中途掉电：旧记录未被释放，两条记录同时有效
+    CHECK(at24c256_kv_mount(handle, 0x7000, 4 * 32, 32, &kv) == AT24C256_OK &&
+          at24c256_kv_put(kv, "mode", "old", 3) == AT24C256_OK &&
+          at24c256_read(handle, 0x7000, raw, sizeof(raw)) == AT24C256_OK &&
+          at24c256_kv_put(kv, "mode", "new", 3) == AT24C256_OK &&
+          at24c256_write(handle, 0x7000, raw, sizeof(raw)) == AT24C256_OK, "构造两条有效记录");
+    at24c256_kv_unmount(kv);
+    CHECK(at24c256_kv_mount(handle, 0x7000, 4 * 32, 32, &kv) == AT24C256_OK &&
+          at24c256_kv_count(kv) == 1 &&
+          at24c256_kv_get(kv, "mode", value, sizeof(value), &length) == AT24C256_OK &&
+          memcmp(value, "new", 3) == 0, "挂载保留较新的记录");
+    CHECK(at24c256_read(handle, 0x7000, raw, 1) == AT24C256_OK && raw[0] == 0xFF,
+          "挂载释放较旧的记录");
+
+    CHECK(at24c256_kv_put(kv, "b", "2", 1) == AT24C256_OK &&
+          at24c256_kv_put(kv, "c", "3", 1) == AT24C256_OK &&
+          at24c256_kv_put(kv, "d", "4", 1) == AT24C256_OK &&
+          at24c256_kv_put(kv, "e", "5", 1) == AT24C256_ERROR_MEMORY, "槽用完时返回空间不足");
+    at24c256_kv_unmount(kv);
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 顺序读预读：小步长顺序扫描合并为少量大事务，随机读取不多读，写入后内容一致
+ */
+static void readahead_test(void) {
+    printf("\n=== 顺序读预读测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_sim_stats_t before, after;
+    static uint8_t pattern[4096];
+    uint8_t chunk[32];
+    bool ok = true;
+
+    for (size_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = (uint8_t)(i * 7 + 3);
+    }
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK &&
+          at24c256_write(handle, 0x2000, pattern, sizeof(pattern)) == AT24C256_OK, "写入测试数据");
+    CHECK(at24c256_readahead_enable(handle, 16) == AT24C256_ERROR_PARAM, "拒绝小于一页的窗口");
+    CHECK(at24c256_readahead_enable(handle, 0) == AT24C256_OK, "启用预读");
+
+    // 16字节步长顺序扫描4KB
+    at24c256_sim_get_stats(handle, &before);
+    for (uint16_t off = 0; off < sizeof(pattern) && ok; off += 16) {
+        ok = at24c256_read(handle, (uint16_t)(0x2000 + off), chunk, 16) == AT24C256_OK &&
+             memcmp(chunk, pattern + off, 16) == 0;
+    }
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(ok, "顺序扫描内容正确");
+    printf("  256次16字节读取产生%llu次读事务\n", (unsigned long long)(after.reads - before.reads));
+    CHECK(after.reads - before.reads <= 10, "顺序扫描合并为少量大事务");
+
+    // 随机读取：每次一个事务，只传输请求的字节 (20字节 × 9位 × 2.5us)
+    before = after;
+    for (int i = 0; i < 16; i++) {
+        at24c256_read(handle, (uint16_t)(0x0100 + i * 997 % 8192), chunk, 16);
+    }
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.reads - before.reads == 16 && after.bus_ns - before.bus_ns == 16 * 20 * 9 * 2500ULL,
+          "随机读取不预读");
+
+    // 缓冲区中的内容随写入更新
+    CHECK(at24c256_read(handle, 0x2000, chunk, 16) == AT24C256_OK &&
+          at24c256_read(handle, 0x2010, chunk, 16) == AT24C256_OK, "重新开始顺序读取");
+    memset(chunk, 0xEE, sizeof(chunk));
+    CHECK(at24c256_write(handle, 0x2020, chunk, 8) == AT24C256_OK &&
+          at24c256_read(handle, 0x2020, chunk, 16) == AT24C256_OK &&
+          chunk[0] == 0xEE && chunk[7] == 0xEE && chunk[8] == pattern[0x28], "写入后缓冲区一致");
+    CHECK(at24c256_readahead_disable(handle) == AT24C256_OK, "关闭预读");
+    at24c256_deinit(handle);
+}
+
+#define GROUP_WRITERS 4
+#define GROUP_ROUNDS 10
+
+typedef struct {
+    at24c256_handle_t handle;
+    int id;
+    bool ok;
+} group_writer_t;
+
+/**
+ * @brief 组提交测试的写入线程：每轮写入同一页中自己的4字节
+ */
+static void* group_writer(void* arg) {
+    group_writer_t* w = (group_writer_t*)arg;
+    uint8_t field[4];
+    w->ok = true;
+    for (int round = 0; round < GROUP_ROUNDS; round++) {
+        memset(field, w->id * 16 + round, sizeof(field));
+        if (at24c256_write(w->handle, (uint16_t)(0x5000 + w->id * 8), field, 4) != AT24C256_OK) {
+            w->ok = false;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 组提交：多个线程写同一页时合并为少量页编程，空隙保持原有内容
+ */
+static void group_commit_test(void) {
+    printf("\n=== 组提交测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_sim_stats_t before, after;
+    pthread_t threads[GROUP_WRITERS];
+    group_writer_t writers[GROUP_WRITERS];
+    uint8_t page[64];
+    bool ok = true;
+
+    // 每个线程的字段与其后的空隙各登记为一个字段
+    at24c256_field_t fields[GROUP_WRITERS * 2];
+    at24c256_field_stats_t stats;
+    for (int i = 0; i < GROUP_WRITERS * 2; i++) {
+        fields[i] = (at24c256_field_t){ .address = (uint16_t)(0x5000 + i * 4), .length = 4 };
+    }
+
+    memset(page, 0x11, sizeof(page));
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK &&
+          at24c256_write(handle, 0x5000, page, sizeof(page)) == AT24C256_OK, "准备数据");
+    CHECK(at24c256_layout_track(handle, fields, GROUP_WRITERS * 2) == AT24C256_OK &&
+          at24c256_group_commit_enable(handle, 5000) == AT24C256_OK, "登记字段并启用组提交");
+
+    at24c256_sim_get_stats(handle, &before);
+    for (int i = 0; i < GROUP_WRITERS; i++) {
+        writers[i].handle = handle;
+        writers[i].id = i;
+        pthread_create(&threads[i], NULL, group_writer, &writers[i]);
+    }
+    for (int i = 0; i < GROUP_WRITERS; i++) {
+        pthread_join(threads[i], NULL);
+        ok = ok && writers[i].ok;
+    }
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(ok, "所有写入成功");
+    printf("  %d次写入产生%llu次页编程\n", GROUP_WRITERS * GROUP_ROUNDS,
+           (unsigned long long)(after.pages - before.pages));
+    CHECK(after.pages - before.pages < GROUP_WRITERS * GROUP_ROUNDS / 2, "同一页的写入合并编程");
+
+    ok = true;
+    for (int i = 0; i < GROUP_WRITERS * 2; i++) {
+        uint32_t writes = i % 2 == 0 ? GROUP_ROUNDS : 0;
+        ok = ok && at24c256_layout_field_stats(handle, i, &stats) == AT24C256_OK &&
+             stats.writes == writes && stats.reads == 0;
+    }
+    CHECK(ok, "布局统计只计入每次写入，不计入合并编程与空隙读取");
+
+    CHECK(at24c256_group_commit_disable(handle) == AT24C256_OK &&
+          at24c256_read(handle, 0x5000, page, sizeof(page)) == AT24C256_OK, "关闭组提交并读回");
+    ok = true;
+    for (int i = 0; i < GROUP_WRITERS; i++) {
+        for (int j = 0; j < 8; j++) {
+            uint8_t expect = j < 4 ? (uint8_t)(i * 16 + GROUP_ROUNDS - 1) : 0x11;
+            ok = ok && page[i * 8 + j] == expect;
+        }
+    }
+    CHECK(ok && page[GROUP_WRITERS * 8] == 0x11, "每个线程的最后一次写入生效，空隙不变");
+    at24c256_deinit(handle);
+}
+
+typedef struct {
+    at24c256_handle_t handle;
+    uint16_t address;
+    uint8_t value;
+    at24c256_err_t result;
+} group_single_t;
+
+/**
+ * @brief 在另一个线程中写入4字节 (成为提交线程并等待收集窗口)
+ */
+static void* group_single(void* arg) {
+    group_single_t* w = (group_single_t*)arg;
+    uint8_t field[4];
+    memset(field, w->value, sizeof(field));
+    w->result = at24c256_write(w->handle, w->address, field, sizeof(field));
+    return NULL;
+}
+
+/**
+ * @brief 在收集窗口内调用op，返回这一批的页编程次数
+ */
+static uint64_t group_batch_pages(at24c256_handle_t handle, group_single_t* w,
+                                  at24c256_err_t (*op)(at24c256_handle_t), at24c256_err_t* result) {
+    at24c256_sim_stats_t before, after;
+    pthread_t thread;
+    at24c256_sim_get_stats(handle, &before);
+    pthread_create(&thread, NULL, group_single, w);
+    usleep(2000);
+    *result = op(handle);
+    pthread_join(thread, NULL);
+    at24c256_sim_get_stats(handle, &after);
+    return after.pages - before.pages;
+}
+
+static at24c256_err_t mixed_program_page(at24c256_handle_t handle) {
+    uint8_t field[4] = { 0xB2, 0xB2, 0xB2, 0xB2 };
+    return at24c256_program_page(handle, 0x5108, field, sizeof(field));
+}
+
+static at24c256_err_t mixed_erase(at24c256_handle_t handle) {
+    return at24c256_erase(handle, 0x5110, 4);
+}
+
+static at24c256_err_t mixed_async_write(at24c256_handle_t handle) {
+    static uint8_t field[4] = { 0xC4, 0xC4, 0xC4, 0xC4 };
+    at24c256_err_t result = at24c256_async_write(handle, 0x5118, field, sizeof(field), NULL, NULL);
+    struct pollfd pfd = { .fd = at24c256_async_fd(handle), .events = POLLIN };
+    while (result == AT24C256_OK && at24c256_async_pending(handle) > 0 &&
+           poll(&pfd, 1, 1000) > 0) {
+        at24c256_completion_t done;
+        if (at24c256_poll_completions(handle, &done, 1) == 1) {
+            result = done.result;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 组提交时按页编程、擦除与异步写入也并入暂存区，不与提交线程同时编程
+ */
+static void group_mixed_test(void) {
+    printf("\n=== 组提交与其他写入API测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_err_t result;
+    uint8_t page[64];
+    memset(page, 0x11, sizeof(page));
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK &&
+          at24c256_write(handle, 0x5100, page, sizeof(page)) == AT24C256_OK &&
+          at24c256_group_commit_enable(handle, 20000) == AT24C256_OK, "准备数据并启用组提交");
+
+    group_single_t w = { .handle = handle, .address = 0x5100, .value = 0xA1 };
+    uint64_t pages = group_batch_pages(handle, &w, mixed_program_page, &result);
+    CHECK(w.result == AT24C256_OK && result == AT24C256_OK && pages == 1,
+          "按页编程与写入合并为一次页编程");
+
+    w.value = 0xA2;
+    pages = group_batch_pages(handle, &w, mixed_erase, &result);
+    CHECK(w.result == AT24C256_OK && result == AT24C256_OK && pages == 1,
+          "擦除与写入合并为一次页编程");
+
+    w.value = 0xA3;
+    pages = group_batch_pages(handle, &w, mixed_async_write, &result);
+    CHECK(w.result == AT24C256_OK && result == AT24C256_OK && pages == 1,
+          "异步写入与写入合并为一次页编程");
+
+    CHECK(at24c256_group_commit_disable(handle) == AT24C256_OK &&
+          at24c256_read(handle, 0x5100, page, sizeof(page)) == AT24C256_OK, "关闭组提交并读回");
+    bool ok = true;
+    for (int i = 0; i < (int)sizeof(page); i++) {
+        uint8_t expect = i < 4 ? 0xA3 : i >= 0x08 && i < 0x0C ? 0xB2 :
+                         i >= 0x10 && i < 0x14 ? 0xFF : i >= 0x18 && i < 0x1C ? 0xC4 : 0x11;
+        ok = ok && page[i] == expect;
+    }
+    CHECK(ok, "所有写入生效，空隙不变");
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 用回写缓存执行一次更新：写入mask中的字段后flush
+ */
+static bool layout_update(at24c256_handle_t handle, const at24c256_field_t* fields,
+                          unsigned mask, uint8_t value) {
+    uint8_t data[8];
+    bool ok = at24c256_layout_update_begin(handle) == AT24C256_OK;
+    memset(data, value, sizeof(data));
+    for (int i = 0; i < 8; i++) {
+        if (mask >> i & 1) {
+            ok = ok && at24c256_write(handle, fields[i].address, data, fields[i].length) == AT24C256_OK;
+        }
+    }
+    return ok && at24c256_layout_update_end(handle) == AT24C256_OK &&
+           at24c256_flush(handle) == AT24C256_OK;
+}
+
+/**
+ * @brief 布局建议：一起更新的字段聚到同一页，迁移后每次更新编程的页数减少
+ */
+static void layout_test(void) {
+    printf("\n=== 布局建议测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_sim_stats_t before, after;
+    at24c256_field_t fields[8];
+    at24c256_field_t layout[8];
+    at24c256_field_stats_t stats;
+    at24c256_layout_report_t report;
+    uint8_t data[8];
+    bool ok = true;
+
+    // 8个字段分散在8个页中，内容各不相同
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK &&
+          at24c256_cache_enable(handle, AT24C256_CACHE_WRITE_BACK) == AT24C256_OK, "初始化");
+    for (int i = 0; i < 8; i++) {
+        fields[i].address = (uint16_t)(i * 0x100 + 0x10);
+        fields[i].length = 8;
+        memset(data, 0xA0 + i, sizeof(data));
+        ok = ok && at24c256_write(handle, fields[i].address, data, 8) == AT24C256_OK;
+    }
+    CHECK(ok && at24c256_flush(handle) == AT24C256_OK, "写入字段初值");
+
+    fields[7].address = fields[6].address + 4;
+    CHECK(at24c256_layout_track(handle, fields, 8) == AT24C256_ERROR_PARAM, "拒绝重叠的字段");
+    fields[7].address = 0x0710;
+    CHECK(at24c256_layout_track(handle, fields, 8) == AT24C256_OK, "登记字段");
+
+    // {0,3,5} 一起更新100次，{1,6} 一起更新50次，其余只读
+    ok = true;
+    for (int i = 0; i < 100; i++) {
+        ok = ok && layout_update(handle, fields, 0x29, (uint8_t)i);
+    }
+    for (int i = 0; i < 50; i++) {
+        ok = ok && layout_update(handle, fields, 0x42, (uint8_t)i);
+    }
+    CHECK(ok && at24c256_read(handle, fields[2].address, data, 8) == AT24C256_OK, "记录更新");
+    CHECK(at24c256_layout_field_stats(handle, 0, &stats) == AT24C256_OK &&
+          stats.writes == 100 && stats.reads == 0, "热字段的统计");
+    CHECK(at24c256_layout_field_stats(handle, 2, &stats) == AT24C256_OK &&
+          stats.writes == 0 && stats.reads == 1, "冷字段的统计");
+
+    CHECK(at24c256_layout_advise(handle, 0x1000, 32, layout, NULL) == AT24C256_ERROR_MEMORY,
+          "区域放不下时报错");
+    CHECK(at24c256_layout_advise(handle, 0x1000, 0x200, layout, &report) == AT24C256_OK,
+          "给出建议布局");
+    printf("  %u次更新：%llu页 -> %llu页\n", report.updates,
+           (unsigned long long)report.pages_before, (unsigned long long)report.pages_after);
+    CHECK(report.updates == 150 && report.hot_fields == 5 &&
+          report.pages_before == 400 && report.pages_after == 150, "估算的页数");
+    CHECK(layout[0].address / 64 == layout[3].address / 64 &&
+          layout[0].address / 64 == layout[5].address / 64 &&
+          layout[1].address / 64 == layout[6].address / 64, "一起更新的字段在同一页");
+    CHECK(layout[2].address >= 0x1040 && layout[4].address == layout[2].address + 8 &&
+          layout[7].address == layout[4].address + 8, "冷字段按原顺序放在其后");
+
+    // 迁移后重放同样的更新
+    at24c256_sim_get_stats(handle, &before);
+    for (int i = 0; i < 10; i++) {
+        layout_update(handle, fields, 0x29, (uint8_t)(0x50 + i));
+    }
+    at24c256_sim_get_stats(handle, &after);
+    uint64_t old_pages = after.pages - before.pages;
+
+    CHECK(at24c256_layout_migrate(handle, layout) == AT24C256_OK &&
+          at24c256_flush(handle) == AT24C256_OK, "迁移");
+    ok = true;
+    for (int i = 0; i < 8; i++) {
+        uint8_t expect = i == 0 || i == 3 || i == 5 ? 0x59 : i == 1 || i == 6 ? 49 : (uint8_t)(0xA0 + i);
+        ok = ok && at24c256_read(handle, layout[i].address, data, 8) == AT24C256_OK &&
+             data[0] == expect && data[7] == expect;
+    }
+    CHECK(ok, "字段内容搬到新位置");
+
+    at24c256_sim_get_stats(handle, &before);
+    for (int i = 0; i < 10; i++) {
+        layout_update(handle, layout, 0x29, (uint8_t)(0x60 + i));
+    }
+    at24c256_sim_get_stats(handle, &after);
+    printf("  10次更新：迁移前%llu次页编程，迁移后%llu次\n", (unsigned long long)old_pages,
+           (unsigned long long)(after.pages - before.pages));
+    CHECK(old_pages == 30 && after.pages - before.pages == 10, "迁移后每次更新只编程一页");
+    CHECK(at24c256_layout_field_stats(handle, 0, &stats) == AT24C256_OK && stats.writes == 120,
+          "按新位置继续统计");
+    CHECK(at24c256_erase(handle, layout[2].address, 8) == AT24C256_OK &&
+          at24c256_layout_field_stats(handle, 2, &stats) == AT24C256_OK && stats.writes == 1,
+          "擦除计入统计");
+    CHECK(at24c256_program_page(handle, layout[4].address, data, 1) == AT24C256_OK &&
+          at24c256_layout_field_stats(handle, 4, &stats) == AT24C256_OK && stats.writes == 1,
+          "单页编程计入统计");
+    CHECK(at24c256_layout_untrack(handle) == AT24C256_OK, "停止统计");
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 镜像测试的校验：每16字节记录的最后一个字节是前15字节之和
+ */
+static bool mirror_verify(uint16_t address, const uint8_t* data, uint16_t length, void* ctx) {
+    (void)ctx;
+    for (uint32_t off = (16 - address % 16) % 16; off + 16 <= length; off += 16) {
+        uint8_t sum = 0;
+        for (int i = 0; i < 15; i++) {
+            sum += data[off + i];
+        }
+        if (sum != data[off + 15]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#define MIRROR_READERS 2
+
+typedef struct {
+    at24c256_mirror_t mirror;
+    bool ok;
+} mirror_reader_t;
+
+static void* mirror_reader(void* arg) {
+    mirror_reader_t* r = (mirror_reader_t*)arg;
+    uint8_t record[16];
+    r->ok = true;
+    for (int i = 0; i < 50; i++) {
+        r->ok = r->ok && at24c256_mirror_read(r->mirror, (uint16_t)(0x3000 + i * 16 % 2048),
+                                              record, 16) == AT24C256_OK;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 镜像设备对：写入两份、长读取分给两个设备、校验失败时改读另一份
+ */
+static void mirror_test(void) {
+    printf("\n=== 镜像设备对测试 ===\n");
+
+    at24c256_handle_t a, b;
+    at24c256_mirror_t mirror;
+    at24c256_mirror_stats_t stats;
+    at24c256_sim_stats_t a0, a1, b0, b1;
+    static uint8_t records[2048];
+    static uint8_t data[2048];
+    bool ok = true;
+
+    for (size_t off = 0; off < sizeof(records); off += 16) {
+        uint8_t sum = 0;
+        for (int i = 0; i < 15; i++) {
+            records[off + i] = (uint8_t)(off / 16 * 3 + i);
+            sum += records[off + i];
+        }
+        records[off + 15] = sum;
+    }
+
+    CHECK(open_sim(NULL, &a) == AT24C256_OK && open_sim(NULL, &b) == AT24C256_OK,
+          "初始化两个设备");
+    CHECK(at24c256_mirror_open(a, a, NULL, NULL, &mirror) == AT24C256_ERROR_PARAM,
+          "拒绝同一个设备");
+    CHECK(at24c256_mirror_open(a, b, mirror_verify, NULL, &mirror) == AT24C256_OK, "打开镜像");
+    CHECK(at24c256_mirror_write(mirror, 0x3000, records, sizeof(records)) == AT24C256_OK, "写入镜像");
+    CHECK(at24c256_read(a, 0x3000, data, sizeof(data)) == AT24C256_OK &&
+          memcmp(data, records, sizeof(data)) == 0 &&
+          at24c256_read(b, 0x3000, data, sizeof(data)) == AT24C256_OK &&
+          memcmp(data, records, sizeof(data)) == 0, "两个设备内容相同");
+
+    // 长读取：两个设备各读一半，总线时间取较慢的一个
+    at24c256_sim_get_stats(a, &a0);
+    at24c256_sim_get_stats(b, &b0);
+    memset(data, 0, sizeof(data));
+    CHECK(at24c256_mirror_read(mirror, 0x3000, data, sizeof(data)) == AT24C256_OK &&
+          memcmp(data, records, sizeof(data)) == 0, "分开读取内容正确");
+    at24c256_sim_get_stats(a, &a1);
+    at24c256_sim_get_stats(b, &b1);
+    uint64_t single = (uint64_t)(sizeof(data) + 4) * 9 * 2500;
+    uint64_t slowest = a1.bus_ns - a0.bus_ns > b1.bus_ns - b0.bus_ns ? a1.bus_ns - a0.bus_ns
+                                                                     : b1.bus_ns - b0.bus_ns;
+    printf("  2KB读取：单设备%.2fms，镜像%.2fms\n", single / 1e6, slowest / 1e6);
+    CHECK(slowest * 10 < single * 6, "读取时间接近减半");
+
+    // 并发短读取分到两个设备
+    pthread_t threads[MIRROR_READERS];
+    mirror_reader_t readers[MIRROR_READERS];
+    for (int i = 0; i < MIRROR_READERS; i++) {
+        readers[i].mirror = mirror;
+        pthread_create(&threads[i], NULL, mirror_reader, &readers[i]);
+    }
+    for (int i = 0; i < MIRROR_READERS; i++) {
+        pthread_join(threads[i], NULL);
+        ok = ok && readers[i].ok;
+    }
+    CHECK(at24c256_mirror_get_stats(mirror, &stats) == AT24C256_OK, "获取统计");
+    printf("  设备0读取%llu次，设备1读取%llu次\n", (unsigned long long)stats.reads[0],
+           (unsigned long long)stats.reads[1]);
+    CHECK(ok && stats.reads[0] >= 40 && stats.reads[1] >= 40, "短读取分到两个设备");
+
+    // 一个设备上的记录损坏：改从另一个设备读取
+    uint8_t bad[16];
+    memset(bad, 0x00, sizeof(bad));
+    bad[0] = 1;
+    CHECK(at24c256_write(b, 0x3400, bad, sizeof(bad)) == AT24C256_OK, "破坏设备1上的记录");
+    CHECK(at24c256_mirror_read(mirror, 0x3000, data, sizeof(data)) == AT24C256_OK &&
+          memcmp(data, records, sizeof(data)) == 0 &&
+          at24c256_mirror_get_stats(mirror, &stats) == AT24C256_OK && stats.fallbacks == 1,
+          "校验失败时读取另一份");
+    CHECK(at24c256_write(a, 0x3400, bad, sizeof(bad)) == AT24C256_OK &&
+          at24c256_mirror_read(mirror, 0x3400, data, 16) == AT24C256_ERROR_READ,
+          "两份都损坏时报错");
+
+    CHECK(at24c256_mirror_close(mirror) == AT24C256_OK, "关闭镜像");
+    at24c256_deinit(a);
+    at24c256_deinit(b);
+}
+
+/**
+ * @brief 镜像中一个设备写入失败：该范围只从另一个设备读取，重新同步后恢复
+ *
+ * 第二个设备用普通文件充当nvmem节点，用RLIMIT_FSIZE让超过限制的写入失败。
+ */
+static void mirror_stale_test(void) {
+    printf("\n=== 镜像单侧写入失败测试 ===\n");
+
+    char path[] = "/tmp/at24c256_mirror_XXXXXX";
+    int fd = mkstemp(path);
+    static uint8_t blank[EEPROM_SIZE];
+    memset(blank, 0xFF, sizeof(blank));
+    bool created = fd >= 0 && write(fd, blank, sizeof(blank)) == (ssize_t)sizeof(blank);
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (!created) {
+        CHECK(0, "创建nvmem测试文件");
+        unlink(path);
+        return;
+    }
+
+    at24c256_handle_t a, b;
+    at24c256_mirror_t mirror;
+    at24c256_mirror_stats_t before, after;
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    config.nvmem_path = path;
+    uint8_t old_data[512], new_data[512], data[512];
+    memset(old_data, 0x5A, sizeof(old_data));
+    memset(new_data, 0xA5, sizeof(new_data));
+
+    CHECK(open_sim(NULL, &a) == AT24C256_OK && at24c256_init(&config, &b) == AT24C256_OK &&
+          at24c256_mirror_open(a, b, NULL, NULL, &mirror) == AT24C256_OK &&
+          at24c256_mirror_write(mirror, 0x1000, old_data, sizeof(old_data)) == AT24C256_OK,
+          "打开镜像并写入");
+
+    // 第二个设备写入失败
+    struct rlimit saved, limit;
+    getrlimit(RLIMIT_FSIZE, &saved);
+    limit = saved;
+    limit.rlim_cur = 0x1000;
+    signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &limit);
+    at24c256_err_t ret = at24c256_mirror_write(mirror, 0x1000, new_data, sizeof(new_data));
+    setrlimit(RLIMIT_FSIZE, &saved);
+    signal(SIGXFSZ, SIG_DFL);
+    CHECK(ret == AT24C256_ERROR_WRITE &&
+          at24c256_mirror_get_stats(mirror, &before) == AT24C256_OK && before.diverged == 1 &&
+          before.stale_length[0] == 0 && before.stale_length[1] == sizeof(new_data),
+          "单侧失败记为过期");
+
+    bool ok = at24c256_mirror_read(mirror, 0x1000, data, sizeof(data)) == AT24C256_OK &&
+              memcmp(data, new_data, sizeof(data)) == 0;
+    for (int i = 0; i < 8; i++) {
+        ok = ok && at24c256_mirror_read(mirror, (uint16_t)(0x1000 + i * 16), data, 16) ==
+                   AT24C256_OK && memcmp(data, new_data, 16) == 0;
+    }
+    CHECK(ok && at24c256_mirror_get_stats(mirror, &after) == AT24C256_OK &&
+          after.reads[1] == before.reads[1] && after.split_reads == before.split_reads,
+          "过期范围只从另一个设备读取");
+
+    CHECK(at24c256_mirror_resync(mirror) == AT24C256_OK &&
+          at24c256_mirror_get_stats(mirror, &after) == AT24C256_OK &&
+          after.stale_length[1] == 0 &&
+          at24c256_read(b, 0x1000, data, sizeof(data)) == AT24C256_OK &&
+          memcmp(data, new_data, sizeof(data)) == 0, "重新同步后两份一致");
+
+    setrlimit(RLIMIT_FSIZE, &limit);
+    signal(SIGXFSZ, SIG_IGN);
+    ret = at24c256_mirror_write(mirror, 0x1100, old_data, 64);
+    setrlimit(RLIMIT_FSIZE, &saved);
+    signal(SIGXFSZ, SIG_DFL);
+    CHECK(ret == AT24C256_ERROR_WRITE &&
+          at24c256_mirror_write(mirror, 0x1000, old_data, sizeof(old_data)) == AT24C256_OK &&
+          at24c256_mirror_get_stats(mirror, &after) == AT24C256_OK &&
+          after.stale_length[1] == 0, "覆盖过期范围的写入成功后恢复");
+
+    at24c256_mirror_close(mirror);
+    at24c256_deinit(a);
+    at24c256_deinit(b);
+    unlink(path);
+}
+
+/**
+ * @brief 批量读取：结果分别写入各请求，非i2c-dev句柄逐个读取
+ */
+static void read_batch_test(void) {
+    printf("\n=== 批量读取测试 ===\n");
+
+    at24c256_handle_t handles[3];
+    at24c256_read_req_t reqs[4];
+    uint8_t header[16];
+    uint8_t out[4][16];
+    bool ok = true;
+
+    for (int i = 0; i < 3; i++) {
+        memset(header, 0x10 * (i + 1), sizeof(header));
+        ok = ok && open_sim(NULL, &handles[i]) == AT24C256_OK &&
+             at24c256_write(handles[i], 0x0000, header, sizeof(header)) == AT24C256_OK;
+    }
+    CHECK(ok, "三个设备写入头部");
+
+    for (int i = 0; i < 4; i++) {
+        reqs[i] = (at24c256_read_req_t){ .handle = handles[i % 3], .address = 0x0000,
+                                         .data = out[i], .length = 16 };
+    }
+    reqs[3].address = 0x7FF8;      // 超出容量
+    CHECK(at24c256_read_batch(reqs, 4) == AT24C256_ERROR_PARAM, "有无效请求时返回其错误");
+    ok = reqs[3].result == AT24C256_ERROR_PARAM;
+    for (int i = 0; i < 3; i++) {
+        ok = ok && reqs[i].result == AT24C256_OK && out[i][0] == 0x10 * (i + 1) &&
+             out[i][15] == 0x10 * (i + 1);
+    }
+    CHECK(ok, "每个请求得到各自设备的内容");
+    CHECK(at24c256_read_batch(reqs, 3) == AT24C256_OK && at24c256_read_batch(reqs, 0) == AT24C256_OK,
+          "全部有效时成功");
+
+    for (int i = 0; i < 3; i++) {
+        at24c256_deinit(handles[i]);
+    }
+}
+
+/**
+ * @brief 设备发现：无法打开的总线被跳过，模拟器配置被拒绝
+ */
+static void discover_test(void) {
+    printf("\n=== 设备发现测试 ===\n");
+
+    const char* buses[] = { "/nonexistent/i2c-98", "/nonexistent/i2c-99" };
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    at24c256_sim_params_t sim = AT24C256_SIM_DEFAULT_PARAMS;
+    at24c256_handle_t handles[2 * AT24C256_DISCOVER_ADDRS];
+    int count = -1;
+
+    CHECK(at24c256_discover(buses, 2, &config, handles, 16, &count) == AT24C256_OK && count == 0,
+          "跳过无法打开的总线");
+    config.sim = &sim;
+    CHECK(at24c256_discover(buses, 2, &config, handles, 16, &count) == AT24C256_ERROR_PARAM,
+          "拒绝模拟器配置");
+    config.sim = NULL;
+    at24c256_config_set_part(&config, "AT24C16");
+    CHECK(at24c256_discover(buses, 2, &config, handles, 16, &count) == AT24C256_OK && count == 0,
+          "占用8个地址的器件");
+}
+
+/**
+ * @brief 芯片内复制：重叠的两个方向，每个目标页一次读取一次编程
+ */
+static void copy_test(void) {
+    printf("\n=== 芯片内复制测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_sim_stats_t before, after;
+    static uint8_t expect[4096];
+    static uint8_t data[4096];
+
+    for (size_t i = 0; i < sizeof(expect); i++) {
+        expect[i] = (uint8_t)(i * 13 + 5);
+    }
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK &&
+          at24c256_write(handle, 0x1000, expect, sizeof(expect)) == AT24C256_OK, "写入测试数据");
+
+    // 目标在源之后且重叠：1000字节从0x1010移到0x1030，目标涉及17页
+    at24c256_sim_get_stats(handle, &before);
+    CHECK(at24c256_copy(handle, 0x1010, 0x1030, 1000) == AT24C256_OK, "向后移动");
+    at24c256_sim_get_stats(handle, &after);
+    memmove(expect + 0x30, expect + 0x10, 1000);
+    CHECK(at24c256_read(handle, 0x1000, data, sizeof(data)) == AT24C256_OK &&
+          memcmp(data, expect, sizeof(data)) == 0, "向后移动内容正确");
+    printf("  %llu次读事务，%llu次页编程\n", (unsigned long long)(after.reads - before.reads),
+           (unsigned long long)(after.pages - before.pages));
+    CHECK(after.pages - before.pages == 17 && after.reads - before.reads == 17,
+          "每个目标页一次读取一次编程");
+
+    // 目标在源之前且重叠
+    CHECK(at24c256_copy(handle, 0x1100, 0x10F0, 2000) == AT24C256_OK, "向前移动");
+    memmove(expect + 0xF0, expect + 0x100, 2000);
+    CHECK(at24c256_read(handle, 0x1000, data, sizeof(data)) == AT24C256_OK &&
+          memcmp(data, expect, sizeof(data)) == 0, "向前移动内容正确");
+
+    // 不重叠
+    CHECK(at24c256_copy(handle, 0x1000, 0x4003, 300) == AT24C256_OK &&
+          at24c256_read(handle, 0x4003, data, 300) == AT24C256_OK &&
+          memcmp(data, expect, 300) == 0, "复制到不重叠的区域");
+    CHECK(at24c256_copy(handle, 0x7F00, 0x0000, 0x200) == AT24C256_ERROR_PARAM, "拒绝越界的范围");
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 截止时间：到期时在页边界停止并返回已完成的字节数
+ */
+static void deadline_test(void) {
+    printf("\n=== 截止时间测试 ===\n");
+
+    at24c256_handle_t handle;
+    static uint8_t pattern[4096];
+    static uint8_t data[4096];
+    uint16_t done = 0;
+
+    for (size_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = (uint8_t)(i * 3 + 1);
+    }
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK, "模拟器初始化");
+
+    // 每页编程在虚拟时钟中约5ms，20ms内只能写完几页
+    uint64_t deadline = at24c256_deadline_after(handle, 20000);
+    CHECK(at24c256_write_deadline(handle, 0x2010, pattern, sizeof(pattern), deadline, &done) ==
+          AT24C256_ERROR_TIMEOUT, "写入到期");
+    printf("  20ms内写入%u字节\n", done);
+    CHECK(done > 0 && done < sizeof(pattern) && (0x2010 + done) % 64 == 0, "在页边界停止");
+    CHECK(at24c256_read(handle, 0x2010, data, sizeof(pattern)) == AT24C256_OK &&
+          memcmp(data, pattern, done) == 0 && data[done] == 0xFF, "已完成的部分写入，其余未写");
+
+    uint16_t written = done;
+    CHECK(at24c256_write_deadline(handle, (uint16_t)(0x2010 + written), pattern + written,
+                                  (uint16_t)(sizeof(pattern) - written), AT24C256_NO_DEADLINE,
+                                  &done) == AT24C256_OK &&
+          done == sizeof(pattern) - written, "不限时间时写完剩余部分");
+
+    // 读取：4KB约需100ms总线时间，块不受页边界限制
+    at24c256_sim_stats_t before, after;
+    at24c256_sim_get_stats(handle, &before);
+    deadline = at24c256_deadline_after(handle, 10000);
+    CHECK(at24c256_read_deadline(handle, 0x2010, data, sizeof(data), deadline, &done) ==
+          AT24C256_ERROR_TIMEOUT && done > 0 && done < sizeof(data) &&
+          memcmp(data, pattern, done) == 0, "读取到期时返回已读部分");
+    at24c256_sim_get_stats(handle, &after);
+    printf("  10ms内%u次读事务读取%u字节\n", after.reads - before.reads, done);
+    CHECK(after.reads - before.reads <= 3 && done > 6 * 64, "按剩余时间取块");
+    CHECK(after.now_ns - before.now_ns < 10000000ULL + 2000000ULL, "超出截止时间不到一页的传输时间");
+    at24c256_sim_get_stats(handle, &before);
+    CHECK(at24c256_read_deadline(handle, 0x2010, data, sizeof(data), AT24C256_NO_DEADLINE,
+                                 &done) == AT24C256_OK && done == sizeof(data) &&
+          memcmp(data, pattern, sizeof(data)) == 0, "不限时间时完整读取");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.reads - before.reads == 1, "不限时间时一次读取");
+
+    deadline = at24c256_deadline_after(handle, 0);
+    CHECK(at24c256_erase_deadline(handle, 0x2010, 256, deadline, &done) == AT24C256_ERROR_TIMEOUT &&
+          done == 0, "已过期时不执行");
+    deadline = at24c256_deadline_after(handle, 12000);
+    CHECK(at24c256_copy_deadline(handle, 0x2010, 0x6000, 1024, deadline, &done) ==
+          AT24C256_ERROR_TIMEOUT && done > 0 && done < 1024 &&
+          at24c256_read(handle, 0x6000, data, done) == AT24C256_OK &&
+          memcmp(data, pattern, done) == 0, "复制到期时返回已复制部分");
+    CHECK(at24c256_wait_ready_deadline(handle, at24c256_deadline_after(handle, 10000)) ==
+          AT24C256_OK, "截止时间内就绪");
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 内存映射：按需加载、msync只编程变化的字节、解除映射
+ */
+static void map_test(void) {
+    printf("\n=== 内存映射测试 ===\n");
+
+    at24c256_handle_t handle;
+    at24c256_sim_stats_t before, after;
+    static uint8_t pattern[4096];
+    uint8_t back[64];
+    void* base = NULL;
+
+    for (size_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = (uint8_t)(i * 5 + 7);
+    }
+    CHECK(open_sim(NULL, &handle) == AT24C256_OK &&
+          at24c256_write(handle, 0x1000, pattern, sizeof(pattern)) == AT24C256_OK, "写入测试数据");
+
+    at24c256_err_t ret = at24c256_map(handle, &base);
+    if (ret == AT24C256_ERROR_UNSUPPORTED) {
+        printf("  内核不支持userfaultfd写保护，跳过\n");
+        at24c256_deinit(handle);
+        return;
+    }
+    CHECK(ret == AT24C256_OK && base != NULL, "建立映射");
+    if (ret != AT24C256_OK) {
+        at24c256_deinit(handle);
+        return;
+    }
+    uint8_t* mem = (uint8_t*)base;
+
+    // 首次访问加载整个主机页，同一主机页内的后续访问不再读芯片
+    at24c256_sim_get_stats(handle, &before);
+    CHECK(memcmp(mem + 0x1000, pattern, 256) == 0, "首次访问加载芯片内容");
+    CHECK(memcmp(mem + 0x1000, pattern, sizeof(pattern)) == 0, "同一主机页内的其余内容");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.reads - before.reads == 1 && after.pages == before.pages, "一次缺页一次连续读取");
+
+    // 只修改一个EEPROM页内的两个字节
+    mem[0x1043] = 0xA5;
+    mem[0x1047] = 0x5A;
+    at24c256_sim_get_stats(handle, &before);
+    CHECK(at24c256_msync(handle) == AT24C256_OK, "写回");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.pages - before.pages == 1, "只编程发生变化的页");
+    CHECK(at24c256_read(handle, 0x1040, back, sizeof(back)) == AT24C256_OK && back[3] == 0xA5 &&
+          back[7] == 0x5A && memcmp(back, pattern + 0x40, 3) == 0 &&
+          memcmp(back + 8, pattern + 0x48, sizeof(back) - 8) == 0, "芯片内容与映射一致");
+
+    at24c256_sim_get_stats(handle, &before);
+    CHECK(at24c256_msync(handle) == AT24C256_OK, "无修改时写回");
+    at24c256_sim_get_stats(handle, &after);
+    CHECK(after.pages == before.pages, "无修改时不编程");
+
+    // 解除映射不写回未同步的修改
+    mem[0x1080] = (uint8_t)~pattern[0x80];
+    CHECK(at24c256_unmap(handle) == AT24C256_OK, "解除映射");
+    CHECK(at24c256_read(handle, 0x1080, back, 1) == AT24C256_OK && back[0] == pattern[0x80],
+          "未同步的修改不写回");
+    CHECK(at24c256_msync(handle) == AT24C256_ERROR_PARAM, "解除映射后拒绝写回");
+    at24c256_deinit(handle);
+}
+
+/**
+ * @brief 主函数
+ */
+int main(void) {
+    printf("模拟器功能测试程序\n");
+    printf("==================\n");
+
+    sim_trace_test();
+    async_hooks_test();
+    hashdir_cost_test();
+    ts_test();
+    kv_test();
+    readahead_test();
+    group_commit_test();
+    group_mixed_test();
+    layout_test();
+    mirror_test();
+    mirror_stale_test();
+    read_batch_test();
+    discover_test();
+    copy_test();
+    deadline_test();
+    map_test();
+
+    printf("\n=== 测试结果 ===\n");
+    if (g_failures == 0) {
+        printf("✓ 所有测试通过！\n");
+        return EXIT_SUCCESS;
+    }
+    printf("✗ %d 项测试失败！\n", g_failures);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,274 @@
+/**
+ * @file at24c256_fuse.c
+ * @brief 将EEPROM文件容器挂载为目录的FUSE前端
+ *
+ * 挂载时一次读取索引区，文件内容经回写页缓存访问：重复读取不访问总线，
+ * 写入在flush/close/fsync时才以页对齐、只编程变化字节的方式写回芯片。
+ *
+ * 使用说明：
+ *   at24c256_fuse [--bus=/dev/i2c-5] [--addr=0x50] [--nvmem=节点] <挂载点> [FUSE选项]
+ */
+
+#define FUSE_USE_VERSION 31
+
+#include <fuse.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "at24c256.h"
+#include "at24c256_container.h"
+
+/**
+ * @brief 命令行选项
+ */
+typedef struct {
+    const char* bus;
+    int addr;
+    const char* nvmem;
+} fuse_options_t;
+
+#define OPTION(t, p) { t, offsetof(fuse_options_t, p), 1 }
+static const struct fuse_opt option_spec[] = {
+    OPTION("--bus=%s", bus),
+    OPTION("--addr=%i", addr),
+    OPTION("--nvmem=%s", nvmem),
+    FUSE_OPT_END
+};
+
+static at24c256_handle_t g_handle;
+static at24c256_container_t g_container;
+
+/**
+ * @brief 错误码转换为errno
+ */
+static int to_errno(at24c256_err_t err) {
+    switch (err) {
+    case AT24C256_OK:            return 0;
+    case AT24C256_ERROR_PARAM:   return -EINVAL;
+    case AT24C256_ERROR_MEMORY:  return -ENOSPC;
+    case AT24C256_ERROR_BUSY:    return -EBUSY;
+    case AT24C256_ERROR_TIMEOUT: return -ETIMEDOUT;
+    default:                     return -EIO;
+    }
+}
+
+/**
+ * @brief 路径 ("/name") 转换为文件序号
+ */
+static int lookup(const char* path) {
+    if (path[0] != '/' || strchr(path + 1, '/')) {
+        return -1;
+    }
+    return at24c256_container_find(g_container, path + 1);
+}
+
+static int fs_getattr(const char* path, struct stat* st, struct fuse_file_info* fi) {
+    (void)fi;
+    memset(st, 0, sizeof(*st));
+
+    if (strcmp(path, "/") == 0) {
+        st->st_mode = S_IFDIR | 0755;
+        st->st_nlink = 2;
+        return 0;
+    }
+
+    int index = lookup(path);
+    at24c256_file_info_t info;
+    if (index < 0 || at24c256_container_stat(g_container, index, &info) != AT24C256_OK) {
+        return -ENOENT;
+    }
+
+    st->st_mode = S_IFREG | 0644;
+    st->st_nlink = 1;
+    st->st_size = info.size;
+    return 0;
+}
+
+static int fs_readdir(const char* path, void* buf, fuse_fill_dir_t filler, off_t offset,
+                      struct fuse_file_info* fi, enum fuse_readdir_flags flags) {
+    (void)offset;
+    (void)fi;
+    (void)flags;
+    if (strcmp(path, "/") != 0) {
+        return -ENOENT;
+    }
+
+    filler(buf, ".", NULL, 0, 0);
+    filler(buf, "..", NULL, 0, 0);
+    for (int i = 0; i < at24c256_container_count(g_container); i++) {
+        at24c256_file_info_t info;
+        if (at24c256_container_stat(g_container, i, &info) == AT24C256_OK) {
+            filler(buf, info.name, NULL, 0, 0);
+        }
+    }
+    return 0;
+}
+
+static int fs_open(const char* path, struct fuse_file_info* fi) {
+    int index = lookup(path);
+    if (index < 0) {
+        return -ENOENT;
+    }
+    if (fi->flags & O_TRUNC) {
+        return to_errno(at24c256_container_truncate(g_container, index, 0));
+    }
+    return 0;
+}
+
+static int fs_create(const char* path, mode_t mode, struct fuse_file_info* fi) {
+    (void)mode;
+    (void)fi;
+    if (path[0] != '/' || strchr(path + 1, '/')) {
+        return -EINVAL;
+    }
+
+    int index;
+    return to_errno(at24c256_container_create(g_container, path + 1, &index));
+}
+
+static int fs_read(const char* path, char* buf, size_t size, off_t offset,
+                   struct fuse_file_info* fi) {
+    (void)fi;
+    int index = lookup(path);
+    if (index < 0) {
+        return -ENOENT;
+    }
+
+    uint32_t done = 0;
+    at24c256_err_t ret = at24c256_container_read(g_container, index, (uint32_t)offset,
+                                                 (uint8_t*)buf, (uint32_t)size, &done);
+    return ret == AT24C256_OK ? (int)done : to_errno(ret);
+}
+
+static int fs_write(const char* path, const char* buf, size_t size, off_t offset,
+                    struct fuse_file_info* fi) {
+    (void)fi;
+    int index = lookup(path);
+    if (index < 0) {
+        return -ENOENT;
+    }
+
+    at24c256_err_t ret = at24c256_container_write(g_container, index, (uint32_t)offset,
+                                                  (const uint8_t*)buf, (uint32_t)size);
+    return ret == AT24C256_OK ? (int)size : to_errno(ret);
+}
+
+static int fs_truncate(const char* path, off_t size, struct fuse_file_info* fi) {
+    (void)fi;
+    int index = lookup(path);
+    if (index < 0) {
+        return -ENOENT;
+    }
+    return to_errno(at24c256_container_truncate(g_container, index, (uint32_t)size));
+}
+
+static int fs_unlink(const char* path) {
+    int index = lookup(path);
+    if (index < 0) {
+        return -ENOENT;
+    }
+    return to_errno(at24c256_container_remove(g_container, index));
+}
+
+static int fs_rename(const char* from, const char* to, unsigned int flags) {
+    if (flags != 0) {
+        return -EINVAL;
+    }
+
+    int index = lookup(from);
+    if (index < 0) {
+        return -ENOENT;
+    }
+    if (to[0] != '/' || strchr(to + 1, '/')) {
+        return -EINVAL;
+    }
+
+    // 目标已存在时先删除，注意删除后序号可能前移
+    int existing = lookup(to);
+    if (existing >= 0 && existing != index) {
+        at24c256_err_t ret = at24c256_container_remove(g_container, existing);
+        if (ret != AT24C256_OK) {
+            return to_errno(ret);
+        }
+        if (existing < index) {
+            index--;
+        }
+    }
+    return to_errno(at24c256_container_rename(g_container, index, to + 1));
+}
+
+static int fs_flush(const char* path, struct fuse_file_info* fi) {
+    (void)path;
+    (void)fi;
+    return to_errno(at24c256_container_sync(g_container));
+}
+
+static int fs_fsync(const char* path, int datasync, struct fuse_file_info* fi) {
+    (void)datasync;
+    return fs_flush(path, fi);
+}
+
+static void fs_destroy(void* private_data) {
+    (void)private_data;
+    at24c256_container_unmount(g_container);
+    at24c256_deinit(g_handle);
+}
+
+static const struct fuse_operations fs_ops = {
+    .getattr  = fs_getattr,
+    .readdir  = fs_readdir,
+    .open     = fs_open,
+    .create   = fs_create,
+    .read     = fs_read,
+    .write    = fs_write,
+    .truncate = fs_truncate,
+    .unlink   = fs_unlink,
+    .rename   = fs_rename,
+    .flush    = fs_flush,
+    .release  = fs_flush,
+    .fsync    = fs_fsync,
+    .destroy  = fs_destroy,
+};
+
+/**
+ * @brief 主函数
+ */
+int main(int argc, char* argv[]) {
+    struct fuse_args args = FUSE_ARGS_INIT(argc, argv);
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    fuse_options_t options = { .bus = NULL, .addr = config.device_addr, .nvmem = NULL };
+
+    if (fuse_opt_parse(&args, &options, option_spec, NULL) != 0) {
+        return EXIT_FAILURE;
+    }
+    if (options.bus) {
+        config.i2c_bus = options.bus;
+    }
+    config.device_addr = (uint8_t)options.addr;
+    config.nvmem_path = options.nvmem;
+
+    at24c256_err_t ret = at24c256_init(&config, &g_handle);
+    if (ret != AT24C256_OK) {
+        fprintf(stderr, "EEPROM初始化失败: %s\n", at24c256_strerror(ret));
+        fuse_opt_free_args(&args);
+        return EXIT_FAILURE;
+    }
+
+    ret = at24c256_container_mount(g_handle, &g_container);
+    if (ret != AT24C256_OK) {
+        fprintf(stderr, "文件容器挂载失败: %s\n", at24c256_strerror(ret));
+        at24c256_deinit(g_handle);
+        fuse_opt_free_args(&args);
+        return EXIT_FAILURE;
+    }
+
+    // 容器与设备句柄不是线程安全的，强制单线程模式
+    fuse_opt_add_arg(&args, "-s");
+    int status = fuse_main(args.argc, args.argv, &fs_ops, NULL);
+    fuse_opt_free_args(&args);
+    return status;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file at24c256_replay.c
+ * @brief 在模拟器上回放访问记录
+ *
+ * 读取at24c256_trace_start录下的记录，按原始的到达时间在内存模拟器上重新执行，
+ * 对每组驱动设置 (页缓存模式 × 写周期完成方式) 报告总耗时、总线时间与延迟分布，
+ * 用真实的访问模式比较驱动设置。记录中不含数据内容，回放时写入固定的填充数据。
+ *
+ * 使用说明：
+ *   at24c256_replay [-k 总线kHz] [-t 实际写周期us] [-d 固定延时ms] [-f 每N次写入写回] [-g] 记录文件
+ *     -g  忽略记录中的间隔，请求背靠背执行 (评估吞吐量上限)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "at24c256.h"
+
+/**
+ * @brief 一组回放设置
+ */
+typedef struct {
+    const char* name;
+    int cache_mode;              /**< 0表示不启用页缓存 */
+    at24c256_sim_wait_t wait;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "无缓存/固定延时", 0, AT24C256_SIM_WAIT_DELAY },
+    { "无缓存/应答查询", 0, AT24C256_SIM_WAIT_POLL },
+    { "直写缓存/固定延时", AT24C256_CACHE_WRITE_THROUGH, AT24C256_SIM_WAIT_DELAY },
+    { "直写缓存/应答查询", AT24C256_CACHE_WRITE_THROUGH, AT24C256_SIM_WAIT_POLL },
+    { "回写缓存/固定延时", AT24C256_CACHE_WRITE_BACK, AT24C256_SIM_WAIT_DELAY },
+    { "回写缓存/应答查询", AT24C256_CACHE_WRITE_BACK, AT24C256_SIM_WAIT_POLL },
+};
+
+/**
+ * @brief 回放选项
+ */
+typedef struct {
+    at24c256_sim_params_t sim;
+    uint16_t write_delay_ms;
+    uint32_t flush_every;        /**< 回写缓存时每N次写入写回一次，0表示只在记录的flush与结尾 */
+    bool back_to_back;
+} options_t;
+
+static uint8_t g_fill[65536];
+static uint8_t g_scratch[65536];
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * @brief 已排序数组的百分位 (微秒)
+ */
+static double percentile_us(const uint64_t* sorted, uint32_t n, double p) {
+    if (n == 0) {
+        return 0.0;
+    }
+    uint32_t index = (uint32_t)(p * (n - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+/**
+ * @brief 左对齐打印名称 (中文字符按两列计算)
+ */
+static void print_name(const char* name, int columns) {
+    int width = 0;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        if (*p < 0x80) {
+            width++;
+        } else if (*p >= 0xE0) {
+            width += 2;
+        }
+    }
+    printf("%s%*s", name, columns > width ? columns - width : 0, "");
+}
+
+static void print_row(const char* name, uint64_t total_ns, uint64_t bus_ns, uint64_t wait_ns,
+                      uint32_t pages, uint64_t* latency, uint32_t n) {
+    qsort(latency, n, sizeof(latency[0]), compare_u64);
+    print_name(name, 20);
+    printf(" %10.2f %9.2f %9.2f %7u %9.1f %9.1f %9.1f %10.1f\n",
+           total_ns / 1e6, bus_ns / 1e6, wait_ns / 1e6, pages,
+           percentile_us(latency, n, 0.50), percentile_us(latency, n, 0.90),
+           percentile_us(latency, n, 0.99), n ? latency[n - 1] / 1000.0 : 0.0);
+}
+
+/**
+ * @brief 执行一条记录
+ */
+static at24c256_err_t replay_one(at24c256_handle_t handle, const at24c256_trace_record_t* r) {
+    switch (r->op) {
+    case AT24C256_TRACE_READ:
+        return at24c256_read(handle, r->address, g_scratch, r->length);
+    case AT24C256_TRACE_WRITE:
+        return at24c256_write(handle, r->address, g_fill, r->length);
+    case AT24C256_TRACE_PROGRAM_PAGE:
+        return at24c256_program_page(handle, r->address, g_fill, r->length);
+    case AT24C256_TRACE_ERASE:
+        return at24c256_erase(handle, r->address, r->length);
+    case AT24C256_TRACE_FLUSH:
+        return at24c256_flush(handle);
+    default:
+        return AT24C256_ERROR_PARAM;
+    }
+}
+
+/**
+ * @brief 按一组设置回放全部记录并打印一行结果
+ */
+static int run_scenario(const scenario_t* sc, const options_t* opt,
+                        const at24c256_trace_info_t* info,
+                        const at24c256_trace_record_t* records, uint32_t count,
+                        uint64_t* latency) {
+    at24c256_sim_params_t sim = opt->sim;
+    sim.wait = sc->wait;
+
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    config.page_size = info->page_size;
+    config.total_size = info->total_size;
+    config.addr_bytes = info->addr_bytes;
+    config.write_delay_ms = opt->write_delay_ms;
+    config.sim = &sim;
+
+    at24c256_handle_t handle = NULL;
+    at24c256_err_t ret = at24c256_init(&config, &handle);
+    if (ret == AT24C256_OK && sc->cache_mode) {
+        ret = at24c256_cache_enable(handle, (at24c256_cache_mode_t)sc->cache_mode);
+    }
+    if (ret != AT24C256_OK) {
+        fprintf(stderr, "%s: 模拟器初始化失败: %s\n", sc->name, at24c256_strerror(ret));
+        if (handle) {
+            at24c256_deinit(handle);
+        }
+        return -1;
+    }
+
+    uint32_t writes = 0;
+    uint32_t errors = 0;
+    at24c256_sim_stats_t stats;
+    for (uint32_t i = 0; i < count; i++) {
+        const at24c256_trace_record_t* r = &records[i];
+
+        // 按记录的到达时间推进虚拟时钟，设备落后时延迟包含排队时间
+        at24c256_sim_get_stats(handle, &stats);
+        uint64_t arrival = opt->back_to_back ? stats.now_ns : r->start_ns;
+        if (stats.now_ns < arrival) {
+            at24c256_sim_advance(handle, arrival - stats.now_ns);
+            stats.now_ns = arrival;
+        }
+
+        if (replay_one(handle, r) != AT24C256_OK) {
+            errors++;
+        }
+        if (sc->cache_mode == AT24C256_CACHE_WRITE_BACK && opt->flush_every &&
+            r->op != AT24C256_TRACE_READ && r->op != AT24C256_TRACE_FLUSH &&
+            ++writes % opt->flush_every == 0) {
+            at24c256_flush(handle);
+        }
+
+        at24c256_sim_get_stats(handle, &stats);
+        latency[i] = stats.now_ns - arrival;
+    }
+
+    // 回写缓存中剩余的数据计入总耗时
+    at24c256_flush(handle);
+    at24c256_sim_get_stats(handle, &stats);
+    at24c256_deinit(handle);
+
+    print_row(sc->name, stats.now_ns, stats.bus_ns, stats.wait_ns, stats.pages, latency, count);
+    if (errors > 0) {
+        printf("  (%u条记录回放失败)\n", errors);
+    }
+    return 0;
+}
+
+static void usage(const char* prog) {
+    printf("用法: %s [-k 总线kHz] [-t 实际写周期us] [-d 固定延时ms] [-f 每N次写入写回] [-g] "
+           "记录文件\n", prog);
+}
+
+/**
+ * @brief 主函数
+ */
+int main(int argc, char* argv[]) {
+    options_t opt = {
+        .sim = AT24C256_SIM_DEFAULT_PARAMS,
+        .write_delay_ms = 5,
+        .flush_every = 0,
+        .back_to_back = false,
+    };
+
+    int c;
+    while ((c = getopt(argc, argv, "k:t:d:f:gh")) != -1) {
+        switch (c) {
+        case 'k': opt.sim.bus_hz = (uint32_t)strtoul(optarg, NULL, 0) * 1000; break;
+        case 't': opt.sim.write_cycle_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'd': opt.write_delay_ms = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 'f': opt.flush_every = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'g': opt.back_to_back = true; break;
+        default:
+            usage(argv[0]);
+            return c == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    at24c256_trace_info_t info;
+    at24c256_trace_record_t* records;
+    uint32_t count;
+    at24c256_err_t ret = at24c256_trace_load(argv[optind], &info, &records, &count);
+    if (ret != AT24C256_OK) {
+        fprintf(stderr, "无法读取记录文件 %s: %s\n", argv[optind], at24c256_strerror(ret));
+        return EXIT_FAILURE;
+    }
+
+    uint64_t* latency = (uint64_t*)malloc((count ? count : 1) * sizeof(uint64_t));
+    if (!latency) {
+        free(records);
+        return EXIT_FAILURE;
+    }
+    memset(g_fill, 0xA5, sizeof(g_fill));
+
+    uint64_t span = count ? records[count - 1].start_ns + records[count - 1].duration_ns : 0;
+    printf("记录: %s  %u条  页%u字节  容量%u字节  时长%.2fms\n", argv[optind], count,
+           info.page_size, info.total_size, span / 1e6);
+    printf("模拟: 总线%ukHz  实际写周期%uus  固定延时%ums%s\n\n", opt.sim.bus_hz / 1000,
+           opt.sim.write_cycle_us, opt.write_delay_ms, opt.back_to_back ? "  背靠背" : "");
+    print_name("场景", 20);
+    printf(" %10s %9s %9s %7s %9s %9s %9s %10s\n", "total_ms", "bus_ms", "wait_ms", "pages",
+           "p50_us", "p90_us", "p99_us", "max_us");
+
+    // 记录中的实测耗时作为对照
+    for (uint32_t i = 0; i < count; i++) {
+        latency[i] = records[i].duration_ns;
+    }
+    print_row("记录 (实测)", span, 0, 0, 0, latency, count);
+
+    int status = EXIT_SUCCESS;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        if (run_scenario(&scenarios[i], &opt, &info, records, count, latency) != 0) {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    free(latency);
+    free(records);
+    return status;
+}
@@ -0,0 +1,617 @@
+/**
+ * @file at24c256d.c
+ * @brief AT24C256 EEPROM 代理守护进程
+ *
+ * 守护进程独占设备，客户端通过Unix域套接字提交请求。每轮poll收集所有客户端
+ * 的请求后统一调度：写请求按到达顺序执行，读请求按页合并成尽量少的大事务。
+ * 读取结果写入共享内存镜像，客户端直接从镜像拷贝，数据不经过套接字。
+ *
+ * 客户端套接字都是非阻塞的：请求与响应在每个客户端自己的缓冲区中分段收发，
+ * 发送一半请求后停住或不读取响应的客户端不会阻塞其他客户端，
+ * 不完整的请求超过CLIENT_PARTIAL_TIMEOUT_MS后断开该客户端。
+ *
+ * 使用说明：
+ *   at24c256d [-b i2c总线] [-a 设备地址] [-p 器件型号] [-n nvmem节点] [-s 套接字路径] [-m 共享内存名]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "at24c256.h"
+#include "at24c256_client.h"
+#include "at24c256_ipc.h"
+
+#define MAX_CLIENTS 64
+#define MAX_BURST 4096          // 单次合并读取的最大字节数
+#define CLIENT_PARTIAL_TIMEOUT_MS 1000 // 客户端发送不完整请求时的超时
+
+/**
+ * @brief 已连接客户端
+ *
+ * 每个客户端同时只有一个未完成请求：请求收齐后停止接收，响应发送完后才接收下一个。
+ */
+typedef struct {
+    int fd;                      /**< 连接描述符，-1表示空闲 */
+    bool pending;                /**< 请求已收齐，等待本轮调度 */
+    at24c256_ipc_req_t req;      /**< 请求头 */
+    size_t req_received;         /**< 已收到的请求头字节数 */
+    uint8_t* payload;            /**< 写请求数据 */
+    size_t payload_received;     /**< 已收到的写数据字节数 */
+    uint64_t partial_since_ms;   /**< 开始收到当前请求的时刻，0表示没有不完整的请求 */
+    uint8_t out[sizeof(at24c256_ipc_hello_t)]; /**< 待发送的欢迎消息或响应 */
+    size_t out_len;              /**< out中的字节数 */
+    size_t out_sent;             /**< 已发送的字节数 */
+} client_slot_t;
+
+/**
+ * @brief 守护进程状态
+ */
+typedef struct {
+    at24c256_handle_t dev;
+    at24c256_config_t config;
+    int listen_fd;
+    at24c256_ipc_shm_t* shm;
+    size_t shm_size;
+    uint8_t* valid;              /**< 每页一位，镜像中该页是否已从芯片加载 */
+    uint8_t* needed;             /**< 每页一位，本轮读请求需要加载的页 */
+    uint8_t* burst;              /**< 合并读取缓冲区 */
+    uint32_t page_count;
+    client_slot_t clients[MAX_CLIENTS];
+} daemon_state_t;
+
+static volatile sig_atomic_t g_running = 1;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_running = 0;
+}
+
+static bool page_valid(const daemon_state_t* st, uint32_t page) {
+    return (st->valid[page / 8] >> (page % 8)) & 1u;
+}
+
+static void mark_page_valid(daemon_state_t* st, uint32_t page) {
+    st->valid[page / 8] |= (uint8_t)(1u << (page % 8));
+}
+
+static void mark_page_invalid(daemon_state_t* st, uint32_t page) {
+    st->valid[page / 8] &= (uint8_t)~(1u << (page % 8));
+}
+
+/**
+ * @brief 在顺序锁保护下更新镜像
+ */
+static void image_update(daemon_state_t* st, uint32_t address, const uint8_t* data,
+                         uint32_t length, int fill) {
+    atomic_fetch_add_explicit(&st->shm->seq, 1, memory_order_acq_rel);
+    if (data) {
+        memcpy(&st->shm->image[address], data, length);
+    } else {
+        memset(&st->shm->image[address], fill, length);
+    }
+    atomic_fetch_add_explicit(&st->shm->seq, 1, memory_order_release);
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/**
+ * @brief 非阻塞地接收到buf[*received, len)，返回0表示暂时没有更多数据，-1表示连接已断开
+ */
+static int recv_some(int fd, void* buf, size_t len, size_t* received) {
+    while (*received < len) {
+        ssize_t n = recv(fd, (uint8_t*)buf + *received, len - *received, 0);
+        if (n > 0) {
+            *received += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 发送输出缓冲区中剩余的部分，套接字缓冲区满时留待POLLOUT
+ */
+static int flush_output(client_slot_t* c) {
+    while (c->out_sent < c->out_len) {
+        ssize_t n = send(c->fd, c->out + c->out_sent, c->out_len - c->out_sent,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            c->out_sent += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        } else {
+            return -1;
+        }
+    }
+    c->out_len = c->out_sent = 0;
+    return 0;
+}
+
+/**
+ * @brief 把消息放入输出缓冲区并尽量发送 (调用者保证缓冲区已空)
+ */
+static int queue_output(client_slot_t* c, const void* msg, size_t len) {
+    memcpy(c->out, msg, len);
+    c->out_len = len;
+    c->out_sent = 0;
+    return flush_output(c);
+}
+
+static void drop_client(client_slot_t* c) {
+    close(c->fd);
+    free(c->payload);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+/**
+ * @brief 接受所有等待中的新连接并发送欢迎消息
+ */
+static void accept_clients(daemon_state_t* st, const char* shm_name) {
+    for (;;) {
+        int fd = accept4(st->listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) {
+            return;
+        }
+
+        client_slot_t* slot = NULL;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (st->clients[i].fd < 0) {
+                slot = &st->clients[i];
+                break;
+            }
+        }
+        if (!slot) {
+            close(fd);
+            continue;
+        }
+
+        at24c256_ipc_hello_t hello;
+        memset(&hello, 0, sizeof(hello));
+        hello.magic = AT24C256_IPC_MAGIC;
+        hello.total_size = st->config.total_size;
+        hello.page_size = st->config.page_size;
+        snprintf(hello.shm_name, sizeof(hello.shm_name), "%s", shm_name);
+
+        slot->fd = fd;
+        if (queue_output(slot, &hello, sizeof(hello)) != 0) {
+            drop_client(slot);
+        }
+    }
+}
+
+/**
+ * @brief 接收客户端请求中已到达的部分，收齐后标记为待处理
+ */
+static void receive_request(client_slot_t* c) {
+    if (recv_some(c->fd, &c->req, sizeof(c->req), &c->req_received) != 0) {
+        drop_client(c);
+        return;
+    }
+    if (c->req_received < sizeof(c->req)) {
+        goto partial;
+    }
+    if (c->req.magic != AT24C256_IPC_MAGIC) {
+        drop_client(c);
+        return;
+    }
+
+    if (c->req.op == AT24C256_IPC_OP_WRITE) {
+        if (!c->payload) {
+            c->payload = (uint8_t*)malloc(c->req.length ? c->req.length : 1);
+            if (!c->payload) {
+                drop_client(c);
+                return;
+            }
+        }
+        if (recv_some(c->fd, c->payload, c->req.length, &c->payload_received) != 0) {
+            drop_client(c);
+            return;
+        }
+        if (c->payload_received < c->req.length) {
+            goto partial;
+        }
+    }
+
+    c->pending = true;
+    c->req_received = 0;
+    c->payload_received = 0;
+    c->partial_since_ms = 0;
+    return;
+
+partial:
+    if (c->req_received > 0 && c->partial_since_ms == 0) {
+        c->partial_since_ms = now_ms();
+    }
+}
+
+/**
+ * @brief 执行写请求并同步到镜像
+ */
+static at24c256_err_t execute_write(daemon_state_t* st, client_slot_t* c) {
+    uint32_t address = c->req.address;
+    uint32_t length = c->req.length;
+    if (length == 0 || address + length > st->config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    at24c256_err_t ret;
+    if (c->req.op == AT24C256_IPC_OP_WRITE) {
+        ret = at24c256_write(st->dev, (uint16_t)address, c->payload, (uint16_t)length);
+    } else {
+        ret = at24c256_erase(st->dev, (uint16_t)address, (uint16_t)length);
+    }
+    uint32_t page_size = st->config.page_size;
+    if (ret != AT24C256_OK) {
+        // 芯片可能已编程了一部分，涉及的页下次读取时重新从芯片加载
+        for (uint32_t p = address / page_size; p <= (address + length - 1) / page_size; p++) {
+            mark_page_invalid(st, p);
+        }
+        return ret;
+    }
+
+    image_update(st, address, c->payload, length, 0xFF);
+
+    // 整页覆盖的页可直接视为已加载
+    uint32_t first = (address + page_size - 1) / page_size;
+    uint32_t end = (address + length) / page_size;
+    for (uint32_t p = first; p < end; p++) {
+        mark_page_valid(st, p);
+    }
+    return AT24C256_OK;
+}
+
+/**
+ * @brief 合并本轮所有读请求缺失的页并批量从芯片加载
+ */
+static void load_missing_pages(daemon_state_t* st) {
+    uint32_t page_size = st->config.page_size;
+    bool any = false;
+
+    // 汇总所有读请求需要但镜像中尚未加载的页
+    memset(st->needed, 0, (st->page_count + 7) / 8);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        client_slot_t* c = &st->clients[i];
+        if (c->fd < 0 || !c->pending || c->req.op != AT24C256_IPC_OP_READ ||
+            c->req.length == 0 ||
+            (uint32_t)c->req.address + c->req.length > st->config.total_size) {
+            continue;
+        }
+        uint32_t last = (c->req.address + c->req.length - 1u) / page_size;
+        for (uint32_t p = c->req.address / page_size; p <= last; p++) {
+            if (!page_valid(st, p)) {
+                st->needed[p / 8] |= (uint8_t)(1u << (p % 8));
+                any = true;
+            }
+        }
+    }
+    if (!any) {
+        return;
+    }
+
+    // 连续的缺失页合并为一次读取，每次不超过MAX_BURST
+    uint32_t burst_pages = MAX_BURST / page_size ? MAX_BURST / page_size : 1;
+    uint32_t p = 0;
+    while (p < st->page_count) {
+        if (!((st->needed[p / 8] >> (p % 8)) & 1u)) {
+            p++;
+            continue;
+        }
+
+        uint32_t run = 1;
+        while (p + run < st->page_count && run < burst_pages &&
+               ((st->needed[(p + run) / 8] >> ((p + run) % 8)) & 1u)) {
+            run++;
+        }
+
+        uint32_t addr = p * page_size;
+        uint32_t len = run * page_size;
+        if (addr + len > st->config.total_size) {
+            len = st->config.total_size - addr;
+        }
+        if (at24c256_read(st->dev, (uint16_t)addr, st->burst, (uint16_t)len) == AT24C256_OK) {
+            image_update(st, addr, st->burst, len, 0);
+            for (uint32_t k = 0; k < run; k++) {
+                mark_page_valid(st, p + k);
+            }
+        }
+        p += run;
+    }
+}
+
+/**
+ * @brief 检查读请求覆盖的页是否都已加载
+ */
+static at24c256_err_t check_read(const daemon_state_t* st, const client_slot_t* c) {
+    uint32_t address = c->req.address;
+    uint32_t length = c->req.length;
+    if (length == 0 || address + length > st->config.total_size) {
+        return AT24C256_ERROR_PARAM;
+    }
+
+    uint32_t page_size = st->config.page_size;
+    for (uint32_t p = address / page_size; p <= (address + length - 1) / page_size; p++) {
+        if (!page_valid(st, p)) {
+            return AT24C256_ERROR_READ;
+        }
+    }
+    return AT24C256_OK;
+}
+
+/**
+ * @brief 调度并完成本轮收集的全部请求
+ */
+static void run_batch(daemon_state_t* st) {
+    at24c256_err_t status[MAX_CLIENTS];
+
+    // 写请求按槽位顺序执行；每个客户端同时只有一个未完成请求，跨客户端顺序不受约束
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        client_slot_t* c = &st->clients[i];
+        if (c->fd >= 0 && c->pending && c->req.op != AT24C256_IPC_OP_READ) {
+            if (c->req.op == AT24C256_IPC_OP_WRITE || c->req.op == AT24C256_IPC_OP_ERASE) {
+                status[i] = execute_write(st, c);
+            } else {
+                status[i] = AT24C256_ERROR_PARAM;
+            }
+        }
+    }
+
+    load_missing_pages(st);
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        client_slot_t* c = &st->clients[i];
+        if (c->fd < 0 || !c->pending) {
+            continue;
+        }
+        if (c->req.op == AT24C256_IPC_OP_READ) {
+            status[i] = check_read(st, c);
+        }
+
+        at24c256_ipc_resp_t resp = { .seq = c->req.seq, .status = status[i] };
+        c->pending = false;
+        free(c->payload);
+        c->payload = NULL;
+        if (queue_output(c, &resp, sizeof(resp)) != 0) {
+            drop_client(c);
+        }
+    }
+}
+
+/**
+ * @brief 创建共享内存镜像
+ */
+static int create_shm(daemon_state_t* st, const char* name) {
+    st->shm_size = sizeof(at24c256_ipc_shm_t) + st->config.total_size;
+
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        perror("shm_open");
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)st->shm_size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        return -1;
+    }
+
+    void* map = mmap(NULL, st->shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+
+    st->shm = (at24c256_ipc_shm_t*)map;
+    st->shm->magic = AT24C256_IPC_SHM_MAGIC;
+    st->shm->total_size = st->config.total_size;
+    atomic_store(&st->shm->seq, 0);
+    memset(st->shm->image, 0xFF, st->config.total_size);
+    return 0;
+}
+
+/**
+ * @brief 创建监听套接字
+ */
+static int create_listener(const char* path) {
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(sa.sun_path)) {
+        fprintf(stderr, "套接字路径过长: %s\n", path);
+        return -1;
+    }
+    strcpy(sa.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    unlink(path);
+    // 与共享内存镜像相同，只有启动守护进程的用户可以连接
+    if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0 || chmod(path, 0600) != 0 ||
+        listen(fd, 16) != 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void usage(const char* prog) {
+    printf("用法: %s [-b i2c总线] [-a 设备地址] [-p 器件型号] [-n nvmem节点] [-s 套接字路径] "
+           "[-m 共享内存名]\n", prog);
+}
+
+/**
+ * @brief 主函数
+ */
+int main(int argc, char* argv[]) {
+    daemon_state_t st;
+    memset(&st, 0, sizeof(st));
+    at24c256_config_t config = AT24C256_DEFAULT_CONFIG;
+    const char* socket_path = AT24C256_DAEMON_SOCKET;
+    const char* shm_name = "/at24c256d";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:a:p:n:s:m:h")) != -1) {
+        switch (opt) {
+        case 'b': config.i2c_bus = optarg; break;
+        case 'a': config.device_addr = (uint8_t)strtoul(optarg, NULL, 0); break;
+        case 'p':
+            if (at24c256_config_set_part(&config, optarg) != AT24C256_OK) {
+                fprintf(stderr, "未知的器件型号: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'n': config.nvmem_path = optarg; break;
+        case 's': socket_path = optarg; break;
+        case 'm': shm_name = optarg; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    at24c256_err_t ret = at24c256_init(&config, &st.dev);
+    if (ret != AT24C256_OK) {
+        fprintf(stderr, "EEPROM初始化失败: %s\n", at24c256_strerror(ret));
+        return EXIT_FAILURE;
+    }
+    at24c256_get_info(st.dev, &st.config);
+
+    st.page_count = (st.config.total_size + st.config.page_size - 1) / st.config.page_size;
+    st.valid = (uint8_t*)calloc((st.page_count + 7) / 8, 1);
+    st.needed = (uint8_t*)calloc((st.page_count + 7) / 8, 1);
+    st.burst = (uint8_t*)malloc(MAX_BURST > st.config.page_size ? MAX_BURST : st.config.page_size);
+    if (!st.valid || !st.needed || !st.burst || create_shm(&st, shm_name) != 0) {
+        at24c256_deinit(st.dev);
+        return EXIT_FAILURE;
+    }
+
+    st.listen_fd = create_listener(socket_path);
+    if (st.listen_fd < 0) {
+        munmap(st.shm, st.shm_size);
+        shm_unlink(shm_name);
+        at24c256_deinit(st.dev);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        st.clients[i].fd = -1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("at24c256d 已启动: 设备 %s, 套接字 %s, 共享内存 %s\n",
+           st.config.nvmem_path ? st.config.nvmem_path : st.config.i2c_bus, socket_path, shm_name);
+
+    while (g_running) {
+        struct pollfd pfds[MAX_CLIENTS + 1];
+        int slot_of[MAX_CLIENTS + 1];
+        int nfds = 0;
+        int timeout = -1;
+        uint64_t now = now_ms();
+
+        pfds[nfds].fd = st.listen_fd;
+        pfds[nfds].events = POLLIN;
+        slot_of[nfds++] = -1;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            client_slot_t* c = &st.clients[i];
+            if (c->fd < 0) {
+                continue;
+            }
+
+            // 不完整的请求超时后断开，否则poll在最早的超时时刻醒来
+            if (c->partial_since_ms) {
+                uint64_t expire = c->partial_since_ms + CLIENT_PARTIAL_TIMEOUT_MS;
+                if (now >= expire) {
+                    drop_client(c);
+                    continue;
+                }
+                if (timeout < 0 || expire - now < (uint64_t)timeout) {
+                    timeout = (int)(expire - now);
+                }
+            }
+
+            // 响应未发送完时只等待可写，不接收下一个请求
+            pfds[nfds].fd = c->fd;
+            pfds[nfds].events = c->out_len ? POLLOUT : POLLIN;
+            slot_of[nfds++] = i;
+        }
+
+        if (poll(pfds, nfds, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+
+        // 先收齐本轮所有就绪客户端的请求，再统一调度
+        for (int i = 1; i < nfds; i++) {
+            client_slot_t* c = &st.clients[slot_of[i]];
+            short revents = pfds[i].revents;
+            if (revents & (POLLERR | POLLNVAL)) {
+                drop_client(c);
+            } else if (c->out_len && (revents & (POLLOUT | POLLHUP))) {
+                if (flush_output(c) != 0) {
+                    drop_client(c);
+                }
+            } else if (revents & (POLLIN | POLLHUP)) {
+                // 对端关闭时recv返回0，在receive_request中断开
+                receive_request(c);
+            }
+        }
+        if (pfds[0].revents & POLLIN) {
+            accept_clients(&st, shm_name);
+        }
+
+        run_batch(&st);
+    }
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (st.clients[i].fd >= 0) {
+            drop_client(&st.clients[i]);
+        }
+    }
+    close(st.listen_fd);
+    unlink(socket_path);
+    munmap(st.shm, st.shm_size);
+    shm_unlink(shm_name);
+    free(st.valid);
+    free(st.needed);
+    free(st.burst);
+    at24c256_deinit(st.dev);
+
+    printf("at24c256d 已退出\n");
+    return EXIT_SUCCESS;
+}